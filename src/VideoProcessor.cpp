@@ -1,9 +1,49 @@
 #include "VideoProcessor.h"
+#include "sources/CaptureFrameSource.h"
+#include "sources/IndexedFrameSource.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Parse a whole number; std::stoi alone would read "10x" as 10
+bool parseWhole(const std::string& text, int& value) {
+    try {
+        size_t used = 0;
+        value = std::stoi(text, &used);
+        return used == text.size();
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+// Parse a whole finite decimal; std::stod alone would read "5abc" as 5
+bool parseWhole(const std::string& text, double& value) {
+    try {
+        size_t used = 0;
+        value = std::stod(text, &used);
+        return used == text.size() && std::isfinite(value);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}  // namespace
 
 VideoProcessor::VideoProcessor()
     : frameWidth(0), frameHeight(0), totalFrames(0), currentFrame(0), fps(0.0),
-      processing(false), paused(false), stopRequested(false), videoEnded(false), currentFps(0.0) {
+      videoEnded(false), clockResync(false), qualityGovernorEnabled(false), processing(false), paused(false), stopRequested(false),
+      frameMemoryBudget(256 * 1024 * 1024), filterCacheEnabled(false), pipelineGeneration(0),
+      workerCount(std::max(1u, std::thread::hardware_concurrency())), tileRows(0), currentFps(0.0),
+      writerEnabled(false), captureFinished(false), workersRunning(0), outputFinished(false),
+      writerFinished(false), displayEnabled(true), frameSequence(0), framesPublished(0),
+      publishesSkipped(0), latestReads(0), staleReads(0), displayRequested(false), displaySequence(0), copiedBytes(0), framesEmitted(0),
+      framesCaptured(0), framesDropped(0), framesSkipped(0), framesLate(0) {
+    displayRecorder = performanceMonitor.createRecorder();
+    captureQueueId = performanceMonitor.registerQueue("capture", 0);
+    reorderQueueId = performanceMonitor.registerQueue("reorder", 0);
+    writerQueueId = performanceMonitor.registerQueue("writer", WRITER_QUEUE_CAPACITY);
 }
 
 VideoProcessor::~VideoProcessor() {
@@ -11,28 +51,61 @@ VideoProcessor::~VideoProcessor() {
 }
 
 bool VideoProcessor::openVideo(const std::string& filename) {
-    // Close any previously opened video
-    if (videoCapture.isOpened()) {
-        videoCapture.release();
+    // Try to open the video file, or a synthetic or raw frame source
+    std::unique_ptr<FrameSource> source = FrameSource::create(filename);
+    if (!source) {
+        std::cerr << "Error: Could not open video file: " << filename << std::endl;
+        return false;
     }
     
-    // Try to open the video file
-    if (!videoCapture.open(filename)) {
-        std::cerr << "Error: Could not open video file: " << filename << std::endl;
+    // Decoded files seek through a keyframe index and a decoded frame cache
+    if (seekOptions.indexKeyframes && dynamic_cast<CaptureFrameSource*>(source.get())) {
+        auto index = std::make_shared<KeyframeIndex>();
+        index->build(filename, seekOptions.useSidecar);
+        source = std::make_unique<IndexedFrameSource>(std::move(source), std::move(index),
+                                                      seekOptions.cacheBytes);
+    }
+    
+    return openSource(std::move(source), filename);
+}
+
+void VideoProcessor::setSeekOptions(const SeekOptions& options) {
+    seekOptions = options;
+}
+
+bool VideoProcessor::openSource(std::unique_ptr<FrameSource> source, const std::string& name) {
+    if (!source) {
         return false;
     }
+    if (processing) {
+        shutdownPipeline();
+    }
+    
+    // Replaces any previously opened video
+    frameSource = std::move(source);
     
     // Get video properties
-    frameWidth = static_cast<int>(videoCapture.get(cv::CAP_PROP_FRAME_WIDTH));
-    frameHeight = static_cast<int>(videoCapture.get(cv::CAP_PROP_FRAME_HEIGHT));
-    totalFrames = static_cast<int>(videoCapture.get(cv::CAP_PROP_FRAME_COUNT));
-    fps = videoCapture.get(cv::CAP_PROP_FPS);
-    currentFrame = 0;
+    cv::Size frameSize = frameSource->getFrameSize();
+    frameWidth = frameSize.width;
+    frameHeight = frameSize.height;
+    totalFrames = frameSource->getFrameCount();
+    fps = frameSource->getFps();
+    currentFrame = frameSource->getPosition();
+    videoEnded = false;
+    filterCache.clear();
+    {
+        // The frame still shown belongs to the previous video; the pipeline
+        // is down, so nothing is published meanwhile
+        std::lock_guard<std::mutex> lock(readerMutex);
+        latestFrames.consume();
+        latestFrames.front().input.reset();
+        latestFrames.front().frameIndex = -1;
+    }
     
     // Store the filename
-    inputFilename = filename;
+    inputFilename = name;
     
-    std::cout << "Opened video: " << filename << std::endl;
+    std::cout << "Opened video: " << name << std::endl;
     std::cout << "  Resolution: " << frameWidth << "x" << frameHeight << std::endl;
     std::cout << "  Total frames: " << totalFrames << std::endl;
     std::cout << "  FPS: " << fps << std::endl;
@@ -41,7 +114,7 @@ bool VideoProcessor::openVideo(const std::string& filename) {
 }
 
 bool VideoProcessor::startProcessing() {
-    if (!videoCapture.isOpened()) {
+    if (!frameSource) {
         std::cerr << "Error: No video file opened." << std::endl;
         return false;
     }
@@ -51,21 +124,60 @@ bool VideoProcessor::startProcessing() {
         return true;
     }
     
+    // Keeping every frame instead would quietly defeat the sampling
+    if (sampling.mode == Sampling::Mode::Keyframes && !frameSource->indexKeyframes()) {
+        std::cerr << "Error: Keyframe positions are not available for " << inputFilename
+                  << " (needs OpenCV 4.7+ with the FFmpeg backend)." << std::endl;
+        return false;
+    }
+    
     // Reset state
     processing = true;
     paused = false;
     stopRequested = false;
-    
-    // Clear any existing frames in the queue
-    std::queue<cv::Mat> empty;
+    captureFinished = false;
+    workersRunning = workerCount;
+    outputFinished = false;
+    writerFinished = false;
+    copiedBytes = 0;
+    framesEmitted = 0;
+    framesCaptured = 0;
+    framesDropped = 0;
+    framesSkipped = 0;
+    framesLate = 0;
+    framesPublished = 0;
+    publishesSkipped = 0;
+    latestReads = 0;
+    staleReads = 0;
+    {
+        std::lock_guard<std::mutex> lock(encoderStatsMutex);
+        encoderStats = EncoderStats();
+    }
     {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        std::swap(frameQueue, empty);
+        std::lock_guard<std::mutex> lock(fpsMutex);
+        currentFps = 0.0;
+        lastFrameTime = {};
+    }
+    performanceMonitor.reset();
+    
+    // Workers filter frames side by side, so each has that many frame
+    // intervals for one; without a frame rate there is no budget to keep
+    qualityGovernor.reset(qualityGovernorEnabled && fps > 0 ? workerCount * 1000.0 / fps : 0.0);
+    
+    // Set up empty pools and queues for the current video
+    resetFramePools();
+    resetLanes();
+    if (tileRows > 0 && !tilePool) {
+        tilePool = std::make_unique<ThreadPool>();
     }
     
     // Start threads
     captureThread = std::thread(&VideoProcessor::captureThreadFunc, this);
-    processingThread = std::thread(&VideoProcessor::processingThreadFunc, this);
+    for (size_t lane = 0; lane < workerCount; ++lane) {
+        processingThreads.emplace_back(&VideoProcessor::processingThreadFunc, this, lane);
+    }
+    outputThread = std::thread(&VideoProcessor::outputThreadFunc, this);
+    writerThread = std::thread(&VideoProcessor::writerThreadFunc, this);
     
     return true;
 }
@@ -75,33 +187,133 @@ void VideoProcessor::pauseProcessing() {
 }
 
 void VideoProcessor::resumeProcessing() {
-    paused = false;
-    queueCondition.notify_all();
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+        paused = false;
+        clockResync = true;
+    }
+    pauseCondition.notify_all();
 }
 
 void VideoProcessor::stopProcessing() {
     if (processing) {
-        // Signal threads to stop
-        stopRequested = true;
-        paused = false;
-        processing = false;
-        
-        // Notify all waiting threads
-        queueCondition.notify_all();
-        
-        // Wait for threads to finish
-        if (captureThread.joinable()) {
-            captureThread.join();
+        shutdownPipeline();
+    }
+    
+    // Close video writer if open
+    std::lock_guard<std::mutex> lock(writerMutex);
+    if (videoWriter.isOpened()) {
+        videoWriter.release();
+    }
+    writerEnabled = false;
+}
+
+void VideoProcessor::shutdownPipeline() {
+    // Signal capture to stop; every later stage drains its queue and exits
+    // once the stage before it has finished
+    stopRequested = true;
+    paused = false;
+    processing = false;
+    
+    // Notify all waiting threads
+    wakeAllThreads();
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+    }
+    completionCondition.notify_all();
+    
+    // Wait for threads to finish, in pipeline order
+    if (captureThread.joinable()) {
+        captureThread.join();
+    }
+    
+    for (auto& thread : processingThreads) {
+        if (thread.joinable()) {
+            thread.join();
         }
-        
-        if (processingThread.joinable()) {
-            processingThread.join();
+    }
+    processingThreads.clear();
+    
+    if (outputThread.joinable()) {
+        outputThread.join();
+    }
+    
+    if (writerThread.joinable()) {
+        writerThread.join();
+    }
+}
+
+bool VideoProcessor::processFrameBatch(ThreadPool& pool, size_t maxFrames) {
+    if (!frameSource || maxFrames == 0) {
+        return false;
+    }
+    if (batchSlots.size() < maxFrames) {
+        batchSlots.resize(maxFrames);
+    }
+    
+    // Decode the batch; decoding is sequential within a video
+    size_t count = 0;
+    bool moreFrames = true;
+    int frameIndex = 0;
+    while (count < maxFrames) {
+        if (!readSampledFrame(batchSlots[count].input, frameIndex)) {
+            videoEnded = true;
+            moreFrames = false;
+            break;
         }
-        
-        // Close video writer if open
+        ++count;
+    }
+    framesCaptured += count;
+    currentFrame = frameSource->getPosition();
+    
+    // Filter every frame as its own task; stateful chains run in order here
+    std::vector<std::shared_ptr<Filter>> chain = getFilters();
+    bool filtering = hasEnabledFilter(chain);
+    if (filtering) {
+        if (requiresSerialProcessing(chain)) {
+            for (size_t i = 0; i < count; ++i) {
+                BatchSlot& slot = batchSlots[i];
+                applyFilters(chain, slot.input, slot.output, slot.plan);
+            }
+        } else {
+            TaskGroup group(pool);
+            for (size_t i = 0; i < count; ++i) {
+                BatchSlot& slot = batchSlots[i];
+                group.run([this, &chain, &slot] {
+                    applyFilters(chain, slot.input, slot.output, slot.plan);
+                });
+            }
+            group.wait();
+        }
+    }
+    
+    // Write in order
+    std::lock_guard<std::mutex> lock(writerMutex);
+    for (size_t i = 0; i < count; ++i) {
         if (videoWriter.isOpened()) {
-            videoWriter.release();
+            videoWriter.write(filtering ? batchSlots[i].output : batchSlots[i].input);
         }
+        ++framesEmitted;
+    }
+    
+    return moreFrames;
+}
+
+size_t VideoProcessor::getFrameBytes() const {
+    return static_cast<size_t>(frameWidth) * frameHeight * CV_ELEM_SIZE(CV_8UC3);
+}
+
+void VideoProcessor::waitForCompletion() {
+    std::unique_lock<std::mutex> lock(completionMutex);
+    completionCondition.wait(lock, [this] { return writerFinished || !processing; });
+}
+
+void VideoProcessor::setDisplayEnabled(bool enabled) {
+    displayEnabled = enabled;
+    if (!enabled) {
+        std::lock_guard<std::mutex> lock(readerMutex);
+        latestFrames.consume();
+        latestFrames.front() = LatestFrame();
     }
 }
 
@@ -126,14 +338,297 @@ std::vector<std::shared_ptr<Filter>> VideoProcessor::getFilters() const {
     return filters;
 }
 
+void VideoProcessor::setWorkerCount(size_t count) {
+    workerCount = std::max<size_t>(1, count);
+}
+
+size_t VideoProcessor::getWorkerCount() const {
+    return workerCount;
+}
+
+void VideoProcessor::setTileRows(int rows) {
+    tileRows = std::max(0, rows);
+}
+
+int VideoProcessor::getTileRows() const {
+    return tileRows;
+}
+
+void VideoProcessor::setFrameMemoryBudget(size_t bytes) {
+    frameMemoryBudget = bytes;
+}
+
+void VideoProcessor::setFilterCacheBudget(size_t bytes) {
+    filterCache.setBudget(bytes);
+    filterCacheEnabled = bytes > 0;
+}
+
+FrameCache::Stats VideoProcessor::getFilterCacheStats() const {
+    return filterCache.getStats();
+}
+
+FramePool::Stats VideoProcessor::getCapturePoolStats() const {
+    return capturePool.getStats();
+}
+
+FramePool::Stats VideoProcessor::getOutputPoolStats() const {
+    return outputPool.getStats();
+}
+
+void VideoProcessor::resetFramePools() {
+    cv::Size frameSize(frameWidth, frameHeight);
+    size_t budgetFrames = FramePool::capacityForBudget(frameMemoryBudget, frameSize, CV_8UC3);
+
+    // Each worker holds one result while the writer queue and the display
+    // hold the latest ones (the published and the read frame, one more
+    // when the writer holds keyframes); more results than that are reorder
+    // backlog and count as misses instead of blocking the workers. Capture
+    // needs enough frames to keep every worker busy while the display
+    // retains the sources of the published and the read frame.
+    size_t outputCapacity = 2 * workerCount + WRITER_QUEUE_CAPACITY + 4;
+    size_t minOutputCapacity = workerCount + 2;
+    size_t minCaptureCapacity = workerCount + 3;
+
+    // Both pools come out of the budget; the output pool gives up its
+    // reorder backlog first, and whatever is left lets capture run ahead
+    if (budgetFrames < outputCapacity + minCaptureCapacity) {
+        outputCapacity = std::max(minOutputCapacity,
+                                  budgetFrames > minCaptureCapacity ? budgetFrames - minCaptureCapacity : 0);
+    }
+    if (budgetFrames < minOutputCapacity + minCaptureCapacity) {
+        size_t frameBytes = getFrameBytes();
+        std::cerr << "Warning: The frame memory budget of " << frameMemoryBudget / (1024 * 1024)
+                  << " MB is below the " << (minOutputCapacity + minCaptureCapacity) * frameBytes / (1024 * 1024)
+                  << " MB that " << workerCount << " workers need at " << frameWidth << "x" << frameHeight
+                  << "; using that instead." << std::endl;
+    }
+    size_t captureCapacity = std::max(minCaptureCapacity,
+                                      budgetFrames > outputCapacity ? budgetFrames - outputCapacity : 0);
+
+    capturePool.reset(captureCapacity, frameSize, CV_8UC3);
+    outputPool.reset(outputCapacity, frameSize, CV_8UC3);
+    performanceMonitor.registerQueue("capture", captureCapacity);
+    performanceMonitor.registerQueue("reorder", outputCapacity);
+}
+
+void VideoProcessor::resetLanes() {
+    // Lanes never need to hold more frames than the pools can have in flight
+    size_t laneCapacity = capturePool.getStats().capacity + outputPool.getStats().capacity;
+
+    workerInputs.clear();
+    workerOutputs.clear();
+    for (size_t lane = 0; lane < workerCount; ++lane) {
+        workerInputs.push_back(std::make_unique<SpscRing<FramePacket>>(laneCapacity));
+        workerOutputs.push_back(std::make_unique<SpscRing<FramePacket>>(laneCapacity));
+    }
+    dispatchOrder.reset(laneCapacity);
+    writerQueue.reset(WRITER_QUEUE_CAPACITY);
+}
+
+size_t VideoProcessor::selectLane() const {
+    // Stateful filters see every frame in order only if one worker gets them all
+    if (requiresSerialProcessing(getFilters())) {
+        return 0;
+    }
+
+    // Otherwise send the frame to the least busy worker
+    size_t best = 0;
+    size_t bestDepth = workerInputs[0]->size();
+    for (size_t lane = 1; lane < workerInputs.size() && bestDepth > 0; ++lane) {
+        size_t depth = workerInputs[lane]->size();
+        if (depth < bestDepth) {
+            best = lane;
+            bestDepth = depth;
+        }
+    }
+    return best;
+}
+
+void VideoProcessor::wakeAllThreads() {
+    {
+        std::lock_guard<std::mutex> lock(pauseMutex);
+    }
+    pauseCondition.notify_all();
+
+    for (auto& ring : workerInputs) {
+        ring->wakeAll();
+    }
+    for (auto& ring : workerOutputs) {
+        ring->wakeAll();
+    }
+    dispatchOrder.wakeAll();
+    writerQueue.wakeAll();
+}
+
+bool VideoProcessor::Sampling::parse(const std::string& text, Sampling& sampling) {
+    size_t colon = text.find(':');
+    std::string mode = text.substr(0, colon);
+    std::string value = colon == std::string::npos ? "" : text.substr(colon + 1);
+
+    Sampling parsed;
+    if (mode == "all" && value.empty()) {
+        parsed.mode = Mode::All;
+    } else if (mode == "every" && !value.empty()) {
+        parsed.mode = Mode::EveryNth;
+        if (!parseWhole(value, parsed.interval) || parsed.interval < 1) {
+            return false;
+        }
+    } else if (mode == "fps" && !value.empty()) {
+        parsed.mode = Mode::TargetFps;
+        if (!parseWhole(value, parsed.fps) || parsed.fps <= 0) {
+            return false;
+        }
+    } else if (mode == "keyframes") {
+        parsed.mode = Mode::Keyframes;
+        parsed.fps = 0.0;
+        if (!value.empty() && (!parseWhole(value, parsed.fps) || parsed.fps < 0)) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    sampling = parsed;
+    return true;
+}
+
+void VideoProcessor::setSampling(const Sampling& newSampling) {
+    sampling = newSampling;
+    sampling.interval = std::max(1, sampling.interval);
+}
+
+VideoProcessor::Sampling VideoProcessor::getSampling() const {
+    return sampling;
+}
+
+bool VideoProcessor::RealTime::parse(const std::string& text, RealTime& realTime) {
+    size_t colon = text.find(':');
+    std::string policy = text.substr(0, colon);
+    std::string value = colon == std::string::npos ? "" : text.substr(colon + 1);
+
+    RealTime parsed;
+    if (policy == "off" && value.empty()) {
+        parsed.policy = Policy::Off;
+    } else if (policy == "pace") {
+        parsed.policy = Policy::Pace;
+    } else if (policy == "drop") {
+        parsed.policy = Policy::DropOldest;
+    } else if (policy == "skip") {
+        parsed.policy = Policy::SkipFilters;
+    } else if (policy == "degrade") {
+        parsed.policy = Policy::Degrade;
+    } else {
+        return false;
+    }
+
+    if (!value.empty() && (!parseWhole(value, parsed.maxLatencyMs) || parsed.maxLatencyMs < 0)) {
+        return false;
+    }
+
+    realTime = parsed;
+    return true;
+}
+
+void VideoProcessor::setRealTime(const RealTime& options) {
+    realTime = options;
+    realTime.maxLatencyMs = std::max(0.0, realTime.maxLatencyMs);
+}
+
+VideoProcessor::RealTime VideoProcessor::getRealTime() const {
+    return realTime;
+}
+
+void VideoProcessor::setQualityGovernor(bool enabled) {
+    qualityGovernorEnabled = enabled;
+}
+
+bool VideoProcessor::isQualityGovernorEnabled() const {
+    return qualityGovernorEnabled;
+}
+
+QualityGovernor::Stats VideoProcessor::getQualityStats() const {
+    return qualityGovernor.getStats();
+}
+
+double VideoProcessor::getFps() const {
+    return fps;
+}
+
+double VideoProcessor::getOutputFps() const {
+    switch (sampling.mode) {
+    case Sampling::Mode::EveryNth:
+        return fps / sampling.interval;
+    case Sampling::Mode::TargetFps:
+        return fps > 0 ? std::min(sampling.fps, fps) : sampling.fps;
+    case Sampling::Mode::Keyframes:
+        return sampling.fps > 0 ? sampling.fps : 1.0;
+    default:
+        return fps;
+    }
+}
+
+bool VideoProcessor::readSampledFrame(cv::Mat& frame, int& frameIndex, bool* filtered,
+                                      uint64_t* resultKey) {
+    // Skipped frames are only grabbed; retrieving converts and copies them
+    while (frameSource->grab()) {
+        frameIndex = frameSource->getPosition() - 1;
+        if (!isSampled(frameIndex)) {
+            ++framesSkipped;
+            continue;
+        }
+        
+        if (filtered && filterCacheEnabled) {
+            std::vector<std::shared_ptr<Filter>> chain = getFilters();
+            uint64_t key = FilterChainPlan::resultKey(chain, frameIndex);
+            *filtered = hasEnabledFilter(chain) && filterCache.get(key, frame);
+            
+            // Only a full-size color frame can stand in for the result;
+            // some backends do not report the frame size
+            cv::Size size = frameSource->getFrameSize();
+            if (*filtered && (frame.type() != CV_8UC3 || (size.area() > 0 && frame.size() != size))) {
+                *filtered = false;
+            }
+            if (*filtered) {
+                if (resultKey) {
+                    *resultKey = key;
+                }
+                return true;
+            }
+        }
+        return frameSource->retrieve(frame);
+    }
+    return false;
+}
+
+bool VideoProcessor::isSampled(int frameIndex) {
+    switch (sampling.mode) {
+    case Sampling::Mode::EveryNth:
+        return frameIndex % sampling.interval == 0;
+    case Sampling::Mode::TargetFps: {
+        // Keep the first frame at or after each output tick
+        double ratio = fps > 0 ? sampling.fps / fps : 1.0;
+        if (ratio >= 1.0 || frameIndex == 0) {
+            return true;
+        }
+        return std::floor(frameIndex * ratio + 1e-9) > std::floor((frameIndex - 1) * ratio + 1e-9);
+    }
+    case Sampling::Mode::Keyframes:
+        return frameSource->isKeyframe();
+    default:
+        return true;
+    }
+}
+
 bool VideoProcessor::setOutputFile(const std::string& filename, int fourcc, double fps) {
     if (fps <= 0) {
-        fps = this->fps;  // Use input video fps if not specified
+        fps = getOutputFps();  // Use input video fps if not specified
     }
     
     // Create video writer
+    std::lock_guard<std::mutex> lock(writerMutex);
     bool success = videoWriter.open(filename, fourcc, fps, 
                                    cv::Size(frameWidth, frameHeight));
+    writerEnabled = success;
     
     if (success) {
         outputFilename = filename;
@@ -146,19 +641,201 @@ bool VideoProcessor::setOutputFile(const std::string& filename, int fourcc, doub
 }
 
 cv::Mat VideoProcessor::getLatestFrame() {
-    std::lock_guard<std::mutex> lock(frameMutex);
-    return latestFrame.clone();
+    std::shared_ptr<const cv::Mat> latest = getLatestFrameView();
+    if (!latest) {
+        return cv::Mat();
+    }
+    recordCopy(*latest);
+    uint64_t start = PerformanceMonitor::now();
+    cv::Mat copy = latest->clone();
+    std::lock_guard<std::mutex> lock(displayMutex);
+    displayRecorder.record(PerformanceMonitor::DISPLAY_COPY, PerformanceMonitor::now() - start);
+    return copy;
+}
+
+std::shared_ptr<const cv::Mat> VideoProcessor::getLatestFrameView() {
+    return readLatestFrame().frame;
+}
+
+VideoProcessor::LatestFrameStats VideoProcessor::getLatestFrameStats() const {
+    LatestFrameStats stats;
+    stats.published = framesPublished;
+    stats.skippedPublishes = publishesSkipped;
+    stats.reads = latestReads;
+    stats.staleReads = staleReads;
+    return stats;
+}
+
+VideoProcessor::LatestFrame VideoProcessor::readLatestFrame() {
+    std::lock_guard<std::mutex> lock(readerMutex);
+    ++latestReads;
+    if (!latestFrames.consume()) {
+        ++staleReads;
+    }
+    return latestFrames.front();
+}
+
+void VideoProcessor::setDisplaySize(cv::Size size) {
+    std::lock_guard<std::mutex> lock(displayMutex);
+    displaySize = size;
+}
+
+bool VideoProcessor::getDisplayFrame(cv::Mat& frame) {
+    // The output thread scales the next frame it emits
+    displayRequested = true;
+    
+    if (!displayBuffer.consume()) {
+        LatestFrame latest = readLatestFrame();
+        if (latest.frame && latest.sequence != displaySequence) {
+            publishDisplayFrame(*latest.frame, latest.sequence);
+            displayBuffer.consume();
+        }
+    }
+    
+    frame = displayBuffer.front();
+    return !frame.empty();
+}
+
+void VideoProcessor::publishDisplayFrame(const cv::Mat& frame, uint64_t sequence) {
+    std::lock_guard<std::mutex> lock(displayMutex);
+    if (sequence <= displaySequence) {
+        return;
+    }
+    
+    uint64_t start = PerformanceMonitor::now();
+    cv::Mat& target = displayBuffer.back();
+    if (displaySize.empty() || displaySize == frame.size()) {
+        frame.copyTo(target);
+    } else {
+        // Area averaging does not alias when shrinking by large factors
+        cv::resize(frame, target, displaySize, 0, 0, cv::INTER_AREA);
+    }
+    recordCopy(target);
+    displayRecorder.record(PerformanceMonitor::DISPLAY_COPY, PerformanceMonitor::now() - start);
+    
+    displaySequence = sequence;
+    displayBuffer.publish();
+    displayReady.notify_all();
+}
+
+bool VideoProcessor::waitForDisplayFrame(std::chrono::milliseconds timeout) {
+    displayRequested = true;
+    std::unique_lock<std::mutex> lock(displayMutex);
+    return displayReady.wait_for(lock, timeout, [this] { return displayBuffer.hasNew(); });
+}
+
+bool VideoProcessor::refreshPausedFrame() {
+    if (!paused) {
+        return false;
+    }
+
+    LatestFrame shown = readLatestFrame();
+    if (!shown.frame || shown.frameIndex < 0) {
+        return false;
+    }
+    // Cached stage results alone do not tell the chain the input's layout,
+    // and may be evicted before they are read
+    const FramePool::Handle& input = shown.input;
+    int frameIndex = shown.frameIndex;
+    if (!input) {
+        return false;
+    }
+
+    // configure() bumps the parameter version, which changes the key; a
+    // filter that keeps state across frames cannot redo a single frame
+    std::vector<std::shared_ptr<Filter>> chain = getFilters();
+    uint64_t key = FilterChainPlan::resultKey(chain, frameIndex);
+    if (key == shown.resultKey || requiresSerialProcessing(chain)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> refreshLock(refreshMutex);
+    if (!refreshPlan.matches(chain)) {
+        refreshPlan.build(chain);
+    }
+    if (filterCacheEnabled) {
+        refreshPlan.setCache(&filterCache);
+    } else {
+        // Room for the stage results under the old and the new parameters
+        refreshCache.setBudget(2 * refreshPlan.getStageCount() * getFrameBytes());
+        refreshPlan.setCache(&refreshCache);
+    }
+
+    std::unique_ptr<TileExecutor> tiles;
+    if (tileRows > 0 && tilePool) {
+        tiles = std::make_unique<TileExecutor>(*tilePool, tileRows);
+    }
+    refreshPlan.setTileExecutor(tiles.get());
+
+    // Resumes after the last stage whose result is still cached
+    FramePool::Handle output = outputPool.acquire();
+    refreshPlan.execute(*input, *output, frameIndex);
+    refreshPlan.setTileExecutor(nullptr);
+
+    // A frame still draining from the pipeline may have replaced it
+    // meanwhile; otherwise the result replaces the readers' current frame
+    std::lock_guard<std::mutex> lock(readerMutex);
+    latestFrames.consume();
+    LatestFrame& current = latestFrames.front();
+    if (current.sequence != shown.sequence) {
+        return false;
+    }
+    current.frame = std::move(output);
+    current.resultKey = key;
+    current.sequence = ++frameSequence;
+    return true;
 }
 
 bool VideoProcessor::isProcessing() const {
     return processing && !stopRequested;
 }
 
+VideoProcessor::EncoderStats VideoProcessor::getEncoderStats() const {
+    std::lock_guard<std::mutex> lock(encoderStatsMutex);
+    EncoderStats stats = encoderStats;
+    stats.queueDepth = writerQueue.size();
+    stats.queueCapacity = writerQueue.capacity();
+    return stats;
+}
+
+uint64_t VideoProcessor::getProcessedFrameCount() const {
+    return framesEmitted;
+}
+
+uint64_t VideoProcessor::getCapturedFrameCount() const {
+    return framesCaptured;
+}
+
+uint64_t VideoProcessor::getDroppedFrameCount() const {
+    return framesDropped;
+}
+
+uint64_t VideoProcessor::getLateFrameCount() const {
+    return framesLate;
+}
+
+uint64_t VideoProcessor::getSkippedFrameCount() const {
+    return framesSkipped;
+}
+
+double VideoProcessor::getCopiedBytesPerFrame() const {
+    uint64_t frames = framesEmitted;
+    return frames > 0 ? static_cast<double>(copiedBytes) / frames : 0.0;
+}
+
+void VideoProcessor::recordCopy(const cv::Mat& frame) {
+    copiedBytes += frame.total() * frame.elemSize();
+}
+
 double VideoProcessor::getFrameRate() const {
     std::lock_guard<std::mutex> lock(fpsMutex);
     return currentFps;
 }
 
+const PerformanceMonitor& VideoProcessor::getPerformanceMonitor() const {
+    return performanceMonitor;
+}
+
 int VideoProcessor::getCurrentFramePosition() const {
     return currentFrame;
 }
@@ -176,15 +853,11 @@ bool VideoProcessor::seekToFrame(int framePos) {
     bool wasPaused = paused;
     pauseProcessing();
     
-    // Clear the frame queue
-    {
-        std::lock_guard<std::mutex> lock(queueMutex);
-        std::queue<cv::Mat> empty;
-        std::swap(frameQueue, empty);
-    }
+    // Drop the frames still queued or in flight
+    resetSequencing();
     
     // Seek to the desired frame
-    bool success = videoCapture.set(cv::CAP_PROP_POS_FRAMES, framePos);
+    bool success = frameSource && frameSource->seek(framePos);
     
     if (success) {
         currentFrame = framePos;
@@ -199,116 +872,411 @@ bool VideoProcessor::seekToFrame(int framePos) {
 }
 
 void VideoProcessor::captureThreadFunc() {
-    cv::Mat frame;
+    auto stopping = [this] { return stopRequested.load(); };
+    PerformanceMonitor::Recorder recorder = performanceMonitor.createRecorder();
+    
+    // Real-time clock: the source time of a frame is its offset from the
+    // anchor frame at the source rate
+    bool pacing = realTime.policy != RealTime::Policy::Off && fps > 0;
+    double frameNs = pacing ? 1e9 / fps : 0.0;
+    double maxLatencyNs = realTime.maxLatencyMs * 1e6;
+    bool anchored = false;
+    uint64_t anchorTime = 0;
+    int anchorFrame = 0;
+    uint64_t anchorGeneration = 0;
+    clockResync = false;
     
     while (!stopRequested) {
         if (paused) {
             // Wait while paused
-            std::unique_lock<std::mutex> lock(queueMutex);
-            queueCondition.wait(lock, [this] { return !paused || stopRequested; });
+            std::unique_lock<std::mutex> lock(pauseMutex);
+            pauseCondition.wait(lock, [this] { return !paused || stopRequested; });
             continue;
         }
         
-        // Limit the queue size
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (frameQueue.size() >= MAX_QUEUE_SIZE) {
-                queueCondition.wait(lock, [this] { 
-                    return frameQueue.size() < MAX_QUEUE_SIZE || stopRequested; 
-                });
-            }
+        // Decode straight into a recycled buffer; waiting for one to come
+        // back bounds the memory held by queued frames
+        FramePool::Handle frame = capturePool.acquireFor(std::chrono::milliseconds(100));
+        if (!frame) {
+            continue;
         }
         
-        // Read the next frame
-        if (!videoCapture.read(frame)) {
+        // Tag the frame before reading so a seek during the read drops it
+        FramePacket packet;
+        packet.generation = pipelineGeneration;
+        
+        // Read the next frame the sampling keeps
+        uint64_t start = PerformanceMonitor::now();
+        if (!readSampledFrame(*frame, packet.frameIndex, &packet.filtered, &packet.resultKey)) {
             // End of video or error
             std::cout << "End of video reached." << std::endl;
             videoEnded = true;
-            queueCondition.notify_all();
             break;
         }
         
+        // Pausing on a frame re-renders it from its source, which a result
+        // taken from the filter cache did not retrieve
+        if (packet.filtered && displayEnabled) {
+            FramePool::Handle source = capturePool.acquire();
+            if (frameSource->retrieve(*source)) {
+                packet.input = std::move(source);
+            }
+        }
+        
+        packet.queuedAt = PerformanceMonitor::now();
+        recorder.record(PerformanceMonitor::DECODE, packet.queuedAt - start);
+        ++framesCaptured;
+        
+        if (pacing) {
+            // Restart the clock after a seek or a pause, and when decoding
+            // itself fell behind; the late policy only covers the filters
+            uint64_t now = packet.queuedAt;
+            double offsetNs = (packet.frameIndex - anchorFrame) * frameNs;
+            if (!anchored || clockResync.exchange(false) || packet.generation != anchorGeneration ||
+                offsetNs < 0 || now > anchorTime + offsetNs + maxLatencyNs) {
+                anchored = true;
+                anchorTime = now;
+                anchorFrame = packet.frameIndex;
+                anchorGeneration = packet.generation;
+                offsetNs = 0;
+            }
+            packet.dueAt = anchorTime + static_cast<uint64_t>(offsetNs);
+            
+            // Hold the frame until its source time; a pause, seek or stop
+            // lets it go early and the next frame restarts the clock
+            if (packet.dueAt > now) {
+                uint64_t generation = packet.generation;
+                std::unique_lock<std::mutex> lock(pauseMutex);
+                pauseCondition.wait_for(lock, std::chrono::nanoseconds(packet.dueAt - now), [&] {
+                    return paused || stopRequested || pipelineGeneration != generation;
+                });
+                packet.queuedAt = PerformanceMonitor::now();
+            }
+        }
+        
         // Update current frame position
-        currentFrame = static_cast<int>(videoCapture.get(cv::CAP_PROP_POS_FRAMES));
+        currentFrame = frameSource->getPosition();
         
-        // Add frame to queue
-        {
-            std::lock_guard<std::mutex> lock(queueMutex);
-            frameQueue.push(frame.clone());
+        // Record the lane before queueing the frame, then hand it to the worker
+        size_t lane = selectLane();
+        packet.frame = std::move(frame);
+        if (!dispatchOrder.push(std::move(lane), stopping) ||
+            !workerInputs[lane]->push(std::move(packet), stopping)) {
+            break;
         }
         
-        // Notify processing thread
-        queueCondition.notify_one();
+        size_t queued = 0;
+        for (const auto& ring : workerInputs) {
+            queued += ring->size();
+        }
+        performanceMonitor.setQueueDepth(captureQueueId, queued);
     }
+    
+    // Let the workers drain what is queued and stop
+    captureFinished = true;
+    wakeAllThreads();
 }
 
-void VideoProcessor::processingThreadFunc() {
-    cv::Mat inputFrame, outputFrame;
+void VideoProcessor::processingThreadFunc(size_t lane) {
+    auto upstreamDone = [this] { return captureFinished.load(); };
+    auto never = [] { return false; };
+    SpscRing<FramePacket>& input = *workerInputs[lane];
+    SpscRing<FramePacket>& output = *workerOutputs[lane];
+    FramePacket packet;
+
+    // Each worker keeps its own plan, with the intermediate buffers
+    // preallocated at the source resolution
+    FilterChainPlan plan;
+    plan.reserve(cv::Size(frameWidth, frameHeight), CV_8UC3);
+    PerformanceMonitor::Recorder recorder = performanceMonitor.createRecorder();
+    plan.setRecorder(&recorder);
+    if (filterCacheEnabled) {
+        plan.setCache(&filterCache);
+    }
+    std::unique_ptr<TileExecutor> tiles;
+    if (tileRows > 0 && tilePool) {
+        tiles = std::make_unique<TileExecutor>(*tilePool, tileRows);
+        plan.setTileExecutor(tiles.get());
+    }
     
-    while (!stopRequested) {
-        // Get a frame from the queue
-        {
-            std::unique_lock<std::mutex> lock(queueMutex);
-            if (frameQueue.empty()) {
-                // If video has ended and queue is empty, we're done processing
-                if (videoEnded && !paused) {
-                    queueCondition.wait_for(lock, std::chrono::milliseconds(100), [this] {
-                        return !frameQueue.empty() || stopRequested || !videoEnded;
-                    });
-
-                    // If still empty and video still ended, check again
-                    if (frameQueue.empty() && videoEnded && !stopRequested) {
-                        continue;  // Keep the thread alive but don't process
+    // Late frames in real-time mode; the degraded plan runs a copy of the
+    // chain scaled to half resolution and bypasses the cache. Like the
+    // governor, the late policy only sheds work for the preview: a video
+    // being saved gets every frame, filtered in full.
+    uint64_t maxLatencyNs = static_cast<uint64_t>(realTime.maxLatencyMs * 1e6);
+    ScaledChain degradedChain;
+    FilterChainPlan degradedPlan;
+    degradedPlan.setTileExecutor(tiles.get());
+    cv::Mat degradedInput;
+    cv::Mat degradedOutput;
+    
+    // Frames below full resolution go through a scaled copy of the chain,
+    // also without the cache, whose entries are full-resolution results
+    bool governed = qualityGovernorEnabled && fps > 0;
+    ScaledChain scaledChain;
+    FilterChainPlan scaledPlan;
+    scaledPlan.setTileExecutor(tiles.get());
+    cv::Mat scaledInput;
+    cv::Mat scaledOutput;
+    
+    while (input.pop(packet, upstreamDone)) {
+        // Frames from before a seek are forwarded unprocessed so the output
+        // thread can still match every dispatched frame to its lane; frames
+        // taken from the filter cache are already done
+        if (packet.generation != pipelineGeneration) {
+            packet.frame.reset();
+        } else if (!packet.filtered) {
+            uint64_t start = PerformanceMonitor::now();
+            recorder.record(PerformanceMonitor::QUEUE_WAIT, start - packet.queuedAt);
+            bool late = packet.dueAt > 0 && start > packet.dueAt + maxLatencyNs;
+            if (late) {
+                ++framesLate;
+            }
+            RealTime::Policy policy = late && !writerEnabled ? realTime.policy : RealTime::Policy::Off;
+            
+            if (policy == RealTime::Policy::DropOldest && input.size() > 0) {
+                // A newer frame is already waiting; the output thread counts the drop
+                packet.frame.reset();
+            } else {
+                // Process the frame into a pooled output buffer; without any
+                // enabled filter the captured frame itself is passed on. The
+                // captured frame stays with the packet for re-rendering.
+                std::vector<std::shared_ptr<Filter>> chain = getFilters();
+                packet.resultKey = FilterChainPlan::resultKey(chain, packet.frameIndex);
+                packet.input = packet.frame;
+                bool skipFilters = policy == RealTime::Policy::SkipFilters;
+                bool reduced = false;
+                if (hasEnabledFilter(chain) && !skipFilters) {
+                    FramePool::Handle outputFrame = outputPool.acquire();
+                    double scale = governed && !writerEnabled ? qualityGovernor.getScale() : 1.0;
+                    
+                    // Lowering the resolution cannot help a chain that
+                    // always runs in full, so its timings must not move the
+                    // governor: they would step it down to a level whose
+                    // frames never come and whose samples it would wait for
+                    bool scalable = governed && updateScaledChain(chain, scale, scaledChain);
+                    if (policy == RealTime::Policy::Degrade && updateScaledChain(chain, 0.5, degradedChain)) {
+                        // A quarter of the pixels; chains that cannot be
+                        // scaled run in full like they do under the governor
+                        cv::resize(*packet.frame, degradedInput, cv::Size(), 0.5, 0.5, cv::INTER_AREA);
+                        applyFilters(degradedChain.filters, degradedInput, degradedOutput, degradedPlan);
+                        cv::resize(degradedOutput, *outputFrame, packet.frame->size(), 0, 0,
+                                   cv::INTER_LINEAR);
+                        reduced = true;
+                    } else if (scale < 1.0 && scalable) {
+                        cv::resize(*packet.frame, scaledInput, cv::Size(), scale, scale, cv::INTER_AREA);
+                        applyFilters(scaledChain.filters, scaledInput, scaledOutput, scaledPlan);
+                        
+                        // The small result lives in a corner of the pooled
+                        // buffer, which stays checked out as long as the view
+                        cv::Mat view = (*outputFrame)(cv::Rect(0, 0, scaledOutput.cols, scaledOutput.rows));
+                        scaledOutput.copyTo(view);
+                        auto scaledFrame = std::make_shared<std::pair<FramePool::Handle, cv::Mat>>(
+                            std::move(outputFrame), view);
+                        outputFrame = FramePool::Handle(scaledFrame, &scaledFrame->second);
+                        reduced = true;
+                    } else {
+                        scale = 1.0;
+                        applyFilters(chain, *packet.frame, *outputFrame, plan, packet.frameIndex);
+                    }
+                    packet.frame = std::move(outputFrame);
+                    uint64_t filterNs = PerformanceMonitor::now() - start;
+                    recorder.record(PerformanceMonitor::FILTERS, filterNs);
+                    if (scalable && !late) {
+                        qualityGovernor.record(scale, filterNs);
                     }
-                } else {
-                    // Normal wait for more frames
-                    queueCondition.wait(lock, [this] {
-                        return !frameQueue.empty() || stopRequested;
-                    });
                 }
-
-                if (stopRequested) break;
-                if (frameQueue.empty()) continue;
+                
+                // Stand-ins for the chain's result do not carry its key, so
+                // pausing on one re-renders it in full
+                if (reduced || skipFilters) {
+                    packet.resultKey = 0;
+                }
             }
-            
-            inputFrame = frameQueue.front();
-            frameQueue.pop();
         }
         
-        // Notify capture thread that queue has space
-        queueCondition.notify_one();
+        // The output thread keeps consuming until every worker is done
+        output.push(std::move(packet), never);
+    }
+    
+    --workersRunning;
+    wakeAllThreads();
+}
+
+void VideoProcessor::outputThreadFunc() {
+    auto captureDone = [this] { return captureFinished.load(); };
+    auto workersDone = [this] { return workersRunning == 0; };
+    size_t lane = 0;
+    FramePacket packet;
+    
+    // Take results lane by lane in dispatch order, which restores capture order
+    while (dispatchOrder.pop(lane, captureDone)) {
+        if (!workerOutputs[lane]->pop(packet, workersDone)) {
+            break;
+        }
         
-        // Process the frame
-        applyFilters(inputFrame, outputFrame);
+        size_t waiting = 0;
+        for (const auto& ring : workerOutputs) {
+            waiting += ring->size();
+        }
+        performanceMonitor.setQueueDepth(reorderQueueId, waiting);
         
-        // Save the processed frame if writer is open
-        if (videoWriter.isOpened()) {
-            videoWriter.write(outputFrame);
+        if (packet.frame && packet.generation == pipelineGeneration) {
+            emitFrame(packet);
+        } else {
+            ++framesDropped;
+            
+            // A frame dropped just before saving started still takes its
+            // place in the file; the writer repeats the previous one
+            if (writerEnabled && packet.generation == pipelineGeneration) {
+                FramePacket gap;
+                gap.frameIndex = packet.frameIndex;
+                gap.generation = packet.generation;
+                writerQueue.push(std::move(gap), [] { return false; });
+            }
+        }
+        packet.frame.reset();
+        packet.input.reset();
+    }
+    
+    outputFinished = true;
+    writerQueue.wakeAll();
+}
+
+void VideoProcessor::writerThreadFunc() {
+    auto upstreamDone = [this] { return outputFinished.load(); };
+    PerformanceMonitor::Recorder recorder = performanceMonitor.createRecorder();
+    FramePacket packet;
+    
+    // Keyframes arrive at irregular intervals; the last one is written
+    // again until the next is due, to keep them at their source times.
+    // Packets without a frame stand for dropped frames and repeat it too.
+    bool holdFrames = sampling.mode == Sampling::Mode::Keyframes && fps > 0;
+    double ticksPerFrame = holdFrames ? getOutputFps() / fps : 0.0;
+    FramePool::Handle heldFrame;
+    long long nextTick = 0;
+    cv::Size outputSize(frameWidth, frameHeight);
+    cv::Mat upscaled;
+    
+    while (writerQueue.pop(packet, upstreamDone)) {
+        const FramePool::Handle& current = packet.frame ? packet.frame : heldFrame;
+        if (!current) {
+            // Nothing written yet to stand in for the frame
+            continue;
         }
         
-        // Update the latest frame for display
-        {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            latestFrame = outputFrame.clone();
+        int writes = 1;
+        if (holdFrames) {
+            long long tick = std::llround(packet.frameIndex * ticksPerFrame);
+            if (heldFrame && tick > nextTick) {
+                writes += static_cast<int>(tick - nextTick);
+            }
+            nextTick = std::max(nextTick, tick) + 1;
         }
         
-        // Update FPS calculation
-        auto now = std::chrono::high_resolution_clock::now();
-        if (lastFrameTime.time_since_epoch().count() > 0) {
-            auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-                now - lastFrameTime).count();
-            if (duration > 0) {
-                double instantFps = 1000.0 / duration;
-                
-                // Smooth FPS calculation
-                {
-                    std::lock_guard<std::mutex> lock(fpsMutex);
-                    currentFps = currentFps * 0.9 + instantFps * 0.1;
+        for (int i = 0; i < writes; ++i) {
+            const cv::Mat& frame = i + 1 < writes ? *heldFrame : *current;
+            
+            // Frames the governor filtered at a lower resolution just
+            // before the file was opened still need the full size
+            bool fullSize = frame.size() == outputSize;
+            if (!fullSize) {
+                cv::resize(frame, upscaled, outputSize, 0, 0, cv::INTER_LINEAR);
+            }
+            const cv::Mat& written = fullSize ? frame : upscaled;
+            uint64_t start = PerformanceMonitor::now();
+            {
+                std::lock_guard<std::mutex> lock(writerMutex);
+                if (videoWriter.isOpened()) {
+                    videoWriter.write(written);
                 }
             }
+            uint64_t encodeNs = PerformanceMonitor::now() - start;
+            recorder.record(PerformanceMonitor::ENCODE, encodeNs);
+            double encodeMs = encodeNs / 1e6;
+            
+            std::lock_guard<std::mutex> lock(encoderStatsMutex);
+            encoderStats.framesWritten++;
+            encoderStats.averageEncodeMs +=
+                (encodeMs - encoderStats.averageEncodeMs) / encoderStats.framesWritten;
+            encoderStats.maxEncodeMs = std::max(encoderStats.maxEncodeMs, encodeMs);
+        }
+        
+        if (packet.frame) {
+            heldFrame = std::move(packet.frame);
+        }
+    }
+    heldFrame.reset();
+    
+    // The last stage is done, so the whole pipeline has drained
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        writerFinished = true;
+    }
+    completionCondition.notify_all();
+}
+
+void VideoProcessor::resetSequencing() {
+    // In-flight frames now carry a stale generation and are dropped downstream
+    ++pipelineGeneration;
+}
+
+void VideoProcessor::emitFrame(const FramePacket& packet) {
+    const FramePool::Handle& outputFrame = packet.frame;
+    
+    // Queue the processed frame for the writer thread if a writer is open;
+    // a full queue holds up this thread, which backs up the workers
+    if (writerEnabled) {
+        FramePacket queued = packet;
+        queued.input.reset();
+        size_t depth = writerQueue.size() + 1;
+        writerQueue.push(std::move(queued), [] { return false; });
+        performanceMonitor.setQueueDepth(writerQueueId, depth);
+        
+        std::lock_guard<std::mutex> lock(encoderStatsMutex);
+        encoderStats.peakQueueDepth = std::max(encoderStats.peakQueueDepth, depth);
+    }
+    
+    // Publish the latest frame for display; the pipeline no longer writes
+    // to this frame, so sharing the handle is enough. The buffer returns to
+    // the pool once readers have moved on to a newer frame.
+    if (displayEnabled) {
+        uint64_t sequence = ++frameSequence;
+        LatestFrame& latest = latestFrames.back();
+        latest.frame = outputFrame;
+        latest.input = packet.input;
+        latest.frameIndex = packet.frameIndex;
+        latest.resultKey = packet.resultKey;
+        latest.sequence = sequence;
+        if (latestFrames.publish()) {
+            ++publishesSkipped;
+        }
+        ++framesPublished;
+        
+        // The buffer handed back holds an older frame; release it now
+        latestFrames.back() = LatestFrame();
+        
+        // Scale at most one frame per request of the display
+        if (displayRequested.exchange(false)) {
+            publishDisplayFrame(*outputFrame, sequence);
+        }
+    }
+    ++framesEmitted;
+    
+    // Update FPS calculation; whole milliseconds would make intervals
+    // below 1 ms count as zero and round the rest heavily at high rates
+    auto now = std::chrono::steady_clock::now();
+    if (lastFrameTime.time_since_epoch().count() > 0) {
+        double seconds = std::chrono::duration<double>(now - lastFrameTime).count();
+        if (seconds > 0) {
+            double instantFps = 1.0 / seconds;
+            
+            // Smooth FPS calculation; the first interval seeds the average
+            std::lock_guard<std::mutex> lock(fpsMutex);
+            currentFps = currentFps > 0 ? currentFps * 0.9 + instantFps * 0.1 : instantFps;
         }
-        lastFrameTime = now;
     }
+    lastFrameTime = now;
 }
 
 bool VideoProcessor::hasVideoEnded() const {
@@ -316,42 +1284,75 @@ bool VideoProcessor::hasVideoEnded() const {
 }
 
 bool VideoProcessor::restartVideo() {
-    if (inputFilename.empty() || !videoCapture.isOpened()) {
+    if (!frameSource) {
         return false;
     }
 
+    // The pipeline threads exit at the end of the video, so wind down
+    // whatever is left and start a fresh pipeline; the output file stays open
+    if (processing) {
+        shutdownPipeline();
+    }
+
     // Reset state
     videoEnded = false;
 
     // Seek to the beginning
-    bool success = videoCapture.set(cv::CAP_PROP_POS_FRAMES, 0);
+    bool success = frameSource->seek(0);
     if (success) {
         currentFrame = 0;
-
-        // Restart processing if it was previously ended
-        if (!processing) {
-            startProcessing();
-        } else if (paused) {
-            // Resume if paused
-            resumeProcessing();
-        }
+        startProcessing();
     }
 
     return success;
 }
 
-void VideoProcessor::applyFilters(const cv::Mat& input, cv::Mat& output) {
-    cv::Mat temp = input.clone();
-    cv::Mat result;
-    
-    // Apply each filter in sequence
-    std::lock_guard<std::mutex> lock(filtersMutex);
-    for (const auto& filter : filters) {
-        if (filter->isEnabled()) {
-            filter->apply(temp, result);
-            temp = result.clone();
+bool VideoProcessor::hasEnabledFilter(const std::vector<std::shared_ptr<Filter>>& chain) {
+    return std::any_of(chain.begin(), chain.end(), [](const std::shared_ptr<Filter>& filter) {
+        return filter->isEnabled();
+    });
+}
+
+bool VideoProcessor::requiresSerialProcessing(const std::vector<std::shared_ptr<Filter>>& chain) {
+    return std::any_of(chain.begin(), chain.end(), [](const std::shared_ptr<Filter>& filter) {
+        return filter->isEnabled() && !filter->isStateless();
+    });
+}
+
+bool VideoProcessor::updateScaledChain(const std::vector<std::shared_ptr<Filter>>& chain, double scale,
+                                       ScaledChain& scaled) {
+    uint64_t signature = FilterChainPlan::resultKey(chain, 0);
+    if (scaled.signature == signature && scaled.scale == scale) {
+        return scaled.valid;
+    }
+    scaled.signature = signature;
+    scaled.scale = scale;
+    scaled.filters.clear();
+
+    // The governor's budget assumes frames spread across the workers
+    scaled.valid = !requiresSerialProcessing(chain);
+    for (const auto& filter : chain) {
+        if (!scaled.valid) {
+            break;
+        }
+        if (!filter->isEnabled()) {
+            continue;
         }
+        std::shared_ptr<Filter> scaledFilter =
+            filter->isResolutionInvariant() ? filter : filter->createScaled(scale);
+        scaled.valid = scaledFilter != nullptr;
+        scaled.filters.push_back(std::move(scaledFilter));
     }
-    
-    output = temp;
-}
\ No newline at end of file
+    return scaled.valid;
+}
+
+void VideoProcessor::applyFilters(const std::vector<std::shared_ptr<Filter>>& chain,
+                                  const cv::Mat& input, cv::Mat& output, FilterChainPlan& plan,
+                                  int frameIndex) {
+    // The chain is a snapshot, so workers do not hold filtersMutex here;
+    // configure() calls on its filters bump their versions and invalidate the plan
+    if (!plan.matches(chain)) {
+        plan.build(chain);
+    }
+    plan.execute(input, output, frameIndex);
+}
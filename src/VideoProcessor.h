@@ -8,18 +8,122 @@
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
-#include <queue>
 #include "filters/Filter.h"
+#include "filters/FilterChainPlan.h"
+#include "sources/FrameSource.h"
+#include "utils/FramePool.h"
+#include "utils/PerformanceMonitor.h"
+#include "utils/QualityGovernor.h"
+#include "utils/SpscRing.h"
+#include "utils/ThreadPool.h"
+#include "utils/TripleBuffer.h"
 
 /**
  * @brief Main video processing class that manages the processing pipeline
  * 
  * This class loads video files, processes frames through a series of
  * filters, and provides methods to display and save the processed output.
- * It uses multiple threads for improved performance.
+ * It uses multiple threads for improved performance: one capture thread
+ * feeds a pool of processing workers, an output thread puts the filtered
+ * frames back in their original order for the display, and a writer
+ * thread encodes them, so decoding, filtering and encoding overlap.
+ * Every handoff between two threads goes through its own lock-free
+ * single-producer/single-consumer ring.
  */
 class VideoProcessor {
 public:
+    /**
+     * @brief Counters for the encoder stage
+     */
+    struct EncoderStats {
+        uint64_t framesWritten = 0;     ///< Frames passed to the video writer
+        double averageEncodeMs = 0.0;   ///< Mean time per VideoWriter::write call
+        double maxEncodeMs = 0.0;       ///< Slowest VideoWriter::write call
+        size_t queueDepth = 0;          ///< Frames waiting for the writer
+        size_t peakQueueDepth = 0;      ///< Deepest the writer queue has been
+        size_t queueCapacity = 0;       ///< Size of the writer queue
+    };
+
+    /**
+     * @brief Counters of the latest-frame handoff between the output thread and readers
+     */
+    struct LatestFrameStats {
+        uint64_t published = 0;         ///< Frames published by the output thread
+        uint64_t skippedPublishes = 0;  ///< Published frames replaced before any reader took them
+        uint64_t reads = 0;             ///< Reads of the latest frame
+        uint64_t staleReads = 0;        ///< Reads that found nothing newer than the previous read
+    };
+
+    /**
+     * @brief Selection of the source frames that go through the pipeline
+     *
+     * Frames that are not selected are only grabbed from the source, never
+     * retrieved, so they skip the colour conversion and copy as well as
+     * filtering and encoding. Inter-coded video still has to decode them.
+     */
+    struct Sampling {
+        enum class Mode {
+            All,        ///< Every frame
+            EveryNth,   ///< Frames 0, N, 2N, ...
+            TargetFps,  ///< Evenly spaced frames at a lower frame rate
+            Keyframes   ///< Keyframes only
+        };
+
+        Mode mode = Mode::All;
+        int interval = 1;       ///< N for EveryNth
+        double fps = 0.0;       ///< Rate for TargetFps; output rate for Keyframes (0 = 1 fps)
+
+        /**
+         * @brief Parse "all", "every:N", "fps:RATE" or "keyframes[:RATE]"
+         *
+         * @param text Sampling spec
+         * @param sampling Receives the parsed sampling
+         * @return true if the spec is valid
+         */
+        static bool parse(const std::string& text, Sampling& sampling);
+    };
+
+    /**
+     * @brief Real-time playback for live preview
+     *
+     * Frames enter the pipeline at their source times instead of as fast
+     * as the workers take them. A frame that a worker picks up more than
+     * maxLatencyMs after its source time is late and handled by the
+     * policy, so a chain that is too slow for the source rate does not
+     * make the preview fall further and further behind. While a video is
+     * being saved the policy is not applied: late frames are only counted.
+     */
+    struct RealTime {
+        enum class Policy {
+            Off,            ///< Read as fast as the pipeline allows
+            Pace,           ///< Pace and count late frames, but filter every frame in full
+            DropOldest,     ///< Drop a late frame when a newer one is queued behind it
+            SkipFilters,    ///< Pass late frames on unfiltered
+            Degrade         ///< Filter late frames with the chain scaled to half resolution
+        };
+
+        Policy policy = Policy::Off;
+        double maxLatencyMs = 100.0;    ///< Delay after the source time at which a frame is late
+
+        /**
+         * @brief Parse "off", "pace[:MS]", "drop[:MS]", "skip[:MS]" or "degrade[:MS]"
+         *
+         * @param text Real-time spec; MS sets maxLatencyMs
+         * @param realTime Receives the parsed options
+         * @return true if the spec is valid
+         */
+        static bool parse(const std::string& text, RealTime& realTime);
+    };
+
+    /**
+     * @brief Seeking support for decoded video files
+     */
+    struct SeekOptions {
+        bool indexKeyframes = false;    ///< Index keyframes in the background when a video is opened
+        bool useSidecar = false;        ///< Load and save the index as "<video>.keyframes"
+        size_t cacheBytes = 0;          ///< Decoded frames kept for stepping back; 0 = none
+    };
+
     /**
      * @brief Default constructor
      */
@@ -33,10 +137,35 @@ public:
     /**
      * @brief Open a video file for processing
      * 
-     * @param filename Path to the video file
+     * Besides video files, accepts the "synthetic:..." and "raw:..." specs
+     * of FrameSource::create, which feed the pipeline without a decoder.
+     * 
+     * @param filename Path to the video file, or a frame source spec
      * @return true if the file was opened successfully, false otherwise
      */
     bool openVideo(const std::string& filename);
+
+    /**
+     * @brief Set up keyframe-indexed seeking for videos opened from now on
+     *
+     * With indexKeyframes set, video files are wrapped in an
+     * IndexedFrameSource: seeks jump to the nearest keyframe and decode
+     * forward only as far as needed, and recently decoded frames are
+     * cached so that stepping back is instant. Synthetic and raw sources
+     * seek exactly on their own and are not wrapped.
+     *
+     * @param options Seeking options
+     */
+    void setSeekOptions(const SeekOptions& options);
+
+    /**
+     * @brief Process frames from an already opened source
+     *
+     * @param source Frame source; the processor takes ownership
+     * @param name Name reported for the input
+     * @return true if the source was accepted, false if it is null
+     */
+    bool openSource(std::unique_ptr<FrameSource> source, const std::string& name);
     
     /**
      * @brief Start processing the video
@@ -57,9 +186,53 @@ public:
     
     /**
      * @brief Stop processing and release resources
+     *
+     * Capture stops right away; frames already decoded are still filtered
+     * and written before the output file is closed.
      */
     void stopProcessing();
     
+    /**
+     * @brief Decode, filter and write the next few frames on a shared pool
+     *
+     * An alternative to startProcessing() for callers that run many videos
+     * at once: no threads are started. The frames are decoded on the calling
+     * thread, filtered as tasks on the pool and written in order before the
+     * call returns. Buffers are kept between calls, so memory use is about
+     * four frames per batch slot.
+     *
+     * @param pool Pool that runs the filter tasks
+     * @param maxFrames Number of frames to decode in this batch
+     * @return true if more frames remain, false at the end of the video
+     */
+    bool processFrameBatch(ThreadPool& pool, size_t maxFrames);
+
+    /**
+     * @brief Get the size of a decoded frame in bytes
+     *
+     * @return Bytes per frame of the opened video
+     */
+    size_t getFrameBytes() const;
+
+    /**
+     * @brief Wait until every frame of the video has been processed
+     *
+     * Blocks until the pipeline has drained after the end of the video, or
+     * until processing is stopped. Call stopProcessing() afterwards to
+     * close the output file.
+     */
+    void waitForCompletion();
+
+    /**
+     * @brief Enable or disable publishing frames for display
+     *
+     * Headless runs turn this off so that no frame is kept around for
+     * getLatestFrame().
+     *
+     * @param enabled True to keep the latest frame for display
+     */
+    void setDisplayEnabled(bool enabled);
+    
     /**
      * @brief Add a filter to the processing pipeline
      * 
@@ -82,12 +255,134 @@ public:
      */
     std::vector<std::shared_ptr<Filter>> getFilters() const;
     
+    /**
+     * @brief Set the number of processing worker threads
+     *
+     * Takes effect the next time processing is started.
+     *
+     * @param count Number of workers (values below 1 are clamped to 1)
+     */
+    void setWorkerCount(size_t count);
+
+    /**
+     * @brief Get the number of processing worker threads
+     *
+     * @return Worker count used when processing starts
+     */
+    size_t getWorkerCount() const;
+    
+    /**
+     * @brief Split every frame into horizontal tiles that are filtered in parallel
+     *
+     * Frame parallelism keeps several frames in flight, which adds latency
+     * to a live preview. With tiling each worker filters its frame in tiles
+     * of this many rows on a pool shared by all workers, so a frame
+     * finishes sooner; combine it with a small worker count. Takes effect
+     * the next time processing is started.
+     *
+     * @param rows Rows per tile, or 0 to filter each frame on its worker
+     */
+    void setTileRows(int rows);
+
+    /**
+     * @brief Get the number of rows per tile
+     *
+     * @return Rows per tile, 0 if tiling is off
+     */
+    int getTileRows() const;
+
+    /**
+     * @brief Process only a subset of the source frames
+     *
+     * Set this before setOutputFile(), which derives the default output
+     * frame rate from it, and before processing starts. Every-N and
+     * target-fps sampling keep evenly spaced frames, so the output at
+     * getOutputFps() keeps the source timing. Keyframes come at irregular
+     * intervals; the writer repeats each one until the next is due, so
+     * it stays at its source time in the constant-rate output. Keyframe
+     * positions of video files come from a demuxer scan; where that is
+     * not possible, startProcessing() fails.
+     *
+     * @param sampling Frames to keep
+     */
+    void setSampling(const Sampling& sampling);
+
+    /**
+     * @brief Get the frame selection
+     *
+     * @return Current sampling
+     */
+    Sampling getSampling() const;
+
+    /**
+     * @brief Pace processing at the source frame rate
+     *
+     * The late frame policy only applies while no video is being saved,
+     * so a saved video keeps every frame filtered in full. Sources without
+     * a frame rate are not paced. Takes effect the next time processing is
+     * started.
+     *
+     * @param realTime Pacing and late frame policy
+     */
+    void setRealTime(const RealTime& realTime);
+
+    /**
+     * @brief Get the real-time playback options
+     *
+     * @return Current options
+     */
+    RealTime getRealTime() const;
+
+    /**
+     * @brief Lower the resolution of the filters when they fall behind
+     *
+     * A QualityGovernor compares each frame's filter time with the frame
+     * budget, the worker count times the source frame interval, and moves
+     * the resolution frames are filtered at between 1.0, 0.75 and 0.5 of
+     * the source. Such frames stay small on their way through the pipeline
+     * and are only upscaled for display. Chains with a filter that is
+     * neither resolution-invariant nor scalable (see Filter::createScaled())
+     * always run at full resolution, and so does everything while an
+     * output file is open. Takes effect the next time processing is started.
+     *
+     * @param enabled True to let the governor lower the resolution
+     */
+    void setQualityGovernor(bool enabled);
+
+    /**
+     * @brief Check whether the quality governor is enabled
+     *
+     * @return true if the filter resolution follows the load
+     */
+    bool isQualityGovernorEnabled() const;
+
+    /**
+     * @brief Get the governor's current level and load
+     *
+     * @return Governor statistics; budgetMs is 0 while it is inactive
+     */
+    QualityGovernor::Stats getQualityStats() const;
+
+    /**
+     * @brief Get the frame rate of the opened video
+     *
+     * @return Source frames per second, or 0 if unknown
+     */
+    double getFps() const;
+
+    /**
+     * @brief Get the frame rate of the processed frames
+     *
+     * @return Source frame rate reduced by the sampling
+     */
+    double getOutputFps() const;
+
     /**
      * @brief Set the output file for saving processed video
      * 
      * @param filename Path to the output file
      * @param fourcc FourCC codec code (e.g., cv::VideoWriter::fourcc('M','J','P','G'))
-     * @param fps Frames per second for the output video
+     * @param fps Frames per second for the output video, or 0 for getOutputFps()
      * @return true if the output file was set successfully, false otherwise
      */
     bool setOutputFile(const std::string& filename, int fourcc, double fps);
@@ -95,10 +390,90 @@ public:
     /**
      * @brief Get the latest processed frame
      * 
+     * Makes a copy at the frame's own resolution, which is below the
+     * source's while the quality governor has lowered it; displays should
+     * use getDisplayFrame().
+     * 
      * @return The most recent processed frame
      */
     cv::Mat getLatestFrame();
+
+    /**
+     * @brief Get the latest processed frame without copying it
+     *
+     * The pipeline never writes to a frame once it is published, and the
+     * buffer only returns to its pool when the last view is released.
+     * Views keep pool buffers out of circulation, so do not hold on to
+     * them longer than needed.
+     *
+     * @return The most recent processed frame, or nullptr if there is none
+     */
+    std::shared_ptr<const cv::Mat> getLatestFrameView();
+
+    /**
+     * @brief Get counters of the handoff of the latest frame to readers
+     *
+     * @return Publish and read counters since processing started
+     */
+    LatestFrameStats getLatestFrameStats() const;
+
+    /**
+     * @brief Set the size of the frames handed out by getDisplayFrame()
+     *
+     * @param size Display size, or an empty size for the source resolution
+     */
+    void setDisplaySize(cv::Size size);
+
+    /**
+     * @brief Get the latest processed frame scaled to the display size
+     *
+     * Each call asks for one display frame: the next frame leaving the
+     * pipeline is scaled down by the output thread and handed over through
+     * a triple buffer, so frames are only scaled as often as a display
+     * polls, and not at all while nobody does. When no frame arrived since
+     * the last call but the latest one was never scaled, e.g. the last
+     * frame before a pause or a re-rendered paused frame, it is scaled on
+     * the calling thread.
+     *
+     * Call from a single display thread.
+     *
+     * @param frame Receives a header of the display frame; the data stays
+     *              valid and unchanged until the next call
+     * @return true if there is a frame to show
+     */
+    bool getDisplayFrame(cv::Mat& frame);
+
+    /**
+     * @brief Wait until a new display frame is ready
+     *
+     * Also asks for one, like getDisplayFrame(): the next frame leaving the
+     * pipeline is scaled and wakes the caller. A display loop that blocks
+     * here repaints as often as frames arrive and sleeps while paused.
+     *
+     * @param timeout Longest wait
+     * @return true if getDisplayFrame() has a new frame to hand out
+     */
+    bool waitForDisplayFrame(std::chrono::milliseconds timeout);
     
+    /**
+     * @brief Re-render the displayed frame after a filter parameter change
+     *
+     * While paused, the pipeline produces no frames, so a configure() call
+     * would only show on the next frame played. Call this from the display
+     * loop: when the filter chain differs from the one the latest frame was
+     * made with, only the stages from the first changed filter on are run
+     * again, starting from the cached result of the stage before it, or
+     * from the retained source frame. The new result replaces the latest
+     * frame. Nothing is done while the chain is unchanged.
+     *
+     * Frames taken whole from the filter cache have their source frame
+     * retrieved as well while the display is enabled; a frame without
+     * one is left as it is.
+     *
+     * @return true if the latest frame was replaced
+     */
+    bool refreshPausedFrame();
+
     /**
      * @brief Check if processing is currently active
      * 
@@ -112,6 +487,124 @@ public:
      * @return Frames per second
      */
     double getFrameRate() const;
+
+    /**
+     * @brief Get the per-stage latency and queue depth instrumentation
+     *
+     * Covers the threaded pipeline: decode, queue wait, the filter chain
+     * and each of its stages, encode and display copies. Samples are reset
+     * when processing starts.
+     *
+     * @return Performance monitor of this processor
+     */
+    const PerformanceMonitor& getPerformanceMonitor() const;
+    
+    /**
+     * @brief Set the memory for caching filtered frames
+     *
+     * Each stage of the filter chain stores its result under the frame
+     * index and the filters up to that stage (see FilterChainPlan). After
+     * a parameter change only the stages from the changed filter on are
+     * reprocessed, and frames whose final result is cached, e.g. after a
+     * restart or when seeking over the same range again, are neither
+     * decoded nor filtered. The cache is cleared when a video is opened.
+     *
+     * @param bytes Cache budget; 0 turns the cache off
+     */
+    void setFilterCacheBudget(size_t bytes);
+
+    /**
+     * @brief Get usage counters of the filtered frame cache
+     *
+     * @return Cache statistics; a hit is a frame that skipped at least one stage
+     */
+    FrameCache::Stats getFilterCacheStats() const;
+
+    /**
+     * @brief Set the memory budget for frames in flight
+     *
+     * The capture and output pools are sized from this budget and the
+     * frame size; what the output pool leaves bounds how far capture can
+     * run ahead of processing. A budget below the few frames per worker
+     * that the pipeline needs is raised to that, with a warning. Takes
+     * effect the next time processing is started.
+     *
+     * @param bytes Budget in bytes
+     */
+    void setFrameMemoryBudget(size_t bytes);
+
+    /**
+     * @brief Get usage counters of the pool that feeds decoded frames
+     *
+     * @return Capture pool statistics
+     */
+    FramePool::Stats getCapturePoolStats() const;
+
+    /**
+     * @brief Get usage counters of the pool that holds filtered frames
+     *
+     * @return Output pool statistics
+     */
+    FramePool::Stats getOutputPoolStats() const;
+
+    /**
+     * @brief Get the number of frames that left the pipeline
+     *
+     * @return Frames emitted since processing started
+     */
+    uint64_t getProcessedFrameCount() const;
+
+    /**
+     * @brief Get the number of frames decoded
+     *
+     * @return Frames read from the input since processing started
+     */
+    uint64_t getCapturedFrameCount() const;
+
+    /**
+     * @brief Get the number of decoded frames that were discarded
+     *
+     * Frames still in flight when a seek happens are dropped instead of
+     * being shown or written, and so are late frames in real-time mode
+     * with the DropOldest policy.
+     *
+     * @return Frames dropped since processing started
+     */
+    uint64_t getDroppedFrameCount() const;
+
+    /**
+     * @brief Get the number of frames that missed their time in real-time mode
+     *
+     * Counts every late frame, whether the policy dropped it, skipped its
+     * filters or filtered it at a lower resolution.
+     *
+     * @return Late frames since processing started
+     */
+    uint64_t getLateFrameCount() const;
+
+    /**
+     * @brief Get the number of source frames passed over by the sampling
+     *
+     * @return Frames grabbed but not retrieved since processing started
+     */
+    uint64_t getSkippedFrameCount() const;
+
+    /**
+     * @brief Get timing and backlog counters of the encoder stage
+     *
+     * @return Encoder statistics since processing started
+     */
+    EncoderStats getEncoderStats() const;
+
+    /**
+     * @brief Get the average number of frame bytes copied per output frame
+     *
+     * Counts every full-frame deep copy made by the pipeline, including the
+     * copies handed to display readers.
+     *
+     * @return Bytes copied divided by the number of frames emitted
+     */
+    double getCopiedBytesPerFrame() const;
     
     /**
      * @brief Get the current frame position
@@ -130,6 +623,9 @@ public:
     /**
      * @brief Seek to a specific frame in the video
      * 
+     * With keyframe indexing (see setSeekOptions()) this returns at once
+     * and the capture thread positions the decoder.
+     * 
      * @param framePos Frame index to seek to
      * @return true if seeking was successful, false otherwise
      */
@@ -150,8 +646,8 @@ public:
     bool restartVideo();
 
 private:
-    // Video capture and properties
-    cv::VideoCapture videoCapture;
+    // Input frames and their properties
+    std::unique_ptr<FrameSource> frameSource;
     cv::VideoWriter videoWriter;
     std::string inputFilename;
     std::string outputFilename;
@@ -161,6 +657,20 @@ private:
     int currentFrame;
     double fps;
     bool videoEnded;
+
+    // Frame selection; keyframe sampling refuses to start on sources that
+    // cannot tell keyframes apart
+    Sampling sampling;
+    SeekOptions seekOptions;
+
+    // Real-time pacing; the capture thread restarts its clock when asked,
+    // e.g. after a pause
+    RealTime realTime;
+    std::atomic<bool> clockResync;
+
+    // Working resolution of the filters under load
+    bool qualityGovernorEnabled;
+    QualityGovernor qualityGovernor;
     
     // Processing state
     std::atomic<bool> processing;
@@ -171,30 +681,197 @@ private:
     std::vector<std::shared_ptr<Filter>> filters;
     mutable std::mutex filtersMutex;
 
-    // Frame queue for thread communication
-    const size_t MAX_QUEUE_SIZE = 10;
-    std::queue<cv::Mat> frameQueue;
-    std::mutex queueMutex;
-    std::condition_variable queueCondition;
+    // Frame travelling through the pipeline. Frames captured before the
+    // latest seek carry an older generation and are dropped on the way.
+    struct FramePacket {
+        uint64_t generation = 0;
+        uint64_t queuedAt = 0;      ///< PerformanceMonitor::now() when handed to a worker
+        uint64_t dueAt = 0;         ///< Source time in PerformanceMonitor::now() terms; 0 if not paced
+        int frameIndex = 0;         ///< Position of the frame in the source
+        bool filtered = false;      ///< The frame came filtered from the filter cache
+        uint64_t resultKey = 0;     ///< FilterChainPlan::resultKey() of the chain applied
+        FramePool::Handle frame;
+        FramePool::Handle input;    ///< Unfiltered frame, kept until the frame is emitted
+    };
+
+    // Filter chain for frames below full resolution, kept by each worker and
+    // rebuilt when the chain, its parameters or the scale change
+    struct ScaledChain {
+        uint64_t signature = 0;     ///< resultKey() of the full-resolution chain
+        double scale = 0.0;
+        bool valid = false;         ///< Every enabled filter runs at this scale
+        std::vector<std::shared_ptr<Filter>> filters;
+    };
+
+    // Recycled frame buffers; the capture pool size bounds the queues
+    size_t frameMemoryBudget;
+    FramePool capturePool;
+    FramePool outputPool;
+
+    // Results of the filter chain stages, shared by every worker's plan
+    FrameCache filterCache;
+    std::atomic<bool> filterCacheEnabled;
+
+    // Per-worker lanes: capture -> worker and worker -> output thread
+    std::vector<std::unique_ptr<SpscRing<FramePacket>>> workerInputs;
+    std::vector<std::unique_ptr<SpscRing<FramePacket>>> workerOutputs;
+
+    // Lane of every dispatched frame, in capture order; the output thread
+    // follows it to reassemble the frames in order
+    SpscRing<size_t> dispatchOrder;
+    std::atomic<uint64_t> pipelineGeneration;
+
+    // Output thread -> writer thread
+    static constexpr size_t WRITER_QUEUE_CAPACITY = 8;
+    SpscRing<FramePacket> writerQueue;
+    std::atomic<bool> writerEnabled;
+    std::mutex writerMutex;
+    EncoderStats encoderStats;
+    mutable std::mutex encoderStatsMutex;
+
+    // Set when a stage has exited, so the next one drains its queue and stops
+    std::atomic<bool> captureFinished;
+    std::atomic<size_t> workersRunning;
+    std::atomic<bool> outputFinished;
+    bool writerFinished;
+    std::mutex completionMutex;
+    std::condition_variable completionCondition;
+
+    // Pause handling for the capture thread
+    std::mutex pauseMutex;
+    std::condition_variable pauseCondition;
+
+    // Per-frame buffers reused by processFrameBatch()
+    struct BatchSlot {
+        cv::Mat input;
+        cv::Mat output;
+        FilterChainPlan plan;
+    };
+    std::vector<BatchSlot> batchSlots;
 
     // Processing threads
+    size_t workerCount;
+
+    // Intra-frame tiling; the pool is shared by all workers and kept
+    // between runs
+    int tileRows;
+    std::unique_ptr<ThreadPool> tilePool;
     std::thread captureThread;
-    std::thread processingThread;
+    std::vector<std::thread> processingThreads;
+    std::thread outputThread;
+    std::thread writerThread;
+
+    // Latest processed frame for display, with the source frame and chain
+    // it was made from so that it can be re-rendered while paused
+    struct LatestFrame {
+        FramePool::Handle frame;
+        FramePool::Handle input;
+        int frameIndex = -1;
+        uint64_t resultKey = 0;
+        uint64_t sequence = 0;      ///< Unique per published or re-rendered frame
+    };
+
+    // The output thread publishes without locking; readers take turns on
+    // the consumer side under readerMutex, so a slow reader never holds up
+    // the pipeline
+    std::atomic<bool> displayEnabled;
+    TripleBuffer<LatestFrame> latestFrames;
+    std::mutex readerMutex;
+    std::atomic<uint64_t> frameSequence;
+    std::atomic<uint64_t> framesPublished;
+    std::atomic<uint64_t> publishesSkipped;
+    std::atomic<uint64_t> latestReads;
+    std::atomic<uint64_t> staleReads;
 
-    // Latest processed frame for display
-    cv::Mat latestFrame;
-    std::mutex frameMutex;
+    // Display-size copies of the latest frame; producers of the back
+    // buffer take displayMutex and signal displayReady after publishing
+    cv::Size displaySize;
+    TripleBuffer<cv::Mat> displayBuffer;
+    std::atomic<bool> displayRequested;
+    std::atomic<uint64_t> displaySequence;  ///< Sequence of the last frame scaled for display
+    std::mutex displayMutex;
+    std::condition_variable displayReady;
 
-    // Performance monitoring
-    std::chrono::time_point<std::chrono::high_resolution_clock> lastFrameTime;
+    // Re-rendering of the paused frame; without the filter cache the stage
+    // results of the displayed frame are kept in a cache of its own
+    FilterChainPlan refreshPlan;
+    FrameCache refreshCache;
+    std::mutex refreshMutex;
+
+    // Performance monitoring; the display recorder is shared by the display
+    // copies under displayMutex
+    std::chrono::time_point<std::chrono::steady_clock> lastFrameTime;
     double currentFps;
     mutable std::mutex fpsMutex;
+    PerformanceMonitor performanceMonitor;
+    PerformanceMonitor::Recorder displayRecorder;
+    size_t captureQueueId;
+    size_t reorderQueueId;
+    size_t writerQueueId;
+
+    // Copy traffic accounting
+    std::atomic<uint64_t> copiedBytes;
+    std::atomic<uint64_t> framesEmitted;
+    std::atomic<uint64_t> framesCaptured;
+    std::atomic<uint64_t> framesDropped;
+    std::atomic<uint64_t> framesSkipped;
+    std::atomic<uint64_t> framesLate;
+    void recordCopy(const cv::Mat& frame);
     
     // Thread functions
     void captureThreadFunc();
-    void processingThreadFunc();
+    void processingThreadFunc(size_t lane);
+    void outputThreadFunc();
+    void writerThreadFunc();
+
+    // Stop capture, let the later stages drain and join every thread
+    void shutdownPipeline();
+
+    // Drop queued and pending frames, e.g. after a seek
+    void resetSequencing();
+
+    // Size the frame pools and lanes for the current video and worker count
+    void resetFramePools();
+    void resetLanes();
+
+    // Pick the lane for the next captured frame
+    size_t selectLane() const;
+
+    // Wake every thread blocked on a ring or on pause
+    void wakeAllThreads();
+
+    // Queue for writing and display a frame that is next in output order
+    void emitFrame(const FramePacket& packet);
+
+    // Scale a frame to the display size into the display buffer, unless a
+    // newer one was published already
+    void publishDisplayFrame(const cv::Mat& frame, uint64_t sequence);
+
+    // Take the newest published frame as the readers' current one
+    LatestFrame readLatestFrame();
+
+    // Grab source frames until the sampling keeps one, then retrieve it;
+    // with `filtered`, a cached result of the current chain is taken
+    // instead of retrieving the frame when there is one, and its key is
+    // stored in `resultKey`
+    bool readSampledFrame(cv::Mat& frame, int& frameIndex, bool* filtered = nullptr,
+                          uint64_t* resultKey = nullptr);
+
+    // Check whether the sampling keeps the frame just grabbed
+    bool isSampled(int frameIndex);
+
+    // Check whether the chain has anything to apply
+    static bool hasEnabledFilter(const std::vector<std::shared_ptr<Filter>>& chain);
+
+    // Check whether any enabled filter needs frames in order
+    static bool requiresSerialProcessing(const std::vector<std::shared_ptr<Filter>>& chain);
 
+    // Bring `scaled` up to date for the chain at `scale`; false if the chain
+    // has to run at full resolution
+    static bool updateScaledChain(const std::vector<std::shared_ptr<Filter>>& chain, double scale,
+                                  ScaledChain& scaled);
     
-    // Apply all filters to a frame
-    void applyFilters(const cv::Mat& input, cv::Mat& output);
+    // Apply all filters to a frame through a plan, rebuilt when the chain changes
+    void applyFilters(const std::vector<std::shared_ptr<Filter>>& chain,
+                      const cv::Mat& input, cv::Mat& output, FilterChainPlan& plan, int frameIndex = -1);
 };
\ No newline at end of file
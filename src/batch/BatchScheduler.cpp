@@ -0,0 +1,165 @@
+#include "BatchScheduler.h"
+#include "../filters/FilterFactory.h"
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+
+BatchScheduler::BatchScheduler(size_t threadCount, size_t memoryBudgetBytes, int fourcc, size_t framesPerBatch)
+    : pool(threadCount), memoryBudget(memoryBudgetBytes), fourcc(fourcc),
+      framesPerBatch(std::max<size_t>(1, framesPerBatch)),
+      reservedBytes(0), activeJobs(0), completedJobs(0), results(nullptr) {
+}
+
+bool BatchScheduler::loadManifest(const std::string& filename, std::vector<BatchJob>& jobs) {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error: Could not open manifest: " << filename << std::endl;
+        return false;
+    }
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(file, line)) {
+        ++lineNumber;
+        std::istringstream fields(line);
+        BatchJob job;
+        if (!(fields >> job.inputFile) || job.inputFile[0] == '#') {
+            continue;
+        }
+        if (!(fields >> job.outputFile)) {
+            std::cerr << "Error: Missing output file in " << filename << ":" << lineNumber << std::endl;
+            return false;
+        }
+        fields >> job.filterSpec;
+        jobs.push_back(job);
+    }
+    return true;
+}
+
+std::vector<BatchJobResult> BatchScheduler::run(const std::vector<BatchJob>& jobs) {
+    std::vector<BatchJobResult> jobResults(jobs.size());
+    results = &jobResults;
+    completedJobs = 0;
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        jobResults[i].job = jobs[i];
+
+        std::shared_ptr<VideoProcessor> processor = prepareJob(jobs[i]);
+        if (!processor) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++completedJobs;
+            printProgress(jobResults[i]);
+            continue;
+        }
+
+        // Input, output and two intermediate frames per batch slot
+        auto job = std::make_shared<ActiveJob>();
+        job->index = i;
+        job->processor = processor;
+        job->reservedBytes = processor->getFrameBytes() * framesPerBatch * 4;
+
+        // Wait until the job fits into the budget; a job that is larger
+        // than the whole budget runs on its own
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobFinished.wait(lock, [this, &job] {
+                return activeJobs == 0 || reservedBytes + job->reservedBytes <= memoryBudget;
+            });
+            reservedBytes += job->reservedBytes;
+            ++activeJobs;
+        }
+
+        job->start = std::chrono::steady_clock::now();
+        pool.submit([this, job] { runStep(job); }, false);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    jobFinished.wait(lock, [this] { return activeJobs == 0; });
+    results = nullptr;
+    return jobResults;
+}
+
+std::shared_ptr<VideoProcessor> BatchScheduler::prepareJob(const BatchJob& job) {
+    std::vector<std::shared_ptr<Filter>> chain;
+    if (!FilterFactory::createChain(job.filterSpec, chain)) {
+        return nullptr;
+    }
+
+    auto processor = std::make_shared<VideoProcessor>();
+    if (!processor->openVideo(job.inputFile)) {
+        return nullptr;
+    }
+
+    if (!processor->setOutputFile(job.outputFile, fourcc, 0)) {
+        return nullptr;
+    }
+
+    for (const auto& filter : chain) {
+        processor->addFilter(filter);
+    }
+    return processor;
+}
+
+void BatchScheduler::runStep(std::shared_ptr<ActiveJob> job) {
+    bool moreFrames = false;
+    try {
+        moreFrames = job->processor->processFrameBatch(pool, framesPerBatch);
+    } catch (const std::exception& e) {
+        // cv::Exception, but also std::bad_alloc or std::system_error; only
+        // this job fails, the pool thread and the other videos carry on
+        std::cerr << "Error processing " << (*results)[job->index].job.inputFile
+                  << ": " << e.what() << std::endl;
+        finishJob(job, false);
+        return;
+    }
+
+    if (moreFrames) {
+        // Requeue instead of looping so the other videos get their turn
+        pool.submit([this, job] { runStep(job); }, false);
+    } else {
+        finishJob(job, true);
+    }
+}
+
+void BatchScheduler::finishJob(const std::shared_ptr<ActiveJob>& job, bool success) {
+    job->processor->stopProcessing();
+
+    BatchJobResult& result = (*results)[job->index];
+    result.success = success;
+    result.frames = job->processor->getProcessedFrameCount();
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - job->start).count();
+    job->processor.reset();
+
+    std::lock_guard<std::mutex> lock(mutex);
+    ++completedJobs;
+    printProgress(result);
+
+    reservedBytes -= job->reservedBytes;
+    --activeJobs;
+    jobFinished.notify_all();
+}
+
+void BatchScheduler::printProgress(const BatchJobResult& result) const {
+    std::cout << "[" << completedJobs << "/" << results->size() << "] "
+              << result.job.inputFile << " -> " << result.job.outputFile << ": "
+              << (result.success ? "" : "FAILED, ") << result.frames << " frames, "
+              << std::fixed << std::setprecision(2) << result.seconds << " s, "
+              << (result.seconds > 0 ? result.frames / result.seconds : 0.0) << " fps" << std::endl;
+}
+
+void BatchScheduler::printSummary(const std::vector<BatchJobResult>& results, double seconds) {
+    uint64_t frames = 0;
+    size_t failed = 0;
+    for (const BatchJobResult& result : results) {
+        frames += result.frames;
+        if (!result.success) {
+            ++failed;
+        }
+    }
+
+    std::cout << std::endl;
+    std::cout << "Batch finished: " << results.size() << " files, " << failed << " failed" << std::endl;
+    std::cout << "  " << frames << " frames in " << std::fixed << std::setprecision(2) << seconds
+              << " s (" << (seconds > 0 ? frames / seconds : 0.0) << " fps aggregate)" << std::endl;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include "../VideoProcessor.h"
+#include "../utils/ThreadPool.h"
+
+/**
+ * @brief One input/output pair of a batch manifest
+ */
+struct BatchJob {
+    std::string inputFile;      ///< Video to read
+    std::string outputFile;     ///< Video to write
+    std::string filterSpec;     ///< Filter chain, see FilterFactory
+};
+
+/**
+ * @brief Outcome of one batch job
+ */
+struct BatchJobResult {
+    BatchJob job;
+    bool success = false;       ///< true if the whole video was written
+    uint64_t frames = 0;        ///< Frames written
+    double seconds = 0.0;       ///< Wall time from start to finish of this job
+};
+
+/**
+ * @brief Runs many short videos concurrently on one shared thread pool
+ *
+ * Instead of giving every video its own capture and processing threads,
+ * each video is driven by a task that decodes a few frames and queues one
+ * filter task per frame on the shared work-stealing pool, then requeues
+ * itself. Videos are admitted while their frame buffers fit into a global
+ * memory budget, so the number of videos in flight adapts to their
+ * resolution.
+ */
+class BatchScheduler {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param threadCount Pool threads (0 = one per hardware thread)
+     * @param memoryBudgetBytes Frame memory that all running videos may use together
+     * @param fourcc Codec of the output files, see cv::VideoWriter::fourcc()
+     * @param framesPerBatch Frames decoded per scheduling step of a video
+     */
+    BatchScheduler(size_t threadCount, size_t memoryBudgetBytes, int fourcc, size_t framesPerBatch = 8);
+
+    /**
+     * @brief Read a manifest file
+     *
+     * Each non-empty line not starting with '#' holds an input path, an
+     * output path and an optional filter chain, separated by whitespace.
+     *
+     * @param filename Path to the manifest
+     * @param jobs Receives the jobs in file order
+     * @return true if the manifest was read without errors
+     */
+    static bool loadManifest(const std::string& filename, std::vector<BatchJob>& jobs);
+
+    /**
+     * @brief Process every job and wait for all of them
+     *
+     * @param jobs Jobs to run
+     * @return One result per job, in the order of the jobs
+     */
+    std::vector<BatchJobResult> run(const std::vector<BatchJob>& jobs);
+
+    /**
+     * @brief Print aggregate throughput of a finished batch
+     *
+     * @param results Results returned by run()
+     * @param seconds Wall time of the whole batch
+     */
+    static void printSummary(const std::vector<BatchJobResult>& results, double seconds);
+
+private:
+    // A job that has been admitted and is being processed
+    struct ActiveJob {
+        size_t index = 0;
+        std::shared_ptr<VideoProcessor> processor;
+        size_t reservedBytes = 0;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    ThreadPool pool;
+    size_t memoryBudget;
+    int fourcc;
+    size_t framesPerBatch;
+
+    // Admission state
+    std::mutex mutex;
+    std::condition_variable jobFinished;
+    size_t reservedBytes;
+    size_t activeJobs;
+    size_t completedJobs;
+    std::vector<BatchJobResult>* results;
+
+    // Open a job's input and output and build its filter chain
+    std::shared_ptr<VideoProcessor> prepareJob(const BatchJob& job);
+
+    // Process the next batch of a job and requeue it, or finish it
+    void runStep(std::shared_ptr<ActiveJob> job);
+
+    // Record the result of a job and release its memory reservation
+    void finishJob(const std::shared_ptr<ActiveJob>& job, bool success);
+
+    // Print the progress line of a finished or failed job; call with mutex held
+    void printProgress(const BatchJobResult& result) const;
+};
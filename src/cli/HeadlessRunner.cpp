@@ -0,0 +1,303 @@
+#include "HeadlessRunner.h"
+#include "../filters/FilterFactory.h"
+#include "../batch/BatchScheduler.h"
+#include "../metrics/MetricsExporter.h"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+// Upper limits that catch typos without getting in the way of real machines
+const long long MAX_WORKERS = 1024;
+const long long MAX_MEMORY_BUDGET_MB = 1024 * 1024;
+const long long MAX_TILE_ROWS = 1 << 16;
+const long long MAX_METRICS_INTERVAL_MS = 24 * 60 * 60 * 1000;
+
+// Parse a whole decimal number in [1, maximum]; std::stoul would accept
+// "-1" and wrap it around to a huge count
+bool parsePositive(const std::string& text, long long maximum, long long& value) {
+    try {
+        size_t used = 0;
+        value = std::stoll(text, &used);
+        return used == text.size() && value > 0 && value <= maximum;
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+}  // namespace
+
+bool HeadlessRunner::isHeadlessInvocation(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--", 2) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HeadlessRunner::parseArguments(int argc, char* argv[], HeadlessOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            return false;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--in") {
+            options.inputFile = value;
+        } else if (arg == "--out") {
+            options.outputFile = value;
+        } else if (arg == "--filters") {
+            options.filterSpec = value;
+        } else if (arg == "--codec") {
+            options.codec = value;
+        } else if (arg == "--workers") {
+            long long count = 0;
+            if (!parsePositive(value, MAX_WORKERS, count)) {
+                std::cerr << "Error: Invalid worker count: " << value << std::endl;
+                return false;
+            }
+            options.workerCount = static_cast<size_t>(count);
+        } else if (arg == "--tile-rows") {
+            // 0 turns tiling off, as if the option were not given
+            long long rows = 0;
+            if (value != "0" && !parsePositive(value, MAX_TILE_ROWS, rows)) {
+                std::cerr << "Error: Invalid tile size: " << value << std::endl;
+                return false;
+            }
+            options.tileRows = static_cast<int>(rows);
+        } else if (arg == "--batch") {
+            options.manifestFile = value;
+        } else if (arg == "--memory-budget") {
+            long long megabytes = 0;
+            if (!parsePositive(value, MAX_MEMORY_BUDGET_MB, megabytes)) {
+                std::cerr << "Error: Invalid memory budget: " << value << std::endl;
+                return false;
+            }
+            options.memoryBudgetMB = static_cast<size_t>(megabytes);
+        } else if (arg == "--sample") {
+            options.sampling = value;
+        } else if (arg == "--realtime") {
+            options.realTime = value;
+        } else if (arg == "--metrics") {
+            options.metricsTarget = value;
+        } else if (arg == "--metrics-format") {
+            options.metricsFormat = value;
+        } else if (arg == "--metrics-interval") {
+            long long milliseconds = 0;
+            if (!parsePositive(value, MAX_METRICS_INTERVAL_MS, milliseconds)) {
+                std::cerr << "Error: Invalid metrics interval: " << value << std::endl;
+                return false;
+            }
+            options.metricsIntervalMs = static_cast<int>(milliseconds);
+        } else {
+            std::cerr << "Error: Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+
+    if (options.manifestFile.empty() && (options.inputFile.empty() || options.outputFile.empty())) {
+        std::cerr << "Error: --in and --out (or --batch) are required." << std::endl;
+        return false;
+    }
+
+    VideoProcessor::Sampling sampling;
+    if (!VideoProcessor::Sampling::parse(options.sampling, sampling)) {
+        std::cerr << "Error: Sampling must be all, every:N, fps:RATE or keyframes[:RATE]: "
+                  << options.sampling << std::endl;
+        return false;
+    }
+
+    if (sampling.mode != VideoProcessor::Sampling::Mode::All && !options.manifestFile.empty()) {
+        std::cerr << "Error: --sample is only supported for single-video runs." << std::endl;
+        return false;
+    }
+
+    // drop, skip and degrade only shed work for the preview, and a
+    // headless run saves every frame, so they would all just pace it
+    VideoProcessor::RealTime realTime;
+    if (!VideoProcessor::RealTime::parse(options.realTime, realTime) ||
+        (realTime.policy != VideoProcessor::RealTime::Policy::Off &&
+         realTime.policy != VideoProcessor::RealTime::Policy::Pace)) {
+        std::cerr << "Error: Real-time mode must be off or pace, with an optional :MS latency: "
+                  << options.realTime << std::endl;
+        return false;
+    }
+
+    if (realTime.policy != VideoProcessor::RealTime::Policy::Off && !options.manifestFile.empty()) {
+        std::cerr << "Error: --realtime is only supported for single-video runs." << std::endl;
+        return false;
+    }
+
+    MetricsExporter::Format format;
+    if (!MetricsExporter::parseFormat(options.metricsFormat, format)) {
+        std::cerr << "Error: Metrics format must be json or prometheus: " << options.metricsFormat << std::endl;
+        return false;
+    }
+
+    if (!options.metricsTarget.empty() && !options.manifestFile.empty()) {
+        std::cerr << "Error: --metrics is only supported for single-video runs." << std::endl;
+        return false;
+    }
+
+    if (options.codec.size() != 4) {
+        std::cerr << "Error: Codec must be a four-character code: " << options.codec << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+void HeadlessRunner::printUsage() {
+    std::cout << "Usage: VideoFilterApp --in <input> --out <output> [options]" << std::endl;
+    std::cout << "       VideoFilterApp --batch <manifest> [options]" << std::endl;
+    std::cout << "  --filters <chain>   Filters to apply, e.g. blur:kernelSize=7,edge" << std::endl;
+    std::cout << "                      Available: " << FilterFactory::availableFilters() << std::endl;
+    std::cout << "  --codec <fourcc>    Output codec (default: mp4v)" << std::endl;
+    std::cout << "  --workers <n>       Processing threads (default: one per core)" << std::endl;
+    std::cout << "  --tile-rows <n>     Split each frame into tiles of n rows (default: off)" << std::endl;
+    std::cout << "  --memory-budget <MB> Frame memory for all videos of a batch (default: 1024)" << std::endl;
+    std::cout << "  --sample <mode>     Frames to process: all (default), every:N, fps:RATE" << std::endl;
+    std::cout << "                      or keyframes[:RATE]; skipped frames are not fully decoded" << std::endl;
+    std::cout << "  --realtime <mode>   off (default) or pace[:MS]: read at the source frame rate and" << std::endl;
+    std::cout << "                      count frames more than MS late (default 100); every frame" << std::endl;
+    std::cout << "                      is still filtered in full and saved" << std::endl;
+    std::cout << "  --metrics <target>  Export metrics to a file or unix:<socket path>" << std::endl;
+    std::cout << "  --metrics-format <f> json (JSON lines, default) or prometheus" << std::endl;
+    std::cout << "  --metrics-interval <ms> Time between snapshots written to a file (default: 1000)" << std::endl;
+    std::cout << "Manifest lines: <input> <output> [filters]" << std::endl;
+}
+
+HeadlessRunner::HeadlessRunner(const HeadlessOptions& options)
+    : options(options), processor(std::make_shared<VideoProcessor>()) {
+}
+
+int HeadlessRunner::run() {
+    return options.manifestFile.empty() ? runSingle() : runBatch();
+}
+
+int HeadlessRunner::runBatch() {
+    std::vector<BatchJob> jobs;
+    if (!BatchScheduler::loadManifest(options.manifestFile, jobs)) {
+        return 1;
+    }
+
+    int fourcc = cv::VideoWriter::fourcc(options.codec[0], options.codec[1],
+                                         options.codec[2], options.codec[3]);
+    BatchScheduler scheduler(options.workerCount, options.memoryBudgetMB * 1024 * 1024, fourcc);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchJobResult> results = scheduler.run(jobs);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    BatchScheduler::printSummary(results, seconds);
+    for (const BatchJobResult& result : results) {
+        if (!result.success) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int HeadlessRunner::runSingle() {
+    std::vector<std::shared_ptr<Filter>> chain;
+    if (!FilterFactory::createChain(options.filterSpec, chain)) {
+        return 1;
+    }
+
+    if (!processor->openVideo(options.inputFile)) {
+        return 1;
+    }
+
+    // The output frame rate follows from the sampling
+    VideoProcessor::Sampling sampling;
+    VideoProcessor::Sampling::parse(options.sampling, sampling);
+    processor->setSampling(sampling);
+    VideoProcessor::RealTime realTime;
+    VideoProcessor::RealTime::parse(options.realTime, realTime);
+    processor->setRealTime(realTime);
+
+    int fourcc = cv::VideoWriter::fourcc(options.codec[0], options.codec[1],
+                                         options.codec[2], options.codec[3]);
+    if (!processor->setOutputFile(options.outputFile, fourcc, 0)) {
+        return 1;
+    }
+
+    for (const auto& filter : chain) {
+        processor->addFilter(filter);
+    }
+    if (options.workerCount > 0) {
+        processor->setWorkerCount(options.workerCount);
+    }
+    processor->setTileRows(options.tileRows);
+
+    // Nobody looks at the frames, so do not keep them for display
+    processor->setDisplayEnabled(false);
+
+    std::unique_ptr<MetricsExporter> exporter;
+    if (!options.metricsTarget.empty()) {
+        MetricsExporter::Options metricsOptions;
+        metricsOptions.target = options.metricsTarget;
+        MetricsExporter::parseFormat(options.metricsFormat, metricsOptions.format);
+        metricsOptions.intervalMs = options.metricsIntervalMs;
+        metricsOptions.label = options.inputFile;
+        exporter = std::make_unique<MetricsExporter>(*processor, metricsOptions);
+        if (!exporter->start()) {
+            return 1;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!processor->startProcessing()) {
+        return 1;
+    }
+
+    processor->waitForCompletion();
+    processor->stopProcessing();
+    if (exporter) {
+        exporter->stop();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printStats(seconds);
+    return 0;
+}
+
+void HeadlessRunner::printStats(double seconds) const {
+    uint64_t frames = processor->getProcessedFrameCount();
+    VideoProcessor::EncoderStats encoder = processor->getEncoderStats();
+    FramePool::Stats capturePool = processor->getCapturePoolStats();
+    FramePool::Stats outputPool = processor->getOutputPoolStats();
+
+    std::cout << std::endl;
+    std::cout << "Processed " << frames << " frames in " << std::fixed << std::setprecision(2)
+              << seconds << " s (" << (seconds > 0 ? frames / seconds : 0.0) << " fps)" << std::endl;
+    if (processor->getSkippedFrameCount() > 0) {
+        std::cout << "  Sampling: kept " << processor->getCapturedFrameCount() << " of "
+                  << processor->getCapturedFrameCount() + processor->getSkippedFrameCount()
+                  << " source frames, output at " << processor->getOutputFps() << " fps" << std::endl;
+    }
+    if (processor->getRealTime().policy != VideoProcessor::RealTime::Policy::Off) {
+        std::cout << "  Real time: " << processor->getLateFrameCount() << " late frames" << std::endl;
+    }
+    std::cout << "  Workers: " << processor->getWorkerCount();
+    if (processor->getTileRows() > 0) {
+        std::cout << ", tiles of " << processor->getTileRows() << " rows";
+    }
+    std::cout << std::endl;
+    std::cout << "  Encode: " << encoder.averageEncodeMs << " ms/frame avg, "
+              << encoder.maxEncodeMs << " ms max, queue peak "
+              << encoder.peakQueueDepth << "/" << encoder.queueCapacity << std::endl;
+    std::cout << "  Capture pool: peak " << capturePool.peakInUse << "/" << capturePool.capacity
+              << ", misses " << capturePool.allocationMisses << std::endl;
+    std::cout << "  Output pool: peak " << outputPool.peakInUse << "/" << outputPool.capacity
+              << ", misses " << outputPool.allocationMisses << std::endl;
+    processor->getPerformanceMonitor().printReport(std::cout);
+}
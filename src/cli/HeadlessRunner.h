@@ -0,0 +1,93 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include "../VideoProcessor.h"
+
+/**
+ * @brief Options for a headless transcoding run
+ */
+struct HeadlessOptions {
+    std::string inputFile;      ///< Video to read
+    std::string outputFile;     ///< Video to write
+    std::string filterSpec;     ///< Filter chain, e.g. "blur:kernelSize=7,edge"
+    std::string codec = "mp4v"; ///< FourCC of the output codec
+    size_t workerCount = 0;     ///< Processing workers (0 = one per core)
+    int tileRows = 0;           ///< Rows per intra-frame tile (0 = off)
+    std::string manifestFile;   ///< Batch manifest; replaces --in/--out when set
+    size_t memoryBudgetMB = 1024; ///< Frame memory shared by all videos of a batch
+    std::string metricsTarget;  ///< Metrics file or "unix:<path>" socket; empty = off
+    std::string metricsFormat = "json"; ///< "json" or "prometheus"
+    int metricsIntervalMs = 1000; ///< Time between metrics snapshots written to a file
+    std::string sampling = "all"; ///< Frames to process: all, every:N, fps:RATE or keyframes[:RATE]
+    std::string realTime = "off"; ///< Pacing at the source rate: off or pace[:MS]
+};
+
+/**
+ * @brief Runs the processing pipeline without a display
+ *
+ * Opens the input, applies the filter chain and writes the output as fast
+ * as the pipeline allows, then prints throughput statistics. Used on
+ * render nodes and for production jobs, e.g.:
+ *
+ *   VideoFilterApp --in a.mp4 --out b.mp4 --filters blur:kernelSize=7,edge
+ *
+ * With --batch it processes every video listed in a manifest on one
+ * shared thread pool instead (see BatchScheduler).
+ */
+class HeadlessRunner {
+public:
+    /**
+     * @brief Check whether the command line asks for a headless run
+     *
+     * The GUI takes no options, so any "--" argument counts, including
+     * misspelled ones, which parseArguments() then reports.
+     *
+     * @param argc Number of command line arguments
+     * @param argv Command line arguments
+     * @return true if any option is present
+     */
+    static bool isHeadlessInvocation(int argc, char* argv[]);
+
+    /**
+     * @brief Parse headless command line options
+     *
+     * @param argc Number of command line arguments
+     * @param argv Command line arguments
+     * @param options Receives the parsed options
+     * @return true if the options are complete and valid
+     */
+    static bool parseArguments(int argc, char* argv[], HeadlessOptions& options);
+
+    /**
+     * @brief Print the headless command line usage
+     */
+    static void printUsage();
+
+    /**
+     * @brief Constructor
+     *
+     * @param options Options for the run
+     */
+    explicit HeadlessRunner(const HeadlessOptions& options);
+
+    /**
+     * @brief Process the whole input video
+     *
+     * @return Exit code (0 on success)
+     */
+    int run();
+
+private:
+    HeadlessOptions options;
+    std::shared_ptr<VideoProcessor> processor;
+
+    // Process a single video through the threaded pipeline
+    int runSingle();
+
+    // Process every video of the manifest on a shared pool
+    int runBatch();
+
+    // Print throughput and pipeline statistics for the finished run
+    void printStats(double seconds) const;
+};
@@ -1,5 +1,908 @@
-//
-// Created by Damian on 3/6/2025.
-//
-
 #include "ColorEnhanceFilter.h"
+#include "../utils/Simd.h"
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// Luma weights (Q7), within 1/256 of the ones cv::cvtColor uses for BGR to
+// gray; they sum to 128, so gray pixels keep their level. Small enough to be
+// pmaddubsw operands
+const int LUMA_SHIFT = 7;
+const int BLUE_WEIGHT = 15;
+const int GREEN_WEIGHT = 75;
+const int RED_WEIGHT = 38;
+const int LUMA_ROUNDING = 1 << (LUMA_SHIFT - 1);
+
+// Saturation blends each channel with the pixel's luma:
+// value = (value * channel + luma * luma weight) >> shift, rounded. The
+// weights sum to 1 << shift; the shift is 6 for gains below 2 and smaller
+// for larger gains, so the channel weight fits a signed byte
+struct SaturationWeights {
+    int8_t channel;
+    int8_t luma;
+    int shift;
+};
+
+const int SATURATION_SHIFT = 6;
+const int MIN_SATURATION_SHIFT = 3;
+
+// Tone line without gamma: ((value * gain) >> 8 + offset) >> 4, with the
+// contrast gain in Q12 and the offset in Q4, which fits 16-bit lanes
+const int TONE_GAIN_SHIFT = 12;
+const int TONE_SHIFT = 4;
+
+// Row kernels on interleaved pixels.
+// tone:    every byte through the tone table
+// enhance: BGR pixels through the tone table, then the saturation blend
+using ToneKernel = void (*)(const uint8_t* in, uint8_t* out, int count,
+                            const uint8_t* tone, const uint8_t* nibbles);
+using EnhanceKernel = void (*)(const uint8_t* in, uint8_t* out, int pixels,
+                               const uint8_t* tone, const uint8_t* nibbles, SaturationWeights weights);
+
+// The same with the tone line evaluated instead of looked up; the table
+// still serves the tails
+using LinearToneKernel = void (*)(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone,
+                                  uint16_t toneGain, int16_t toneOffset);
+using LinearEnhanceKernel = void (*)(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone,
+                                     uint16_t toneGain, int16_t toneOffset, SaturationWeights weights);
+
+inline int linearTone(int value, int toneGain, int toneOffset) {
+    int level = (((value * toneGain) >> 8) + toneOffset) >> TONE_SHIFT;
+    return std::min(255, std::max(0, level));
+}
+
+inline int luma(int blue, int green, int red) {
+    return (blue * BLUE_WEIGHT + green * GREEN_WEIGHT + red * RED_WEIGHT + LUMA_ROUNDING) >> LUMA_SHIFT;
+}
+
+inline uint8_t saturate(int value, int level, SaturationWeights weights) {
+    int result = (value * weights.channel + level * weights.luma + (1 << (weights.shift - 1))) >> weights.shift;
+    return static_cast<uint8_t>(std::min(255, std::max(0, result)));
+}
+
+void toneScalar(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, const uint8_t*) {
+    for (int i = 0; i < count; ++i) {
+        out[i] = tone[in[i]];
+    }
+}
+
+// BGR or BGRA pixels; alpha is copied
+void enhancePixels(const uint8_t* in, uint8_t* out, int pixels, int channels,
+                   const uint8_t* tone, SaturationWeights weights) {
+    for (int i = 0; i < pixels; ++i, in += channels, out += channels) {
+        int blue = tone[in[0]];
+        int green = tone[in[1]];
+        int red = tone[in[2]];
+        if (channels == 4) {
+            out[3] = in[3];
+        }
+        if (weights.luma == 0) {
+            out[0] = static_cast<uint8_t>(blue);
+            out[1] = static_cast<uint8_t>(green);
+            out[2] = static_cast<uint8_t>(red);
+            continue;
+        }
+
+        int level = luma(blue, green, red);
+        out[0] = saturate(blue, level, weights);
+        out[1] = saturate(green, level, weights);
+        out[2] = saturate(red, level, weights);
+    }
+}
+
+void enhanceScalar(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t*,
+                   SaturationWeights weights) {
+    enhancePixels(in, out, pixels, 3, tone, weights);
+}
+
+// A lookup is as cheap as the line in scalar code
+void linearToneScalar(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, uint16_t, int16_t) {
+    toneScalar(in, out, count, tone, nullptr);
+}
+
+void linearEnhanceScalar(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, uint16_t, int16_t,
+                         SaturationWeights weights) {
+    enhancePixels(in, out, pixels, 3, tone, weights);
+}
+
+#ifdef SIMD_X86
+
+// pshufb masks that gather the luma operands of 16 BGR pixels (three
+// vectors, 48 bytes) and spread luma back over them; 0x80 zeroes a byte
+struct ShuffleMasks {
+    alignas(16) uint8_t blueGreen[2][3][16];   ///< [half][source vector]: blue and green of pixel 8 * half + i / 2
+    alignas(16) uint8_t red[3][16];            ///< [source vector]: red of pixel i / 2 and of pixel 8 + i / 2
+    alignas(16) uint8_t expand[3][16];         ///< [output vector]: luma of the pixel byte i belongs to
+};
+
+ShuffleMasks makeShuffleMasks() {
+    ShuffleMasks masks;
+    for (int vector = 0; vector < 3; ++vector) {
+        for (int i = 0; i < 16; ++i) {
+            for (int half = 0; half < 2; ++half) {
+                int source = 3 * (8 * half + i / 2) + (i & 1);
+                masks.blueGreen[half][vector][i] =
+                    static_cast<uint8_t>(source / 16 == vector ? source % 16 : 0x80);
+            }
+            int source = 3 * ((i & 1) ? 8 + i / 2 : i / 2) + 2;
+            masks.red[vector][i] = static_cast<uint8_t>(source / 16 == vector ? source % 16 : 0x80);
+            masks.expand[vector][i] = static_cast<uint8_t>((16 * vector + i) / 3);
+        }
+    }
+    return masks;
+}
+
+const ShuffleMasks& shuffleMasks() {
+    static const ShuffleMasks masks = makeShuffleMasks();
+    return masks;
+}
+
+// Permutation indices for vpermt2b and vpermb that do the same for 64 BGR
+// pixels (three vectors)
+struct PermuteIndices {
+    alignas(64) uint8_t blueGreen[2][64];   ///< Blue and green of pixel 32 * half + i / 2, from vectors half and half + 1
+    alignas(64) uint8_t red[64];            ///< Red of pixel i / 2 and of pixel 32 + i / 2 from vectors 0 and 1
+    alignas(64) uint8_t redHigh[64];        ///< The same from vector 2
+    uint64_t redHighMask;                   ///< Bytes that come from vector 2
+    alignas(64) uint8_t expand[3][64];      ///< [output vector]: luma of the pixel byte i belongs to
+};
+
+PermuteIndices makePermuteIndices() {
+    PermuteIndices indices = {};
+    for (int i = 0; i < 64; ++i) {
+        for (int half = 0; half < 2; ++half) {
+            int source = 3 * (32 * half + i / 2) + (i & 1);
+            indices.blueGreen[half][i] = static_cast<uint8_t>(source - 64 * half);
+        }
+        int source = 3 * ((i & 1) ? 32 + i / 2 : i / 2) + 2;
+        indices.red[i] = static_cast<uint8_t>(source & 127);
+        indices.redHigh[i] = static_cast<uint8_t>(source & 63);
+        if (source >= 128) {
+            indices.redHighMask |= uint64_t(1) << i;
+        }
+    }
+    // Luma comes out of vpackuswb with each 128-bit lane holding 8 pixels
+    // from the first and 8 from the second half
+    for (int vector = 0; vector < 3; ++vector) {
+        for (int i = 0; i < 64; ++i) {
+            int pixel = (64 * vector + i) / 3;
+            int half = pixel / 32;
+            int index = pixel % 32;
+            indices.expand[vector][i] = static_cast<uint8_t>(16 * (index / 8) + 8 * half + index % 8);
+        }
+    }
+    return indices;
+}
+
+const PermuteIndices& permuteIndices() {
+    static const PermuteIndices indices = makePermuteIndices();
+    return indices;
+}
+
+// 256-entry table lookup with 16-entry pshufb tables. Pass a handles
+// bytes below 128 and pass b the rest; the other half's bytes are forced
+// to 0xFF, which pshufb turns into 0. Within a pass, index x - 16k hits
+// table k for every k up to x / 16, so the tables hold differences of
+// consecutive table rows and the XOR of the hits is the looked-up value.
+SIMD_TARGET("sse4.1")
+inline __m128i lookupSse41(__m128i x, const __m128i* tables) {
+    const __m128i step = _mm_set1_epi8(16);
+    __m128i upper = _mm_cmplt_epi8(x, _mm_setzero_si128());
+    __m128i a = _mm_or_si128(x, upper);
+    __m128i b = _mm_or_si128(_mm_xor_si128(x, _mm_set1_epi8(static_cast<char>(0x80))),
+                             _mm_xor_si128(upper, _mm_set1_epi8(-1)));
+    __m128i result = _mm_shuffle_epi8(tables[0], a);
+    result = _mm_xor_si128(result, _mm_shuffle_epi8(tables[8], b));
+    for (int k = 1; k < 8; ++k) {
+        a = _mm_sub_epi8(a, step);
+        b = _mm_sub_epi8(b, step);
+        result = _mm_xor_si128(result, _mm_shuffle_epi8(tables[k], a));
+        result = _mm_xor_si128(result, _mm_shuffle_epi8(tables[8 + k], b));
+    }
+    return result;
+}
+
+SIMD_TARGET("sse4.1")
+inline void loadTablesSse41(const uint8_t* nibbles, __m128i* tables) {
+    for (int k = 0; k < 16; ++k) {
+        tables[k] = _mm_load_si128(reinterpret_cast<const __m128i*>(nibbles + 16 * k));
+    }
+}
+
+// Tone line of 16 bytes; pmulhuw of value << 8 gives (value * gain) >> 8
+SIMD_TARGET("sse4.1")
+inline __m128i linearToneSse41(__m128i x, __m128i toneGain, __m128i toneOffset) {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i low = _mm_mulhi_epu16(_mm_unpacklo_epi8(zero, x), toneGain);
+    __m128i high = _mm_mulhi_epu16(_mm_unpackhi_epi8(zero, x), toneGain);
+    return _mm_packus_epi16(_mm_srai_epi16(_mm_adds_epi16(low, toneOffset), TONE_SHIFT),
+                            _mm_srai_epi16(_mm_adds_epi16(high, toneOffset), TONE_SHIFT));
+}
+
+SIMD_TARGET("sse4.1")
+inline __m128i shuffleSse41(__m128i vector, const uint8_t* mask) {
+    return _mm_shuffle_epi8(vector, _mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+}
+
+// Luma of the 16 pixels in v0..v2, one byte per pixel. pmulhrsw by 1 << 8
+// rounds and shifts by LUMA_SHIFT
+SIMD_TARGET("sse4.1")
+inline __m128i lumaSse41(__m128i v0, __m128i v1, __m128i v2, const ShuffleMasks& masks) {
+    const __m128i blueGreenWeights = _mm_set1_epi16((GREEN_WEIGHT << 8) | BLUE_WEIGHT);
+    const __m128i redWeightLow = _mm_set1_epi16(RED_WEIGHT);
+    const __m128i redWeightHigh = _mm_set1_epi16(RED_WEIGHT << 8);
+    const __m128i rounding = _mm_set1_epi16(1 << (15 - LUMA_SHIFT));
+    __m128i blueGreenLow = _mm_or_si128(shuffleSse41(v0, masks.blueGreen[0][0]),
+                                        shuffleSse41(v1, masks.blueGreen[0][1]));
+    __m128i blueGreenHigh = _mm_or_si128(shuffleSse41(v1, masks.blueGreen[1][1]),
+                                         shuffleSse41(v2, masks.blueGreen[1][2]));
+    __m128i red = _mm_or_si128(_mm_or_si128(shuffleSse41(v0, masks.red[0]), shuffleSse41(v1, masks.red[1])),
+                               shuffleSse41(v2, masks.red[2]));
+    __m128i low = _mm_add_epi16(_mm_maddubs_epi16(blueGreenLow, blueGreenWeights),
+                                _mm_maddubs_epi16(red, redWeightLow));
+    __m128i high = _mm_add_epi16(_mm_maddubs_epi16(blueGreenHigh, blueGreenWeights),
+                                 _mm_maddubs_epi16(red, redWeightHigh));
+    return _mm_packus_epi16(_mm_mulhrs_epi16(low, rounding), _mm_mulhrs_epi16(high, rounding));
+}
+
+// Saturation blend of 16 bytes with the luma of their pixels; pmulhrsw by
+// 1 << (15 - shift) rounds and shifts by shift
+SIMD_TARGET("sse4.1")
+inline __m128i saturateSse41(__m128i value, __m128i luma, __m128i weights, __m128i rounding) {
+    __m128i low = _mm_mulhrs_epi16(_mm_maddubs_epi16(_mm_unpacklo_epi8(value, luma), weights), rounding);
+    __m128i high = _mm_mulhrs_epi16(_mm_maddubs_epi16(_mm_unpackhi_epi8(value, luma), weights), rounding);
+    return _mm_packus_epi16(low, high);
+}
+
+SIMD_TARGET("sse4.1")
+void toneSse41(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, const uint8_t* nibbles) {
+    __m128i tables[16];
+    loadTablesSse41(nibbles, tables);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), lookupSse41(x, tables));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nibbles);
+}
+
+SIMD_TARGET("sse4.1")
+void linearToneSse41(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, uint16_t toneGain,
+                     int16_t toneOffset) {
+    const __m128i gains = _mm_set1_epi16(static_cast<short>(toneGain));
+    const __m128i offsets = _mm_set1_epi16(toneOffset);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), linearToneSse41(x, gains, offsets));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nullptr);
+}
+
+// 16 pixels per iteration. The pixels stay interleaved: only the luma
+// operands are gathered, and luma is spread back over each pixel's bytes
+template <bool Linear>
+SIMD_TARGET("sse4.1")
+void enhanceSse41(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                  uint16_t toneGain, int16_t toneOffset, SaturationWeights weights) {
+    const ShuffleMasks& masks = shuffleMasks();
+    const __m128i blend = _mm_set1_epi16(static_cast<short>((static_cast<uint8_t>(weights.luma) << 8) |
+                                                            static_cast<uint8_t>(weights.channel)));
+    const __m128i rounding = _mm_set1_epi16(static_cast<short>(1 << (15 - weights.shift)));
+    const __m128i toneGains = _mm_set1_epi16(static_cast<short>(toneGain));
+    const __m128i toneOffsets = _mm_set1_epi16(toneOffset);
+    __m128i tables[16];
+    if (!Linear) {
+        loadTablesSse41(nibbles, tables);
+    }
+
+    int i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        __m128i vectors[3];
+        for (int vector = 0; vector < 3; ++vector) {
+            vectors[vector] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + 3 * i + 16 * vector));
+            vectors[vector] = Linear ? linearToneSse41(vectors[vector], toneGains, toneOffsets)
+                                     : lookupSse41(vectors[vector], tables);
+        }
+
+        __m128i luma = lumaSse41(vectors[0], vectors[1], vectors[2], masks);
+        for (int vector = 0; vector < 3; ++vector) {
+            __m128i spread = shuffleSse41(luma, masks.expand[vector]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 3 * i + 16 * vector),
+                             saturateSse41(vectors[vector], spread, blend, rounding));
+        }
+    }
+    enhanceScalar(in + 3 * i, out + 3 * i, pixels - i, tone, nibbles, weights);
+}
+
+void enhanceSse41(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                  SaturationWeights weights) {
+    enhanceSse41<false>(in, out, pixels, tone, nibbles, 0, 0, weights);
+}
+
+void linearEnhanceSse41(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, uint16_t toneGain,
+                        int16_t toneOffset, SaturationWeights weights) {
+    enhanceSse41<true>(in, out, pixels, tone, nullptr, toneGain, toneOffset, weights);
+}
+
+// The AVX2 kernels work like the SSE4.1 ones on two 128-bit lanes
+SIMD_TARGET("avx2")
+inline __m256i lookupAvx2(__m256i x, const __m256i* tables) {
+    const __m256i step = _mm256_set1_epi8(16);
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_setzero_si256(), x);
+    __m256i a = _mm256_or_si256(x, upper);
+    __m256i b = _mm256_or_si256(_mm256_xor_si256(x, _mm256_set1_epi8(static_cast<char>(0x80))),
+                                _mm256_xor_si256(upper, _mm256_set1_epi8(-1)));
+    __m256i result = _mm256_shuffle_epi8(tables[0], a);
+    result = _mm256_xor_si256(result, _mm256_shuffle_epi8(tables[8], b));
+    for (int k = 1; k < 8; ++k) {
+        a = _mm256_sub_epi8(a, step);
+        b = _mm256_sub_epi8(b, step);
+        result = _mm256_xor_si256(result, _mm256_shuffle_epi8(tables[k], a));
+        result = _mm256_xor_si256(result, _mm256_shuffle_epi8(tables[8 + k], b));
+    }
+    return result;
+}
+
+SIMD_TARGET("avx2")
+inline void loadTablesAvx2(const uint8_t* nibbles, __m256i* tables) {
+    for (int k = 0; k < 16; ++k) {
+        tables[k] = _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(nibbles + 16 * k)));
+    }
+}
+
+SIMD_TARGET("avx2")
+inline __m256i linearToneAvx2(__m256i x, __m256i toneGain, __m256i toneOffset) {
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i low = _mm256_mulhi_epu16(_mm256_unpacklo_epi8(zero, x), toneGain);
+    __m256i high = _mm256_mulhi_epu16(_mm256_unpackhi_epi8(zero, x), toneGain);
+    return _mm256_packus_epi16(_mm256_srai_epi16(_mm256_adds_epi16(low, toneOffset), TONE_SHIFT),
+                               _mm256_srai_epi16(_mm256_adds_epi16(high, toneOffset), TONE_SHIFT));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i broadcastMaskAvx2(const uint8_t* mask) {
+    return _mm256_broadcastsi128_si256(_mm_load_si128(reinterpret_cast<const __m128i*>(mask)));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i shuffleAvx2(__m256i vector, const uint8_t* mask) {
+    return _mm256_shuffle_epi8(vector, broadcastMaskAvx2(mask));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i lumaAvx2(__m256i v0, __m256i v1, __m256i v2, const ShuffleMasks& masks) {
+    const __m256i blueGreenWeights = _mm256_set1_epi16((GREEN_WEIGHT << 8) | BLUE_WEIGHT);
+    const __m256i redWeightLow = _mm256_set1_epi16(RED_WEIGHT);
+    const __m256i redWeightHigh = _mm256_set1_epi16(RED_WEIGHT << 8);
+    const __m256i rounding = _mm256_set1_epi16(1 << (15 - LUMA_SHIFT));
+    __m256i blueGreenLow = _mm256_or_si256(shuffleAvx2(v0, masks.blueGreen[0][0]),
+                                           shuffleAvx2(v1, masks.blueGreen[0][1]));
+    __m256i blueGreenHigh = _mm256_or_si256(shuffleAvx2(v1, masks.blueGreen[1][1]),
+                                            shuffleAvx2(v2, masks.blueGreen[1][2]));
+    __m256i red = _mm256_or_si256(_mm256_or_si256(shuffleAvx2(v0, masks.red[0]), shuffleAvx2(v1, masks.red[1])),
+                                  shuffleAvx2(v2, masks.red[2]));
+    __m256i low = _mm256_add_epi16(_mm256_maddubs_epi16(blueGreenLow, blueGreenWeights),
+                                   _mm256_maddubs_epi16(red, redWeightLow));
+    __m256i high = _mm256_add_epi16(_mm256_maddubs_epi16(blueGreenHigh, blueGreenWeights),
+                                    _mm256_maddubs_epi16(red, redWeightHigh));
+    return _mm256_packus_epi16(_mm256_mulhrs_epi16(low, rounding), _mm256_mulhrs_epi16(high, rounding));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i saturateAvx2(__m256i value, __m256i luma, __m256i weights, __m256i rounding) {
+    __m256i low = _mm256_mulhrs_epi16(_mm256_maddubs_epi16(_mm256_unpacklo_epi8(value, luma), weights), rounding);
+    __m256i high = _mm256_mulhrs_epi16(_mm256_maddubs_epi16(_mm256_unpackhi_epi8(value, luma), weights), rounding);
+    return _mm256_packus_epi16(low, high);
+}
+
+// Lane 0 holds 16 bytes at source, lane 1 the 16 bytes 48 further on
+SIMD_TARGET("avx2")
+inline __m256i loadLanesAvx2(const uint8_t* source) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 48)), 1);
+}
+
+SIMD_TARGET("avx2")
+inline void storeLanesAvx2(uint8_t* target, __m256i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm256_castsi256_si128(value));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(target + 48), _mm256_extracti128_si256(value, 1));
+}
+
+SIMD_TARGET("avx2")
+void toneAvx2(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, const uint8_t* nibbles) {
+    __m256i tables[16];
+    loadTablesAvx2(nibbles, tables);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), lookupAvx2(x, tables));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nibbles);
+}
+
+SIMD_TARGET("avx2")
+void linearToneAvx2(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, uint16_t toneGain,
+                    int16_t toneOffset) {
+    const __m256i gains = _mm256_set1_epi16(static_cast<short>(toneGain));
+    const __m256i offsets = _mm256_set1_epi16(toneOffset);
+    int i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), linearToneAvx2(x, gains, offsets));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nullptr);
+}
+
+// 32 pixels per iteration; each 128-bit lane holds 16 consecutive pixels,
+// so the in-lane pshufb masks of the SSE4.1 kernel apply
+template <bool Linear>
+SIMD_TARGET("avx2")
+void enhanceAvx2(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                 uint16_t toneGain, int16_t toneOffset, SaturationWeights weights) {
+    const ShuffleMasks& masks = shuffleMasks();
+    const __m256i blend = _mm256_set1_epi16(static_cast<short>((static_cast<uint8_t>(weights.luma) << 8) |
+                                                               static_cast<uint8_t>(weights.channel)));
+    const __m256i rounding = _mm256_set1_epi16(static_cast<short>(1 << (15 - weights.shift)));
+    const __m256i toneGains = _mm256_set1_epi16(static_cast<short>(toneGain));
+    const __m256i toneOffsets = _mm256_set1_epi16(toneOffset);
+    const __m256i expand[3] = {broadcastMaskAvx2(masks.expand[0]), broadcastMaskAvx2(masks.expand[1]),
+                               broadcastMaskAvx2(masks.expand[2])};
+    __m256i tables[16];
+    if (!Linear) {
+        loadTablesAvx2(nibbles, tables);
+    }
+
+    int i = 0;
+    for (; i + 32 <= pixels; i += 32) {
+        const uint8_t* source = in + 3 * i;
+        __m256i vectors[3];
+        for (int vector = 0; vector < 3; ++vector) {
+            vectors[vector] = loadLanesAvx2(source + 16 * vector);
+            vectors[vector] = Linear ? linearToneAvx2(vectors[vector], toneGains, toneOffsets)
+                                     : lookupAvx2(vectors[vector], tables);
+        }
+
+        __m256i luma = lumaAvx2(vectors[0], vectors[1], vectors[2], masks);
+        uint8_t* target = out + 3 * i;
+        for (int vector = 0; vector < 3; ++vector) {
+            __m256i spread = _mm256_shuffle_epi8(luma, expand[vector]);
+            storeLanesAvx2(target + 16 * vector, saturateAvx2(vectors[vector], spread, blend, rounding));
+        }
+    }
+    enhanceScalar(in + 3 * i, out + 3 * i, pixels - i, tone, nibbles, weights);
+}
+
+void enhanceAvx2(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                 SaturationWeights weights) {
+    enhanceAvx2<false>(in, out, pixels, tone, nibbles, 0, 0, weights);
+}
+
+void linearEnhanceAvx2(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, uint16_t toneGain,
+                       int16_t toneOffset, SaturationWeights weights) {
+    enhanceAvx2<true>(in, out, pixels, tone, nullptr, toneGain, toneOffset, weights);
+}
+
+// 256-entry table lookup with two 128-entry vpermi2b lookups; the top bit
+// of each byte picks the half
+SIMD_TARGET("avx512bw,avx512vbmi")
+inline __m512i lookupVbmi(__m512i x, const __m512i* quarters) {
+    __m512i low = _mm512_permutex2var_epi8(quarters[0], x, quarters[1]);
+    __m512i high = _mm512_permutex2var_epi8(quarters[2], x, quarters[3]);
+    return _mm512_mask_blend_epi8(_mm512_movepi8_mask(x), low, high);
+}
+
+SIMD_TARGET("avx512bw,avx512vbmi")
+inline void loadTablesVbmi(const uint8_t* tone, __m512i* quarters) {
+    for (int k = 0; k < 4; ++k) {
+        quarters[k] = _mm512_load_si512(tone + 64 * k);
+    }
+}
+
+SIMD_TARGET("avx512bw,avx512vbmi")
+inline __m512i lumaVbmi(__m512i v0, __m512i v1, __m512i v2, const PermuteIndices& indices) {
+    const __m512i blueGreenWeights = _mm512_set1_epi16((GREEN_WEIGHT << 8) | BLUE_WEIGHT);
+    const __m512i redWeightLow = _mm512_set1_epi16(RED_WEIGHT);
+    const __m512i redWeightHigh = _mm512_set1_epi16(RED_WEIGHT << 8);
+    const __m512i rounding = _mm512_set1_epi16(1 << (15 - LUMA_SHIFT));
+    __m512i blueGreenLow = _mm512_permutex2var_epi8(v0, _mm512_load_si512(indices.blueGreen[0]), v1);
+    __m512i blueGreenHigh = _mm512_permutex2var_epi8(v1, _mm512_load_si512(indices.blueGreen[1]), v2);
+    __m512i red = _mm512_permutex2var_epi8(v0, _mm512_load_si512(indices.red), v1);
+    red = _mm512_mask_permutexvar_epi8(red, indices.redHighMask, _mm512_load_si512(indices.redHigh), v2);
+    __m512i low = _mm512_add_epi16(_mm512_maddubs_epi16(blueGreenLow, blueGreenWeights),
+                                   _mm512_maddubs_epi16(red, redWeightLow));
+    __m512i high = _mm512_add_epi16(_mm512_maddubs_epi16(blueGreenHigh, blueGreenWeights),
+                                    _mm512_maddubs_epi16(red, redWeightHigh));
+    return _mm512_packus_epi16(_mm512_mulhrs_epi16(low, rounding), _mm512_mulhrs_epi16(high, rounding));
+}
+
+SIMD_TARGET("avx512bw,avx512vbmi")
+inline __m512i saturateVbmi(__m512i value, __m512i luma, __m512i weights, __m512i rounding) {
+    __m512i low = _mm512_mulhrs_epi16(_mm512_maddubs_epi16(_mm512_unpacklo_epi8(value, luma), weights), rounding);
+    __m512i high = _mm512_mulhrs_epi16(_mm512_maddubs_epi16(_mm512_unpackhi_epi8(value, luma), weights), rounding);
+    return _mm512_packus_epi16(low, high);
+}
+
+SIMD_TARGET("avx512bw,avx512vbmi")
+void toneVbmi(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, const uint8_t* nibbles) {
+    __m512i quarters[4];
+    loadTablesVbmi(tone, quarters);
+    int i = 0;
+    for (; i + 64 <= count; i += 64) {
+        __m512i x = _mm512_loadu_si512(in + i);
+        _mm512_storeu_si512(out + i, lookupVbmi(x, quarters));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nibbles);
+}
+
+// 64 pixels per iteration, with the luma operands gathered by vpermt2b
+// and luma spread back with vpermb
+SIMD_TARGET("avx512bw,avx512vbmi")
+void enhanceVbmi(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                 SaturationWeights weights) {
+    const PermuteIndices& indices = permuteIndices();
+    const __m512i blend = _mm512_set1_epi16(static_cast<short>((static_cast<uint8_t>(weights.luma) << 8) |
+                                                               static_cast<uint8_t>(weights.channel)));
+    const __m512i rounding = _mm512_set1_epi16(static_cast<short>(1 << (15 - weights.shift)));
+    __m512i quarters[4];
+    loadTablesVbmi(tone, quarters);
+
+    int i = 0;
+    for (; i + 64 <= pixels; i += 64) {
+        const uint8_t* source = in + 3 * i;
+        __m512i vectors[3];
+        for (int vector = 0; vector < 3; ++vector) {
+            vectors[vector] = lookupVbmi(_mm512_loadu_si512(source + 64 * vector), quarters);
+        }
+
+        __m512i luma = lumaVbmi(vectors[0], vectors[1], vectors[2], indices);
+        uint8_t* target = out + 3 * i;
+        for (int vector = 0; vector < 3; ++vector) {
+            __m512i spread = _mm512_permutexvar_epi8(_mm512_load_si512(indices.expand[vector]), luma);
+            _mm512_storeu_si512(target + 64 * vector, saturateVbmi(vectors[vector], spread, blend, rounding));
+        }
+    }
+    enhanceScalar(in + 3 * i, out + 3 * i, pixels - i, tone, nibbles, weights);
+}
+
+// The vpermi2b lookups cost about as much as the line
+void linearEnhanceVbmi(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, uint16_t, int16_t,
+                       SaturationWeights weights) {
+    enhanceVbmi(in, out, pixels, tone, nullptr, weights);
+}
+
+#endif  // SIMD_X86
+
+#if defined(SIMD_NEON) && defined(__aarch64__)
+
+// 256-entry table lookup with four 64-entry tbl/tbx lookups; tbx leaves
+// bytes whose index is out of range untouched
+inline uint8x16_t lookupNeon(uint8x16_t x, const uint8x16x4_t* quarters) {
+    uint8x16_t result = vqtbl4q_u8(quarters[0], x);
+    result = vqtbx4q_u8(result, quarters[1], vsubq_u8(x, vdupq_n_u8(64)));
+    result = vqtbx4q_u8(result, quarters[2], vsubq_u8(x, vdupq_n_u8(128)));
+    return vqtbx4q_u8(result, quarters[3], vsubq_u8(x, vdupq_n_u8(192)));
+}
+
+inline void loadTablesNeon(const uint8_t* tone, uint8x16x4_t* quarters) {
+    for (int k = 0; k < 4; ++k) {
+        quarters[k] = vld1q_u8_x4(tone + 64 * k);
+    }
+}
+
+// Rounding narrow by 7 adds the same rounding term as the scalar code
+inline uint8x8_t lumaNeon(uint8x8_t blue, uint8x8_t green, uint8x8_t red) {
+    uint16x8_t sum = vmull_u8(blue, vdup_n_u8(BLUE_WEIGHT));
+    sum = vmlal_u8(sum, green, vdup_n_u8(GREEN_WEIGHT));
+    sum = vmlal_u8(sum, red, vdup_n_u8(RED_WEIGHT));
+    return vrshrn_n_u16(sum, LUMA_SHIFT);
+}
+
+// The blend fits 16 bits; vrshl by -shift is the scalar code's rounded shift
+inline uint8x8_t saturateNeon(uint8x8_t value, uint8x8_t luma, SaturationWeights weights, int16x8_t shift) {
+    int16x8_t sum = vmulq_n_s16(vreinterpretq_s16_u16(vmovl_u8(value)), weights.channel);
+    sum = vmlaq_n_s16(sum, vreinterpretq_s16_u16(vmovl_u8(luma)), weights.luma);
+    return vqmovun_s16(vrshlq_s16(sum, shift));
+}
+
+void toneNeon(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, const uint8_t* nibbles) {
+    uint8x16x4_t quarters[4];
+    loadTablesNeon(tone, quarters);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        vst1q_u8(out + i, lookupNeon(vld1q_u8(in + i), quarters));
+    }
+    toneScalar(in + i, out + i, count - i, tone, nibbles);
+}
+
+void enhanceNeon(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, const uint8_t* nibbles,
+                 SaturationWeights weights) {
+    const int16x8_t shift = vdupq_n_s16(static_cast<int16_t>(-weights.shift));
+    uint8x16x4_t quarters[4];
+    loadTablesNeon(tone, quarters);
+
+    int i = 0;
+    for (; i + 16 <= pixels; i += 16) {
+        uint8x16x3_t bgr = vld3q_u8(in + 3 * i);
+        for (int channel = 0; channel < 3; ++channel) {
+            bgr.val[channel] = lookupNeon(bgr.val[channel], quarters);
+        }
+
+        uint8x8_t lumaLow = lumaNeon(vget_low_u8(bgr.val[0]), vget_low_u8(bgr.val[1]), vget_low_u8(bgr.val[2]));
+        uint8x8_t lumaHigh = lumaNeon(vget_high_u8(bgr.val[0]), vget_high_u8(bgr.val[1]), vget_high_u8(bgr.val[2]));
+        for (int channel = 0; channel < 3; ++channel) {
+            bgr.val[channel] = vcombine_u8(saturateNeon(vget_low_u8(bgr.val[channel]), lumaLow, weights, shift),
+                                           saturateNeon(vget_high_u8(bgr.val[channel]), lumaHigh, weights, shift));
+        }
+        vst3q_u8(out + 3 * i, bgr);
+    }
+    enhanceScalar(in + 3 * i, out + 3 * i, pixels - i, tone, nibbles, weights);
+}
+
+// tbl lookups cost about as much as the line
+void linearToneNeon(const uint8_t* in, uint8_t* out, int count, const uint8_t* tone, uint16_t, int16_t) {
+    toneNeon(in, out, count, tone, nullptr);
+}
+
+void linearEnhanceNeon(const uint8_t* in, uint8_t* out, int pixels, const uint8_t* tone, uint16_t, int16_t,
+                       SaturationWeights weights) {
+    enhanceNeon(in, out, pixels, tone, nullptr, weights);
+}
+
+#endif  // SIMD_NEON && __aarch64__
+
+struct RowKernels {
+    ToneKernel tone;
+    EnhanceKernel enhance;
+    LinearToneKernel linearTone;
+    LinearEnhanceKernel linearEnhance;
+};
+
+RowKernels kernelsFor(ColorEnhanceFilter::Isa isa) {
+    switch (isa) {
+#ifdef SIMD_X86
+        case ColorEnhanceFilter::Isa::Avx512Vbmi:
+            // For the tone alone the AVX2 line still beats the vpermi2b lookups
+            return {toneVbmi, enhanceVbmi, linearToneAvx2, linearEnhanceVbmi};
+        case ColorEnhanceFilter::Isa::Avx2:
+            return {toneAvx2, enhanceAvx2, linearToneAvx2, linearEnhanceAvx2};
+        case ColorEnhanceFilter::Isa::Sse41:
+            return {toneSse41, enhanceSse41, linearToneSse41, linearEnhanceSse41};
+#endif
+#if defined(SIMD_NEON) && defined(__aarch64__)
+        case ColorEnhanceFilter::Isa::Neon:
+            return {toneNeon, enhanceNeon, linearToneNeon, linearEnhanceNeon};
+#endif
+        default:
+            return {toneScalar, enhanceScalar, linearToneScalar, linearEnhanceScalar};
+    }
+}
+
+}  // namespace
+
+ColorEnhanceFilter::ColorEnhanceFilter()
+    : brightness(0.0), contrast(1.15), gamma(1.0), saturation(1.25) {
+    rebuildTables();
+}
+
+ColorEnhanceFilter::ColorEnhanceFilter(double brightness, double contrast, double gamma, double saturation)
+    : ColorEnhanceFilter() {
+    configure({{"brightness", brightness}, {"contrast", contrast},
+               {"gamma", gamma}, {"saturation", saturation}});
+}
+
+bool ColorEnhanceFilter::apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) {
+    return apply(inputFrame, outputFrame, bestIsa());
+}
+
+bool ColorEnhanceFilter::apply(const cv::Mat& inputFrame, cv::Mat& outputFrame, Isa isa) {
+    if (!isAvailable(isa)) {
+        return false;
+    }
+    if (!isEnabled() || inputFrame.empty()) {
+        inputFrame.copyTo(outputFrame);
+        return false;
+    }
+
+    int channels = inputFrame.channels();
+    if (inputFrame.depth() != CV_8U || (channels != 1 && channels != 3 && channels != 4)) {
+        std::cerr << "Error in ColorEnhanceFilter: Unsupported frame type." << std::endl;
+        inputFrame.copyTo(outputFrame);
+        return false;
+    }
+
+    // Pixels are read before they are written, so the output may alias the input
+    std::shared_ptr<const Tables> current = std::atomic_load(&tables);
+    cv::Mat source = inputFrame;
+    outputFrame.create(source.size(), source.type());
+    if (source.isContinuous() && outputFrame.isContinuous()) {
+        applyToRow(*current, source.data, outputFrame.data, static_cast<int>(source.total()), channels, isa);
+    } else {
+        for (int y = 0; y < source.rows; ++y) {
+            applyToRow(*current, source.ptr(y), outputFrame.ptr(y), source.cols, channels, isa);
+        }
+    }
+    return true;
+}
+
+void ColorEnhanceFilter::applyToRow(const uchar* input, uchar* output, int pixels, int channels) {
+    applyToRow(*std::atomic_load(&tables), input, output, pixels, channels, bestIsa());
+}
+
+void ColorEnhanceFilter::applyToRow(const Tables& current, const uchar* input, uchar* output, int pixels,
+                                    int channels, Isa isa) {
+    const RowKernels kernels = kernelsFor(isa);
+
+    const uint8_t* tone = current.tone;
+    const SaturationWeights weights = {current.channelWeight, current.lumaWeight, current.saturationShift};
+    if (channels == 3) {
+        if (current.lumaWeight == 0) {
+            if (current.linear) {
+                kernels.linearTone(input, output, 3 * pixels, tone, current.toneGain, current.toneOffset);
+            } else {
+                kernels.tone(input, output, 3 * pixels, tone, current.nibbles);
+            }
+        } else if (current.linear) {
+            kernels.linearEnhance(input, output, pixels, tone, current.toneGain, current.toneOffset, weights);
+        } else {
+            kernels.enhance(input, output, pixels, tone, current.nibbles, weights);
+        }
+    } else if (channels == 4) {
+        enhancePixels(input, output, pixels, channels, tone, weights);
+    } else if (current.linear) {
+        kernels.linearTone(input, output, pixels * channels, tone, current.toneGain, current.toneOffset);
+    } else {
+        kernels.tone(input, output, pixels * channels, tone, current.nibbles);
+    }
+}
+
+std::string ColorEnhanceFilter::getName() const {
+    return "Color Enhance";
+}
+
+ColorEnhanceFilter::Isa ColorEnhanceFilter::bestIsa() {
+    static const Isa best = [] {
+        for (Isa isa : {Isa::Avx512Vbmi, Isa::Avx2, Isa::Sse41, Isa::Neon}) {
+            if (isAvailable(isa)) {
+                return isa;
+            }
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+
+bool ColorEnhanceFilter::isAvailable(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#ifdef SIMD_X86
+        case Isa::Sse41:
+            return cv::checkHardwareSupport(CV_CPU_SSE4_1);
+        case Isa::Avx2:
+            return cv::checkHardwareSupport(CV_CPU_AVX2);
+        case Isa::Avx512Vbmi:
+            return cv::checkHardwareSupport(CV_CPU_AVX_512BW) && cv::checkHardwareSupport(CV_CPU_AVX_512VBMI);
+#endif
+#if defined(SIMD_NEON) && defined(__aarch64__)
+        case Isa::Neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* ColorEnhanceFilter::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Sse41:
+            return "SSE4.1";
+        case Isa::Avx2:
+            return "AVX2";
+        case Isa::Avx512Vbmi:
+            return "AVX-512 VBMI";
+        case Isa::Neon:
+            return "NEON";
+        default:
+            return "scalar";
+    }
+}
+
+bool ColorEnhanceFilter::configure(const std::map<std::string, double>& params) {
+    bool changed = false;
+
+    if (params.count("brightness")) {
+        double newBrightness = params.at("brightness");
+        if (newBrightness >= -255 && newBrightness <= 255) {
+            brightness = newBrightness;
+            changed = true;
+        }
+    }
+
+    if (params.count("contrast")) {
+        double newContrast = params.at("contrast");
+        if (newContrast >= 0 && newContrast <= 8) {
+            contrast = newContrast;
+            changed = true;
+        }
+    }
+
+    if (params.count("gamma")) {
+        double newGamma = params.at("gamma");
+        if (newGamma > 0 && newGamma <= 8) {
+            gamma = newGamma;
+            changed = true;
+        }
+    }
+
+    if (params.count("saturation")) {
+        double newSaturation = params.at("saturation");
+        if (newSaturation >= 0 && newSaturation <= 8) {
+            saturation = newSaturation;
+            changed = true;
+        }
+    }
+
+    if (changed) {
+        rebuildTables();
+        markParametersChanged();
+    }
+
+    return changed;
+}
+
+bool ColorEnhanceFilter::acceptsGrayInput() const {
+    return true;
+}
+
+Filter::AccessPattern ColorEnhanceFilter::getAccessPattern() const {
+    return AccessPattern::Point;
+}
+
+void ColorEnhanceFilter::rebuildTables() {
+    // Built aside and swapped in, so frames in progress keep their tables
+    auto built = std::make_shared<Tables>();
+    uint8_t* toneTable = built->tone;
+    uint8_t* nibbleTables = built->nibbles;
+
+    // Without gamma the curve is the line contrast * value + offset, in
+    // the fixed-point steps the SIMD code takes
+    built->linear = gamma == 1.0;
+    built->toneGain = static_cast<uint16_t>(std::lround(contrast * (1 << TONE_GAIN_SHIFT)));
+    built->toneOffset = static_cast<int16_t>(
+        std::lround(((1.0 - contrast) * 127.5 + brightness) * (1 << TONE_SHIFT)) + (1 << (TONE_SHIFT - 1)));
+    for (int value = 0; value < 256; ++value) {
+        if (built->linear) {
+            toneTable[value] = static_cast<uint8_t>(linearTone(value, built->toneGain, built->toneOffset));
+            continue;
+        }
+        double level = std::pow(value / 255.0, 1.0 / gamma);
+        level = (level - 0.5) * contrast + 0.5;
+        toneTable[value] = cv::saturate_cast<uint8_t>(level * 255.0 + brightness);
+    }
+
+    // Table k covers rows k % 8 of the lower (k < 8) or upper half of the
+    // tone table, stored as the difference to the row before it for the
+    // XOR accumulation in lookupAvx2
+    for (int k = 0; k < 16; ++k) {
+        int row = (k / 8) * 128 + (k % 8) * 16;
+        for (int i = 0; i < 16; ++i) {
+            uint8_t previous = (k % 8) > 0 ? toneTable[row - 16 + i] : 0;
+            nibbleTables[16 * k + i] = static_cast<uint8_t>(toneTable[row + i] ^ previous);
+        }
+    }
+
+    // The finest step whose channel weight still fits a signed byte
+    int shift = SATURATION_SHIFT;
+    while (shift > MIN_SATURATION_SHIFT && std::lround(saturation * (1 << shift)) > 127) {
+        --shift;
+    }
+    long channelWeight = std::lround(saturation * (1 << shift));
+    built->saturationShift = static_cast<uint8_t>(shift);
+    built->channelWeight = static_cast<int8_t>(channelWeight);
+    built->lumaWeight = static_cast<int8_t>((1 << shift) - channelWeight);
+    std::atomic_store(&tables, std::shared_ptr<const Tables>(std::move(built)));
+}
\ No newline at end of file
@@ -1,8 +1,168 @@
-//
-// Created by Damian on 3/6/2025.
-//
+#pragma once
 
-#ifndef COLORENHANCEFILTER_H
-#define COLORENHANCEFILTER_H
+#include "Filter.h"
+#include <cstdint>
+#include <memory>
 
-#endif //COLORENHANCEFILTER_H
+/**
+ * @brief Adjusts brightness, contrast, gamma and saturation of video frames
+ *
+ * Brightness, contrast and gamma act on every channel alike and are folded
+ * into one 256-entry tone table; saturation is a fixed-point blend of each
+ * channel with the pixel's luma, whose Q7 weights are within 1/256 of the
+ * ones cv::cvtColor uses. Only configure() rebuilds the tables, so a frame
+ * costs one table lookup per byte and a few integer operations per pixel,
+ * with AVX-512 VBMI, AVX2, SSE4.1 and NEON paths chosen at runtime. The x86
+ * paths keep the pixels interleaved and only gather the luma operands.
+ * Without gamma correction the tone curve is a clamped line, which they
+ * evaluate in 16-bit arithmetic instead of looking it up.
+ *
+ * configure() builds new tables aside and publishes them atomically, so
+ * frames being filtered meanwhile see either the old or the new tables,
+ * never a mix; apply() uses one set for the whole frame.
+ *
+ * The filter is a point filter and takes 8-bit frames with 1, 3 or 4
+ * channels; saturation applies to BGR and BGRA frames and alpha is only
+ * copied.
+ */
+class ColorEnhanceFilter : public Filter {
+public:
+    /**
+     * @brief Instruction set used by the row kernels
+     */
+    enum class Isa {
+        Scalar,
+        Sse41,
+        Avx2,
+        Avx512Vbmi,
+        Neon
+    };
+
+    /**
+     * @brief Construct with default parameters (mild contrast and saturation boost)
+     */
+    ColorEnhanceFilter();
+
+    /**
+     * @brief Construct with specific enhancement parameters
+     *
+     * @param brightness Offset added to every channel, in [-255, 255]
+     * @param contrast Gain around mid-gray, in [0, 8]
+     * @param gamma Gamma correction, in (0, 8]; values above 1 brighten midtones
+     * @param saturation Saturation gain, in [0, 8]; 0 is grayscale, 1 unchanged
+     */
+    ColorEnhanceFilter(double brightness, double contrast, double gamma, double saturation);
+
+    /**
+     * @brief Apply the enhancement to a frame
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame after processing
+     * @return true if processing was successful, false otherwise
+     */
+    bool apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) override;
+
+    /**
+     * @brief Apply the enhancement with a specific instruction set
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame after processing
+     * @param isa Instruction set; must be available on this CPU
+     * @return false if the frame is not supported or the instruction set
+     *         is not available
+     */
+    bool apply(const cv::Mat& inputFrame, cv::Mat& outputFrame, Isa isa);
+
+    /**
+     * @brief Apply the enhancement to a run of pixels
+     *
+     * @param input Interleaved 8-bit input pixels
+     * @param output Interleaved 8-bit output pixels
+     * @param pixels Number of pixels
+     * @param channels Channels per pixel
+     */
+    void applyToRow(const uchar* input, uchar* output, int pixels, int channels) override;
+
+    /**
+     * @brief Get the name of the filter
+     *
+     * @return std::string The filter name
+     */
+    std::string getName() const override;
+
+    /**
+     * @brief Configure the filter with custom parameters
+     *
+     * Accepts "brightness", "contrast", "gamma" and "saturation"; values
+     * outside their range are ignored.
+     *
+     * @param params A map of parameter name to value
+     * @return true if configuration was successful, false otherwise
+     */
+    bool configure(const std::map<std::string, double>& params) override;
+
+    /**
+     * @brief Enhancement works on grayscale frames (tone only)
+     *
+     * @return true
+     */
+    bool acceptsGrayInput() const override;
+
+    /**
+     * @brief Every output pixel depends only on the same input pixel
+     *
+     * @return AccessPattern::Point
+     */
+    AccessPattern getAccessPattern() const override;
+
+    /**
+     * @brief Get the fastest instruction set supported by this CPU
+     *
+     * @return Instruction set chosen by apply()
+     */
+    static Isa bestIsa();
+
+    /**
+     * @brief Check whether an instruction set can be used on this CPU
+     *
+     * @param isa Instruction set to check
+     * @return true if it is compiled in and supported at runtime
+     */
+    static bool isAvailable(Isa isa);
+
+    /**
+     * @brief Get a printable name for an instruction set
+     *
+     * @param isa Instruction set
+     * @return Name such as "AVX2"
+     */
+    static const char* isaName(Isa isa);
+
+private:
+    // Lookup tables and gains of one configuration; never modified once published
+    struct Tables {
+        alignas(64) uint8_t tone[256];      ///< Brightness, contrast and gamma
+        alignas(32) uint8_t nibbles[256];   ///< tone as 16 pshufb tables (see rebuildTables())
+        int8_t channelWeight;               ///< Weight of a channel in the saturation blend
+        int8_t lumaWeight;                  ///< Weight of luma; 0 leaves colours unchanged
+        uint8_t saturationShift;            ///< The weights sum to 1 << saturationShift
+        bool linear;                        ///< tone follows toneGain and toneOffset (gamma 1)
+        uint16_t toneGain;                  ///< Contrast in Q12
+        int16_t toneOffset;                 ///< Offset of the line in Q4, plus rounding
+    };
+
+    double brightness;  ///< Offset added after contrast
+    double contrast;    ///< Gain around mid-gray
+    double gamma;       ///< Gamma correction exponent (output = input^(1/gamma))
+    double saturation;  ///< Saturation gain
+
+    // Current tables; read and replaced with std::atomic_load / std::atomic_store only
+    std::shared_ptr<const Tables> tables;
+
+    // Recompute the tables from the parameters and publish them
+    void rebuildTables();
+
+    // Filter a run of pixels with one set of tables
+    static void applyToRow(const Tables& current, const uchar* input, uchar* output, int pixels, int channels,
+                           Isa isa);
+};
@@ -1,55 +1,976 @@
 #include "EdgeDetectionFilter.h"
+#include "../utils/Simd.h"
+#include "../utils/TileExecutor.h"
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
 
-EdgeDetectionFilter::EdgeDetectionFilter() 
-    : threshold1(100.0), threshold2(200.0), apertureSize(3) {
+namespace {
+
+// Fixed-point BGR to gray weights (Q14), the same as cv::cvtColor uses
+const int GRAY_SHIFT = 14;
+const int BLUE_WEIGHT = 1868;
+const int GREEN_WEIGHT = 9617;
+const int RED_WEIGHT = 4899;
+const int GRAY_ROUNDING = 1 << (GRAY_SHIFT - 1);
+
+// tan(22.5 degrees) in Q15, as in cv::Canny
+const int ANGLE_SHIFT = 15;
+const int TAN_22_5 = 13573;
+
+// Edge map values, as in cv::Canny
+const uint8_t MAYBE_EDGE = 0;
+const uint8_t NOT_EDGE = 1;
+const uint8_t EDGE = 2;
+
+// Row rings of one band of the detector
+struct CannyRows {
+    std::vector<uint8_t> gray;        ///< 3 rows of width + 2, edge columns replicated
+    std::vector<int16_t> dx;          ///< 2 rows of horizontal gradients
+    std::vector<int16_t> dy;          ///< 2 rows of vertical gradients
+    std::vector<int16_t> magnitude;   ///< 3 rows of width + 2, zero at both ends
+    std::vector<int16_t> zeroRow;     ///< Magnitude outside the frame
+    std::vector<uint8_t*> stack;      ///< Edge pixels whose neighbours are unvisited
+};
+
+struct CannyScratch {
+    std::vector<uint8_t> map;         ///< (height + 2) x (width + 2) edge map
+    std::vector<CannyRows> bands;     ///< One per band; the serial path uses one
+};
+
+// Row kernels. Gray and magnitude rows are padded by one element on each
+// side, so pixel x of a row is at index x + 1.
+// gray:     BGR pixels to gray
+// gradient: 3x3 Sobel dx, dy and their L1 magnitude (the cv::Canny default)
+// suppress: non-maximum suppression along the gradient direction, quantized
+//           to 0/45/90/135 degrees exactly like cv::Canny; fills one edge
+//           map row and pushes strong edges onto the stack
+// output:   edge map row to 0/255 pixels with one or three channels
+using GrayKernel = void (*)(const uint8_t* bgr, uint8_t* gray, int width);
+using GradientKernel = void (*)(const uint8_t* above, const uint8_t* row, const uint8_t* below, int width,
+                                int16_t* dx, int16_t* dy, int16_t* magnitude);
+using SuppressKernel = void (*)(const int16_t* above, const int16_t* row, const int16_t* below,
+                                const int16_t* dx, const int16_t* dy, int width, int low, int high,
+                                uint8_t* map, std::vector<uint8_t*>& stack);
+using OutputKernel = void (*)(const uint8_t* map, uint8_t* out, int width, int channels);
+
+void grayScalar(const uint8_t* bgr, uint8_t* gray, int width) {
+    for (int x = 0; x < width; ++x) {
+        const uint8_t* pixel = bgr + 3 * x;
+        gray[x] = static_cast<uint8_t>((pixel[0] * BLUE_WEIGHT + pixel[1] * GREEN_WEIGHT +
+                                        pixel[2] * RED_WEIGHT + GRAY_ROUNDING) >> GRAY_SHIFT);
+    }
+}
+
+void gradientScalar(const uint8_t* above, const uint8_t* row, const uint8_t* below, int width,
+                    int16_t* dx, int16_t* dy, int16_t* magnitude) {
+    for (int x = 0; x < width; ++x) {
+        int p = x + 1;
+        int gx = (above[p + 1] - above[p - 1]) + 2 * (row[p + 1] - row[p - 1]) + (below[p + 1] - below[p - 1]);
+        int gy = (below[p - 1] + 2 * below[p] + below[p + 1]) - (above[p - 1] + 2 * above[p] + above[p + 1]);
+        dx[x] = static_cast<int16_t>(gx);
+        dy[x] = static_cast<int16_t>(gy);
+        magnitude[p] = static_cast<int16_t>(std::abs(gx) + std::abs(gy));
+    }
+}
+
+void suppressScalar(const int16_t* above, const int16_t* row, const int16_t* below,
+                    const int16_t* dx, const int16_t* dy, int width, int low, int high,
+                    uint8_t* map, std::vector<uint8_t*>& stack) {
+    for (int x = 0; x < width; ++x) {
+        int p = x + 1;
+        int m = row[p];
+        uint8_t value = NOT_EDGE;
+
+        if (m > low) {
+            int xs = dx[x];
+            int ys = dy[x];
+            int ax = std::abs(xs);
+            int ay = std::abs(ys) << ANGLE_SHIFT;
+            int tg22x = ax * TAN_22_5;
+
+            bool isMaximum;
+            if (ay < tg22x) {
+                isMaximum = m > row[p - 1] && m >= row[p + 1];
+            } else if (ay > tg22x + (ax << (ANGLE_SHIFT + 1))) {
+                isMaximum = m > above[p] && m >= below[p];
+            } else {
+                int s = (xs ^ ys) < 0 ? -1 : 1;
+                isMaximum = m > above[p - s] && m > below[p + s];
+            }
+
+            if (isMaximum) {
+                value = m > high ? EDGE : MAYBE_EDGE;
+            }
+        }
+
+        map[x] = value;
+        if (value == EDGE) {
+            stack.push_back(map + x);
+        }
+    }
+}
+
+void outputScalar(const uint8_t* map, uint8_t* out, int width, int channels) {
+    if (channels == 1) {
+        for (int x = 0; x < width; ++x) {
+            out[x] = map[x] == EDGE ? 255 : 0;
+        }
+    } else {
+        for (int x = 0; x < width; ++x) {
+            uint8_t value = map[x] == EDGE ? 255 : 0;
+            out[3 * x] = value;
+            out[3 * x + 1] = value;
+            out[3 * x + 2] = value;
+        }
+    }
+}
+
+#ifdef SIMD_X86
+
+// Gray value of four pixels from their 16-bit blue/green/red lanes: the
+// (blue, green) and (red, 1) pairs are weighted with one madd each
+SIMD_TARGET("sse4.1")
+inline __m128i weighSse41(__m128i blueGreen, __m128i redOne) {
+    const __m128i blueGreenWeights = _mm_set1_epi32((GREEN_WEIGHT << 16) | BLUE_WEIGHT);
+    const __m128i redRoundingWeights = _mm_set1_epi32((GRAY_ROUNDING << 16) | RED_WEIGHT);
+    __m128i sum = _mm_add_epi32(_mm_madd_epi16(blueGreen, blueGreenWeights),
+                                _mm_madd_epi16(redOne, redRoundingWeights));
+    return _mm_srli_epi32(sum, GRAY_SHIFT);
+}
+
+SIMD_TARGET("sse4.1")
+inline __m128i graySse41(__m128i blue, __m128i green, __m128i red) {
+    const __m128i one = _mm_set1_epi16(1);
+    return _mm_packs_epi32(weighSse41(_mm_unpacklo_epi16(blue, green), _mm_unpacklo_epi16(red, one)),
+                           weighSse41(_mm_unpackhi_epi16(blue, green), _mm_unpackhi_epi16(red, one)));
+}
+
+SIMD_TARGET("sse4.1")
+inline __m128i loadWidenedSse41(const uint8_t* source) {
+    return _mm_cvtepu8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(source)));
+}
+
+SIMD_TARGET("sse4.1")
+inline __m128i loadSse41(const int16_t* source) {
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(source));
+}
+
+SIMD_TARGET("sse4.1")
+void graySse41(const uint8_t* bgr, uint8_t* gray, int width) {
+    // Byte shuffles that gather one channel of 16 pixels from three loads
+    const __m128i blue0 = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i blue1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m128i blue2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m128i green0 = _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i green1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m128i green2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m128i red0 = _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i red1 = _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m128i red2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    const __m128i zero = _mm_setzero_si128();
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        const uint8_t* pixels = bgr + 3 * x;
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 16));
+        __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + 32));
+
+        __m128i blue = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, blue0), _mm_shuffle_epi8(v1, blue1)),
+                                    _mm_shuffle_epi8(v2, blue2));
+        __m128i green = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, green0), _mm_shuffle_epi8(v1, green1)),
+                                     _mm_shuffle_epi8(v2, green2));
+        __m128i red = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(v0, red0), _mm_shuffle_epi8(v1, red1)),
+                                   _mm_shuffle_epi8(v2, red2));
+
+        __m128i low = graySse41(_mm_unpacklo_epi8(blue, zero), _mm_unpacklo_epi8(green, zero),
+                                _mm_unpacklo_epi8(red, zero));
+        __m128i high = graySse41(_mm_unpackhi_epi8(blue, zero), _mm_unpackhi_epi8(green, zero),
+                                 _mm_unpackhi_epi8(red, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(gray + x), _mm_packus_epi16(low, high));
+    }
+    grayScalar(bgr + 3 * x, gray + x, width - x);
+}
+
+SIMD_TARGET("sse4.1")
+void gradientSse41(const uint8_t* above, const uint8_t* row, const uint8_t* below, int width,
+                   int16_t* dx, int16_t* dy, int16_t* magnitude) {
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        __m128i aboveLeft = loadWidenedSse41(above + x);
+        __m128i aboveCentre = loadWidenedSse41(above + x + 1);
+        __m128i aboveRight = loadWidenedSse41(above + x + 2);
+        __m128i rowLeft = loadWidenedSse41(row + x);
+        __m128i rowRight = loadWidenedSse41(row + x + 2);
+        __m128i belowLeft = loadWidenedSse41(below + x);
+        __m128i belowCentre = loadWidenedSse41(below + x + 1);
+        __m128i belowRight = loadWidenedSse41(below + x + 2);
+
+        __m128i gx = _mm_add_epi16(_mm_add_epi16(_mm_sub_epi16(aboveRight, aboveLeft),
+                                                 _mm_slli_epi16(_mm_sub_epi16(rowRight, rowLeft), 1)),
+                                   _mm_sub_epi16(belowRight, belowLeft));
+        __m128i gy = _mm_sub_epi16(
+            _mm_add_epi16(_mm_add_epi16(belowLeft, _mm_slli_epi16(belowCentre, 1)), belowRight),
+            _mm_add_epi16(_mm_add_epi16(aboveLeft, _mm_slli_epi16(aboveCentre, 1)), aboveRight));
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dx + x), gx);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dy + x), gy);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(magnitude + x + 1),
+                         _mm_add_epi16(_mm_abs_epi16(gx), _mm_abs_epi16(gy)));
+    }
+    gradientScalar(above + x, row + x, below + x, width - x, dx + x, dy + x, magnitude + x);
+}
+
+SIMD_TARGET("sse4.1")
+void suppressSse41(const int16_t* above, const int16_t* row, const int16_t* below,
+                   const int16_t* dx, const int16_t* dy, int width, int low, int high,
+                   uint8_t* map, std::vector<uint8_t*>& stack) {
+    const __m128i lowThreshold = _mm_set1_epi16(static_cast<short>(low));
+    const __m128i highThreshold = _mm_set1_epi16(static_cast<short>(high));
+    const __m128i tan22 = _mm_set1_epi32(TAN_22_5);
+    const __m128i notEdge = _mm_set1_epi16(NOT_EDGE);
+    const __m128i edge = _mm_set1_epi16(EDGE);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int p = x + 1;
+        __m128i m = loadSse41(row + p);
+        __m128i candidate = _mm_cmpgt_epi16(m, lowThreshold);
+        if (_mm_movemask_epi8(candidate) == 0) {
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(map + x), _mm_packus_epi16(notEdge, notEdge));
+            continue;
+        }
+
+        __m128i xs = loadSse41(dx + x);
+        __m128i ys = loadSse41(dy + x);
+        __m128i ax = _mm_abs_epi16(xs);
+        __m128i ay = _mm_abs_epi16(ys);
+
+        // The angle tests need 32 bits
+        __m128i axLow = _mm_cvtepi16_epi32(ax);
+        __m128i axHigh = _mm_cvtepi16_epi32(_mm_srli_si128(ax, 8));
+        __m128i ayLow = _mm_slli_epi32(_mm_cvtepi16_epi32(ay), ANGLE_SHIFT);
+        __m128i ayHigh = _mm_slli_epi32(_mm_cvtepi16_epi32(_mm_srli_si128(ay, 8)), ANGLE_SHIFT);
+        __m128i tg22Low = _mm_mullo_epi32(axLow, tan22);
+        __m128i tg22High = _mm_mullo_epi32(axHigh, tan22);
+        __m128i tg67Low = _mm_add_epi32(tg22Low, _mm_slli_epi32(axLow, ANGLE_SHIFT + 1));
+        __m128i tg67High = _mm_add_epi32(tg22High, _mm_slli_epi32(axHigh, ANGLE_SHIFT + 1));
+        __m128i horizontal = _mm_packs_epi32(_mm_cmplt_epi32(ayLow, tg22Low), _mm_cmplt_epi32(ayHigh, tg22High));
+        __m128i vertical = _mm_packs_epi32(_mm_cmpgt_epi32(ayLow, tg67Low), _mm_cmpgt_epi32(ayHigh, tg67High));
+        __m128i rising = _mm_srai_epi16(_mm_xor_si128(xs, ys), 15);
+
+        __m128i before = _mm_blendv_epi8(loadSse41(above + p - 1), loadSse41(above + p + 1), rising);
+        __m128i after = _mm_blendv_epi8(loadSse41(below + p + 1), loadSse41(below + p - 1), rising);
+        before = _mm_blendv_epi8(before, loadSse41(above + p), vertical);
+        after = _mm_blendv_epi8(after, loadSse41(below + p), vertical);
+        before = _mm_blendv_epi8(before, loadSse41(row + p - 1), horizontal);
+        after = _mm_blendv_epi8(after, loadSse41(row + p + 1), horizontal);
+
+        // Ties with the following neighbour count as maxima except diagonally
+        __m128i straight = _mm_or_si128(horizontal, vertical);
+        __m128i isMaximum = _mm_and_si128(
+            _mm_cmpgt_epi16(m, before),
+            _mm_or_si128(_mm_cmpgt_epi16(m, after), _mm_and_si128(_mm_cmpeq_epi16(m, after), straight)));
+        candidate = _mm_and_si128(candidate, isMaximum);
+        __m128i strong = _mm_and_si128(candidate, _mm_cmpgt_epi16(m, highThreshold));
+
+        __m128i value = _mm_or_si128(_mm_andnot_si128(candidate, notEdge), _mm_and_si128(strong, edge));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(map + x), _mm_packus_epi16(value, value));
+
+        int strongBits = _mm_movemask_epi8(_mm_packs_epi16(strong, strong)) & 0xFF;
+        for (int i = 0; strongBits != 0; ++i, strongBits >>= 1) {
+            if (strongBits & 1) {
+                stack.push_back(map + x + i);
+            }
+        }
+    }
+    suppressScalar(above + x, row + x, below + x, dx + x, dy + x, width - x, low, high, map + x, stack);
+}
+
+SIMD_TARGET("sse4.1")
+void outputSse41(const uint8_t* map, uint8_t* out, int width, int channels) {
+    const __m128i edge = _mm_set1_epi8(EDGE);
+    const __m128i spread0 = _mm_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+    const __m128i spread1 = _mm_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+    const __m128i spread2 = _mm_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m128i value = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(map + x)), edge);
+        if (channels == 1) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + x), value);
+        } else {
+            __m128i* pixels = reinterpret_cast<__m128i*>(out + 3 * x);
+            _mm_storeu_si128(pixels, _mm_shuffle_epi8(value, spread0));
+            _mm_storeu_si128(pixels + 1, _mm_shuffle_epi8(value, spread1));
+            _mm_storeu_si128(pixels + 2, _mm_shuffle_epi8(value, spread2));
+        }
+    }
+    outputScalar(map + x, out + channels * x, width - x, channels);
+}
+
+// The AVX2 kernels take twice the pixels of the SSE4.1 ones; where those
+// shuffle within 16 bytes, each 128-bit lane holds 16 consecutive pixels
+SIMD_TARGET("avx2")
+inline __m256i weighAvx2(__m256i blueGreen, __m256i redOne) {
+    const __m256i blueGreenWeights = _mm256_set1_epi32((GREEN_WEIGHT << 16) | BLUE_WEIGHT);
+    const __m256i redRoundingWeights = _mm256_set1_epi32((GRAY_ROUNDING << 16) | RED_WEIGHT);
+    __m256i sum = _mm256_add_epi32(_mm256_madd_epi16(blueGreen, blueGreenWeights),
+                                   _mm256_madd_epi16(redOne, redRoundingWeights));
+    return _mm256_srli_epi32(sum, GRAY_SHIFT);
+}
+
+SIMD_TARGET("avx2")
+inline __m256i grayAvx2(__m256i blue, __m256i green, __m256i red) {
+    const __m256i one = _mm256_set1_epi16(1);
+    return _mm256_packs_epi32(weighAvx2(_mm256_unpacklo_epi16(blue, green), _mm256_unpacklo_epi16(red, one)),
+                              weighAvx2(_mm256_unpackhi_epi16(blue, green), _mm256_unpackhi_epi16(red, one)));
+}
+
+// Lane 0 holds 16 bytes at source, lane 1 the 16 bytes 48 further on
+SIMD_TARGET("avx2")
+inline __m256i loadLanesAvx2(const uint8_t* source) {
+    return _mm256_inserti128_si256(
+        _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source))),
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + 48)), 1);
+}
+
+SIMD_TARGET("avx2")
+inline void storeLanesAvx2(uint8_t* target, __m256i value) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm256_castsi256_si128(value));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(target + 48), _mm256_extracti128_si256(value, 1));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i loadWidenedAvx2(const uint8_t* source) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+}
+
+SIMD_TARGET("avx2")
+inline __m256i loadAvx2(const int16_t* source) {
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source));
+}
+
+// The 16-bit lanes as bytes in pixel order; every lane must fit a signed byte
+SIMD_TARGET("avx2")
+inline __m128i narrowAvx2(__m256i value) {
+    return _mm_packs_epi16(_mm256_castsi256_si128(value), _mm256_extracti128_si256(value, 1));
+}
+
+SIMD_TARGET("avx2")
+void grayAvx2(const uint8_t* bgr, uint8_t* gray, int width) {
+    const __m256i blue0 = _mm256_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i blue1 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1,
+                                           -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+    const __m256i blue2 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13,
+                                           -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+    const __m256i green0 = _mm256_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                            1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i green1 = _mm256_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1,
+                                            -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1);
+    const __m256i green2 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14,
+                                            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14);
+    const __m256i red0 = _mm256_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                          2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m256i red1 = _mm256_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1,
+                                          -1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1);
+    const __m256i red2 = _mm256_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15,
+                                          -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15);
+    const __m256i zero = _mm256_setzero_si256();
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        const uint8_t* pixels = bgr + 3 * x;
+        __m256i v0 = loadLanesAvx2(pixels);
+        __m256i v1 = loadLanesAvx2(pixels + 16);
+        __m256i v2 = loadLanesAvx2(pixels + 32);
+
+        __m256i blue = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, blue0), _mm256_shuffle_epi8(v1, blue1)),
+            _mm256_shuffle_epi8(v2, blue2));
+        __m256i green = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, green0), _mm256_shuffle_epi8(v1, green1)),
+            _mm256_shuffle_epi8(v2, green2));
+        __m256i red = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, red0), _mm256_shuffle_epi8(v1, red1)),
+            _mm256_shuffle_epi8(v2, red2));
+
+        __m256i low = grayAvx2(_mm256_unpacklo_epi8(blue, zero), _mm256_unpacklo_epi8(green, zero),
+                               _mm256_unpacklo_epi8(red, zero));
+        __m256i high = grayAvx2(_mm256_unpackhi_epi8(blue, zero), _mm256_unpackhi_epi8(green, zero),
+                                _mm256_unpackhi_epi8(red, zero));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(gray + x), _mm256_packus_epi16(low, high));
+    }
+    grayScalar(bgr + 3 * x, gray + x, width - x);
+}
+
+SIMD_TARGET("avx2")
+void gradientAvx2(const uint8_t* above, const uint8_t* row, const uint8_t* below, int width,
+                  int16_t* dx, int16_t* dy, int16_t* magnitude) {
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        __m256i aboveLeft = loadWidenedAvx2(above + x);
+        __m256i aboveCentre = loadWidenedAvx2(above + x + 1);
+        __m256i aboveRight = loadWidenedAvx2(above + x + 2);
+        __m256i rowLeft = loadWidenedAvx2(row + x);
+        __m256i rowRight = loadWidenedAvx2(row + x + 2);
+        __m256i belowLeft = loadWidenedAvx2(below + x);
+        __m256i belowCentre = loadWidenedAvx2(below + x + 1);
+        __m256i belowRight = loadWidenedAvx2(below + x + 2);
+
+        __m256i gx = _mm256_add_epi16(_mm256_add_epi16(_mm256_sub_epi16(aboveRight, aboveLeft),
+                                                       _mm256_slli_epi16(_mm256_sub_epi16(rowRight, rowLeft), 1)),
+                                      _mm256_sub_epi16(belowRight, belowLeft));
+        __m256i gy = _mm256_sub_epi16(
+            _mm256_add_epi16(_mm256_add_epi16(belowLeft, _mm256_slli_epi16(belowCentre, 1)), belowRight),
+            _mm256_add_epi16(_mm256_add_epi16(aboveLeft, _mm256_slli_epi16(aboveCentre, 1)), aboveRight));
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dx + x), gx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dy + x), gy);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(magnitude + x + 1),
+                            _mm256_add_epi16(_mm256_abs_epi16(gx), _mm256_abs_epi16(gy)));
+    }
+    gradientScalar(above + x, row + x, below + x, width - x, dx + x, dy + x, magnitude + x);
+}
+
+SIMD_TARGET("avx2")
+void suppressAvx2(const int16_t* above, const int16_t* row, const int16_t* below,
+                  const int16_t* dx, const int16_t* dy, int width, int low, int high,
+                  uint8_t* map, std::vector<uint8_t*>& stack) {
+    const __m256i lowThreshold = _mm256_set1_epi16(static_cast<short>(low));
+    const __m256i highThreshold = _mm256_set1_epi16(static_cast<short>(high));
+    const __m256i tan22 = _mm256_set1_epi32(TAN_22_5);
+    const __m256i notEdge = _mm256_set1_epi16(NOT_EDGE);
+    const __m256i edge = _mm256_set1_epi16(EDGE);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        int p = x + 1;
+        __m256i m = loadAvx2(row + p);
+        __m256i candidate = _mm256_cmpgt_epi16(m, lowThreshold);
+        if (_mm256_movemask_epi8(candidate) == 0) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(map + x), narrowAvx2(notEdge));
+            continue;
+        }
+
+        __m256i xs = loadAvx2(dx + x);
+        __m256i ys = loadAvx2(dy + x);
+        __m256i ax = _mm256_abs_epi16(xs);
+        __m256i ay = _mm256_abs_epi16(ys);
+
+        // The angle tests need 32 bits; packing the halves back interleaves
+        // their 64-bit blocks, which the permute undoes
+        __m256i axLow = _mm256_cvtepi16_epi32(_mm256_castsi256_si128(ax));
+        __m256i axHigh = _mm256_cvtepi16_epi32(_mm256_extracti128_si256(ax, 1));
+        __m256i ayLow = _mm256_slli_epi32(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(ay)), ANGLE_SHIFT);
+        __m256i ayHigh = _mm256_slli_epi32(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(ay, 1)), ANGLE_SHIFT);
+        __m256i tg22Low = _mm256_mullo_epi32(axLow, tan22);
+        __m256i tg22High = _mm256_mullo_epi32(axHigh, tan22);
+        __m256i tg67Low = _mm256_add_epi32(tg22Low, _mm256_slli_epi32(axLow, ANGLE_SHIFT + 1));
+        __m256i tg67High = _mm256_add_epi32(tg22High, _mm256_slli_epi32(axHigh, ANGLE_SHIFT + 1));
+        __m256i horizontal = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(_mm256_cmpgt_epi32(tg22Low, ayLow), _mm256_cmpgt_epi32(tg22High, ayHigh)), 0xD8);
+        __m256i vertical = _mm256_permute4x64_epi64(
+            _mm256_packs_epi32(_mm256_cmpgt_epi32(ayLow, tg67Low), _mm256_cmpgt_epi32(ayHigh, tg67High)), 0xD8);
+        __m256i rising = _mm256_srai_epi16(_mm256_xor_si256(xs, ys), 15);
+
+        __m256i before = _mm256_blendv_epi8(loadAvx2(above + p - 1), loadAvx2(above + p + 1), rising);
+        __m256i after = _mm256_blendv_epi8(loadAvx2(below + p + 1), loadAvx2(below + p - 1), rising);
+        before = _mm256_blendv_epi8(before, loadAvx2(above + p), vertical);
+        after = _mm256_blendv_epi8(after, loadAvx2(below + p), vertical);
+        before = _mm256_blendv_epi8(before, loadAvx2(row + p - 1), horizontal);
+        after = _mm256_blendv_epi8(after, loadAvx2(row + p + 1), horizontal);
+
+        // Ties with the following neighbour count as maxima except diagonally
+        __m256i straight = _mm256_or_si256(horizontal, vertical);
+        __m256i isMaximum = _mm256_and_si256(
+            _mm256_cmpgt_epi16(m, before),
+            _mm256_or_si256(_mm256_cmpgt_epi16(m, after), _mm256_and_si256(_mm256_cmpeq_epi16(m, after), straight)));
+        candidate = _mm256_and_si256(candidate, isMaximum);
+        __m256i strong = _mm256_and_si256(candidate, _mm256_cmpgt_epi16(m, highThreshold));
+
+        __m256i value = _mm256_or_si256(_mm256_andnot_si256(candidate, notEdge), _mm256_and_si256(strong, edge));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(map + x), narrowAvx2(value));
+
+        int strongBits = _mm_movemask_epi8(narrowAvx2(strong));
+        for (int i = 0; strongBits != 0; ++i, strongBits >>= 1) {
+            if (strongBits & 1) {
+                stack.push_back(map + x + i);
+            }
+        }
+    }
+    suppressScalar(above + x, row + x, below + x, dx + x, dy + x, width - x, low, high, map + x, stack);
+}
+
+SIMD_TARGET("avx2")
+void outputAvx2(const uint8_t* map, uint8_t* out, int width, int channels) {
+    const __m256i edge = _mm256_set1_epi8(EDGE);
+    const __m256i spread0 = _mm256_setr_epi8(0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5,
+                                             0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5);
+    const __m256i spread1 = _mm256_setr_epi8(5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10,
+                                             5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10);
+    const __m256i spread2 = _mm256_setr_epi8(10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15,
+                                             10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i value = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(map + x)), edge);
+        if (channels == 1) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + x), value);
+        } else {
+            uint8_t* pixels = out + 3 * x;
+            storeLanesAvx2(pixels, _mm256_shuffle_epi8(value, spread0));
+            storeLanesAvx2(pixels + 16, _mm256_shuffle_epi8(value, spread1));
+            storeLanesAvx2(pixels + 32, _mm256_shuffle_epi8(value, spread2));
+        }
+    }
+    outputScalar(map + x, out + channels * x, width - x, channels);
 }
 
-EdgeDetectionFilter::EdgeDetectionFilter(double threshold1, double threshold2, int apertureSize)
-    : threshold1(threshold1), threshold2(threshold2), apertureSize(apertureSize) {
+#endif  // SIMD_X86
+
+#ifdef SIMD_NEON
+
+void grayNeon(const uint8_t* bgr, uint8_t* gray, int width) {
+    const uint32x4_t rounding = vdupq_n_u32(GRAY_ROUNDING);
+
+    auto weigh = [&](uint16x4_t blue, uint16x4_t green, uint16x4_t red) {
+        uint32x4_t sum = vmlal_n_u16(rounding, blue, BLUE_WEIGHT);
+        sum = vmlal_n_u16(sum, green, GREEN_WEIGHT);
+        sum = vmlal_n_u16(sum, red, RED_WEIGHT);
+        return vshrn_n_u32(sum, GRAY_SHIFT);
+    };
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        uint8x8x3_t pixels = vld3_u8(bgr + 3 * x);
+        uint16x8_t blue = vmovl_u8(pixels.val[0]);
+        uint16x8_t green = vmovl_u8(pixels.val[1]);
+        uint16x8_t red = vmovl_u8(pixels.val[2]);
+        uint16x8_t result = vcombine_u16(weigh(vget_low_u16(blue), vget_low_u16(green), vget_low_u16(red)),
+                                         weigh(vget_high_u16(blue), vget_high_u16(green), vget_high_u16(red)));
+        vst1_u8(gray + x, vmovn_u16(result));
+    }
+    grayScalar(bgr + 3 * x, gray + x, width - x);
+}
+
+void gradientNeon(const uint8_t* above, const uint8_t* row, const uint8_t* below, int width,
+                  int16_t* dx, int16_t* dy, int16_t* magnitude) {
+    auto load = [](const uint8_t* source) {
+        return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(source)));
+    };
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int16x8_t aboveLeft = load(above + x);
+        int16x8_t aboveCentre = load(above + x + 1);
+        int16x8_t aboveRight = load(above + x + 2);
+        int16x8_t rowLeft = load(row + x);
+        int16x8_t rowRight = load(row + x + 2);
+        int16x8_t belowLeft = load(below + x);
+        int16x8_t belowCentre = load(below + x + 1);
+        int16x8_t belowRight = load(below + x + 2);
+
+        int16x8_t gx = vaddq_s16(vaddq_s16(vsubq_s16(aboveRight, aboveLeft),
+                                           vshlq_n_s16(vsubq_s16(rowRight, rowLeft), 1)),
+                                 vsubq_s16(belowRight, belowLeft));
+        int16x8_t gy = vsubq_s16(vaddq_s16(vaddq_s16(belowLeft, vshlq_n_s16(belowCentre, 1)), belowRight),
+                                 vaddq_s16(vaddq_s16(aboveLeft, vshlq_n_s16(aboveCentre, 1)), aboveRight));
+
+        vst1q_s16(dx + x, gx);
+        vst1q_s16(dy + x, gy);
+        vst1q_s16(magnitude + x + 1, vaddq_s16(vabsq_s16(gx), vabsq_s16(gy)));
+    }
+    gradientScalar(above + x, row + x, below + x, width - x, dx + x, dy + x, magnitude + x);
+}
+
+void suppressNeon(const int16_t* above, const int16_t* row, const int16_t* below,
+                  const int16_t* dx, const int16_t* dy, int width, int low, int high,
+                  uint8_t* map, std::vector<uint8_t*>& stack) {
+    const int16x8_t lowThreshold = vdupq_n_s16(static_cast<int16_t>(low));
+    const int16x8_t highThreshold = vdupq_n_s16(static_cast<int16_t>(high));
+    const uint16x8_t notEdge = vdupq_n_u16(NOT_EDGE);
+    const uint16x8_t edge = vdupq_n_u16(EDGE);
+
+    int x = 0;
+    for (; x + 8 <= width; x += 8) {
+        int p = x + 1;
+        int16x8_t m = vld1q_s16(row + p);
+        uint16x8_t candidate = vcgtq_s16(m, lowThreshold);
+        if (vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(candidate)), 0) == 0) {
+            vst1_u8(map + x, vmovn_u16(notEdge));
+            continue;
+        }
+
+        int16x8_t xs = vld1q_s16(dx + x);
+        int16x8_t ys = vld1q_s16(dy + x);
+        int16x8_t ax = vabsq_s16(xs);
+        int16x8_t ay = vabsq_s16(ys);
+
+        // The angle tests need 32 bits
+        int32x4_t axLow = vmovl_s16(vget_low_s16(ax));
+        int32x4_t axHigh = vmovl_s16(vget_high_s16(ax));
+        int32x4_t ayLow = vshlq_n_s32(vmovl_s16(vget_low_s16(ay)), ANGLE_SHIFT);
+        int32x4_t ayHigh = vshlq_n_s32(vmovl_s16(vget_high_s16(ay)), ANGLE_SHIFT);
+        int32x4_t tg22Low = vmulq_n_s32(axLow, TAN_22_5);
+        int32x4_t tg22High = vmulq_n_s32(axHigh, TAN_22_5);
+        int32x4_t tg67Low = vaddq_s32(tg22Low, vshlq_n_s32(axLow, ANGLE_SHIFT + 1));
+        int32x4_t tg67High = vaddq_s32(tg22High, vshlq_n_s32(axHigh, ANGLE_SHIFT + 1));
+        uint16x8_t horizontal = vcombine_u16(vmovn_u32(vcltq_s32(ayLow, tg22Low)),
+                                             vmovn_u32(vcltq_s32(ayHigh, tg22High)));
+        uint16x8_t vertical = vcombine_u16(vmovn_u32(vcgtq_s32(ayLow, tg67Low)),
+                                           vmovn_u32(vcgtq_s32(ayHigh, tg67High)));
+        uint16x8_t rising = vcltq_s16(veorq_s16(xs, ys), vdupq_n_s16(0));
+
+        int16x8_t before = vbslq_s16(rising, vld1q_s16(above + p + 1), vld1q_s16(above + p - 1));
+        int16x8_t after = vbslq_s16(rising, vld1q_s16(below + p - 1), vld1q_s16(below + p + 1));
+        before = vbslq_s16(vertical, vld1q_s16(above + p), before);
+        after = vbslq_s16(vertical, vld1q_s16(below + p), after);
+        before = vbslq_s16(horizontal, vld1q_s16(row + p - 1), before);
+        after = vbslq_s16(horizontal, vld1q_s16(row + p + 1), after);
+
+        // Ties with the following neighbour count as maxima except diagonally
+        uint16x8_t straight = vorrq_u16(horizontal, vertical);
+        uint16x8_t isMaximum = vandq_u16(vcgtq_s16(m, before),
+                                         vorrq_u16(vcgtq_s16(m, after), vandq_u16(vceqq_s16(m, after), straight)));
+        candidate = vandq_u16(candidate, isMaximum);
+        uint16x8_t strong = vandq_u16(candidate, vcgtq_s16(m, highThreshold));
+
+        uint16x8_t value = vorrq_u16(vbicq_u16(notEdge, candidate), vandq_u16(strong, edge));
+        vst1_u8(map + x, vmovn_u16(value));
+
+        if (vget_lane_u64(vreinterpret_u64_u8(vmovn_u16(strong)), 0) != 0) {
+            for (int i = 0; i < 8; ++i) {
+                if (map[x + i] == EDGE) {
+                    stack.push_back(map + x + i);
+                }
+            }
+        }
+    }
+    suppressScalar(above + x, row + x, below + x, dx + x, dy + x, width - x, low, high, map + x, stack);
+}
+
+void outputNeon(const uint8_t* map, uint8_t* out, int width, int channels) {
+    const uint8x16_t edge = vdupq_n_u8(EDGE);
+
+    int x = 0;
+    for (; x + 16 <= width; x += 16) {
+        uint8x16_t value = vceqq_u8(vld1q_u8(map + x), edge);
+        if (channels == 1) {
+            vst1q_u8(out + x, value);
+        } else {
+            uint8x16x3_t pixels = {{value, value, value}};
+            vst3q_u8(out + 3 * x, pixels);
+        }
+    }
+    outputScalar(map + x, out + channels * x, width - x, channels);
+}
+
+#endif  // SIMD_NEON
+
+struct RowKernels {
+    GrayKernel gray;
+    GradientKernel gradient;
+    SuppressKernel suppress;
+    OutputKernel output;
+};
+
+RowKernels kernelsFor(EdgeDetectionFilter::Isa isa) {
+    switch (isa) {
+#ifdef SIMD_X86
+        case EdgeDetectionFilter::Isa::Sse41:
+            return {graySse41, gradientSse41, suppressSse41, outputSse41};
+        case EdgeDetectionFilter::Isa::Avx2:
+            return {grayAvx2, gradientAvx2, suppressAvx2, outputAvx2};
+#endif
+#ifdef SIMD_NEON
+        case EdgeDetectionFilter::Isa::Neon:
+            return {grayNeon, gradientNeon, suppressNeon, outputNeon};
+#endif
+        default:
+            return {grayScalar, gradientScalar, suppressScalar, outputScalar};
+    }
+}
+
+// Magnitudes never exceed 8 * 255, so this keeps 16-bit compares exact.
+// Clamped as a double, since converting a larger value to int is undefined
+int clampThreshold(double threshold) {
+    return static_cast<int>(std::max(-1.0, std::min(std::floor(threshold), 32767.0)));
+}
+
+// Size the edge map for a frame and mark its border as NOT_EDGE, which
+// keeps the hysteresis walk inside the frame
+uint8_t* prepareMap(int width, int height, CannyScratch& scratch) {
+    const int padded = width + 2;
+    scratch.map.resize(static_cast<size_t>(padded) * (height + 2));
+
+    uint8_t* map = scratch.map.data();
+    std::memset(map, NOT_EDGE, padded);
+    std::memset(map + static_cast<size_t>(height + 1) * padded, NOT_EDGE, padded);
+    for (int y = 1; y <= height; ++y) {
+        map[static_cast<size_t>(y) * padded] = NOT_EDGE;
+        map[static_cast<size_t>(y) * padded + width + 1] = NOT_EDGE;
+    }
+    return map;
+}
+
+/**
+ * Fill edge map rows [first, last): one pass over the source converts each
+ * row to gray, takes its gradients and suppresses the row above (three-row
+ * rings). A band reads up to two source rows beyond each end, so bands of
+ * one frame can be filled concurrently; strong edges go onto the band's
+ * stack.
+ */
+void suppressBand(const uint8_t* src, size_t srcStep, int width, int height, int channels,
+                  int first, int last, int low, int high, uint8_t* map, CannyRows& rows,
+                  const RowKernels& kernels) {
+    const int padded = width + 2;
+    rows.gray.resize(3 * padded);
+    rows.dx.resize(2 * width);
+    rows.dy.resize(2 * width);
+    rows.magnitude.assign(3 * padded, 0);
+    rows.zeroRow.assign(padded, 0);
+    rows.stack.clear();
+
+    auto gray = [&](int y) { return rows.gray.data() + (y % 3) * padded; };
+    auto magnitude = [&](int y) { return rows.magnitude.data() + (y % 3) * padded; };
+    auto dx = [&](int y) { return rows.dx.data() + (y % 2) * width; };
+    auto dy = [&](int y) { return rows.dy.data() + (y % 2) * width; };
+    auto mapRow = [&](int y) { return map + static_cast<size_t>(y + 1) * padded + 1; };
+    auto magnitudeOrZero = [&](int y) {
+        return y >= 0 && y < height ? magnitude(y) : rows.zeroRow.data();
+    };
+
+    auto convertRow = [&](int y) {
+        const uint8_t* source = src + static_cast<size_t>(y) * srcStep;
+        uint8_t* out = gray(y);
+        if (channels == 1) {
+            std::memcpy(out + 1, source, width);
+        } else {
+            kernels.gray(source, out + 1, width);
+        }
+        // Sobel in cv::Canny replicates the border
+        out[0] = out[1];
+        out[width + 1] = out[width];
+    };
+
+    // Gradients are needed one row beyond the band on each side
+    const int start = std::max(0, first - 1);
+    const int end = std::min(height, last + 1);
+    if (start > 0) {
+        convertRow(start - 1);
+    }
+    convertRow(start);
+    for (int y = start; y < end; ++y) {
+        if (y + 1 < height) {
+            convertRow(y + 1);
+        }
+        kernels.gradient(gray(y > 0 ? y - 1 : 0), gray(y), gray(y + 1 < height ? y + 1 : y), width,
+                         dx(y), dy(y), magnitude(y));
+
+        if (y > first) {
+            kernels.suppress(magnitudeOrZero(y - 2), magnitude(y - 1), magnitude(y), dx(y - 1), dy(y - 1),
+                             width, low, high, mapRow(y - 1), rows.stack);
+        }
+    }
+    if (last == height) {
+        kernels.suppress(magnitudeOrZero(height - 2), magnitude(height - 1), rows.zeroRow.data(),
+                         dx(height - 1), dy(height - 1), width, low, high, mapRow(height - 1), rows.stack);
+    }
+}
+
+// Hysteresis: grow the strong edges on every band's stack through weak
+// candidates, across band boundaries
+void followEdges(int width, CannyScratch& scratch, size_t bandCount) {
+    const std::ptrdiff_t padded = width + 2;
+    const std::ptrdiff_t neighbours[8] = {-padded - 1, -padded, -padded + 1, -1, 1,
+                                          padded - 1, padded, padded + 1};
+    for (size_t band = 0; band < bandCount; ++band) {
+        std::vector<uint8_t*>& stack = scratch.bands[band].stack;
+        while (!stack.empty()) {
+            uint8_t* pixel = stack.back();
+            stack.pop_back();
+            for (std::ptrdiff_t offset : neighbours) {
+                uint8_t* neighbour = pixel + offset;
+                if (*neighbour == MAYBE_EDGE) {
+                    *neighbour = EDGE;
+                    stack.push_back(neighbour);
+                }
+            }
+        }
+    }
+}
+
+// Write edge map rows [first, last) with the requested channel count
+void writeEdges(const uint8_t* map, int width, int first, int last,
+                uint8_t* dst, size_t dstStep, int dstChannels, const RowKernels& kernels) {
+    const size_t padded = width + 2;
+    for (int y = first; y < last; ++y) {
+        kernels.output(map + (y + 1) * padded + 1, dst + static_cast<size_t>(y) * dstStep, width, dstChannels);
+    }
+}
+
+/**
+ * Fused Canny on the calling thread, with thresholds from clampThreshold():
+ * suppression fills the whole edge map in one band, hysteresis follows the
+ * edges, and the map is written out.
+ */
+void detectEdges(const uint8_t* src, size_t srcStep, int width, int height, int channels,
+                 uint8_t* dst, size_t dstStep, int dstChannels, int low, int high,
+                 CannyScratch& scratch, const RowKernels& kernels) {
+    if (scratch.bands.empty()) {
+        scratch.bands.resize(1);
+    }
+    uint8_t* map = prepareMap(width, height, scratch);
+    suppressBand(src, srcStep, width, height, channels, 0, height,
+                 low, high, map, scratch.bands[0], kernels);
+    followEdges(width, scratch, 1);
+    writeEdges(map, width, 0, height, dst, dstStep, dstChannels, kernels);
+}
+
+}  // namespace
+
+struct EdgeDetectionFilter::Scratch : CannyScratch {
+};
+
+EdgeDetectionFilter::EdgeDetectionFilter() {
+    publish(100.0, 200.0, 3, true);
+}
+
+EdgeDetectionFilter::EdgeDetectionFilter(double threshold1, double threshold2, int apertureSize) {
     // Ensure aperture size is 3, 5, or 7
     if (apertureSize != 3 && apertureSize != 5 && apertureSize != 7) {
-        this->apertureSize = 3;
+        apertureSize = 3;
         std::cout << "Warning: Aperture size must be 3, 5, or 7. Reset to 3." << std::endl;
     }
+    publish(threshold1, threshold2, apertureSize, true);
 }
 
+EdgeDetectionFilter::~EdgeDetectionFilter() = default;
+
 bool EdgeDetectionFilter::apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) {
+    return detect(inputFrame, outputFrame, false, bestIsa(), *snapshot());
+}
+
+bool EdgeDetectionFilter::apply(const cv::Mat& inputFrame, cv::Mat& outputFrame, Isa isa) {
+    if (!isAvailable(isa)) {
+        return false;
+    }
+    return detect(inputFrame, outputFrame, false, isa, *snapshot());
+}
+
+bool EdgeDetectionFilter::applyAllowingGray(const cv::Mat& inputFrame, cv::Mat& outputFrame) {
+    return detect(inputFrame, outputFrame, true, bestIsa(), *snapshot());
+}
+
+bool EdgeDetectionFilter::acceptsGrayInput() const {
+    return true;
+}
+
+bool EdgeDetectionFilter::detect(const cv::Mat& inputFrame, cv::Mat& outputFrame, bool grayOutput, Isa isa,
+                                 const Settings& current) {
     if (!isEnabled() || inputFrame.empty()) {
-        outputFrame = inputFrame.clone();
+        inputFrame.copyTo(outputFrame);
         return false;
     }
     
     try {
+        int channels = inputFrame.channels();
+        if (usesFusedDetector(inputFrame, current)) {
+            // The source is fully read before the output is written, so
+            // the output may alias the input
+            int low = clampThreshold(std::min(current.threshold1, current.threshold2));
+            int high = clampThreshold(std::max(current.threshold1, current.threshold2));
+            int outputChannels = grayOutput ? 1 : channels;
+
+            std::unique_ptr<Scratch> scratch = acquireScratch();
+            cv::Mat source = inputFrame;
+            outputFrame.create(inputFrame.size(), CV_8UC(outputChannels));
+            detectEdges(source.data, source.step, source.cols, source.rows, channels,
+                        outputFrame.data, outputFrame.step, outputChannels, low, high, *scratch,
+                        kernelsFor(isa));
+            releaseScratch(std::move(scratch));
+            return true;
+        }
+
         // Convert to grayscale if needed
         cv::Mat grayFrame;
-        if (inputFrame.channels() == 3) {
+        if (channels == 3) {
             cv::cvtColor(inputFrame, grayFrame, cv::COLOR_BGR2GRAY);
         } else {
             grayFrame = inputFrame.clone();
         }
         
         // Apply Canny edge detector
-        cv::Canny(grayFrame, outputFrame, threshold1, threshold2, apertureSize);
+        cv::Canny(grayFrame, outputFrame, current.threshold1, current.threshold2, current.apertureSize);
         
         // Convert back to 3-channel if input was 3-channel
-        if (inputFrame.channels() == 3) {
+        if (channels == 3 && !grayOutput) {
             cv::cvtColor(outputFrame, outputFrame, cv::COLOR_GRAY2BGR);
         }
         
         return true;
     } catch (const cv::Exception& e) {
         std::cerr << "Error in EdgeDetectionFilter: " << e.what() << std::endl;
-        outputFrame = inputFrame.clone();
+        inputFrame.copyTo(outputFrame);
         return false;
     }
 }
 
+bool EdgeDetectionFilter::applyTiled(const cv::Mat& inputFrame, cv::Mat& outputFrame, TileExecutor& tiles,
+                                     bool allowGray) {
+    std::shared_ptr<const Settings> current = snapshot();
+    if (!isEnabled() || inputFrame.empty() || !usesFusedDetector(inputFrame, *current)) {
+        return detect(inputFrame, outputFrame, allowGray, bestIsa(), *current);
+    }
+
+    // Gradients and suppression run per tile; hysteresis has to follow
+    // edges across tiles, so it runs on this thread before the tiles write
+    // the output
+    const int width = inputFrame.cols;
+    const int height = inputFrame.rows;
+    const int channels = inputFrame.channels();
+    const int outputChannels = allowGray ? 1 : channels;
+    const int low = clampThreshold(std::min(current->threshold1, current->threshold2));
+    const int high = clampThreshold(std::max(current->threshold1, current->threshold2));
+    const RowKernels kernels = kernelsFor(bestIsa());
+
+    std::unique_ptr<Scratch> scratch = acquireScratch();
+    size_t bandCount = tiles.getTileCount(height);
+    if (scratch->bands.size() < bandCount) {
+        scratch->bands.resize(bandCount);
+    }
+
+    cv::Mat source = inputFrame;
+    uint8_t* map = prepareMap(width, height, *scratch);
+    tiles.forEachTile(height, [&](size_t tile, int first, int last) {
+        suppressBand(source.data, source.step, width, height, channels, first, last, low, high, map,
+                     scratch->bands[tile], kernels);
+    });
+    followEdges(width, *scratch, bandCount);
+
+    outputFrame.create(inputFrame.size(), CV_8UC(outputChannels));
+    tiles.forEachTile(height, [&](size_t, int first, int last) {
+        writeEdges(map, width, first, last, outputFrame.data, outputFrame.step, outputChannels, kernels);
+    });
+    releaseScratch(std::move(scratch));
+    return true;
+}
+
 std::string EdgeDetectionFilter::getName() const {
     return "Edge Detection";
 }
 
 bool EdgeDetectionFilter::configure(const std::map<std::string, double>& params) {
+    std::shared_ptr<const Settings> current = snapshot();
+    double threshold1 = current->threshold1;
+    double threshold2 = current->threshold2;
+    int apertureSize = current->apertureSize;
+    bool fused = current->fused;
     bool changed = false;
     
     if (params.count("threshold1")) {
@@ -75,6 +996,98 @@ bool EdgeDetectionFilter::configure(const std::map<std::string, double>& params)
             changed = true;
         }
     }
+
+    if (params.count("fused")) {
+        fused = params.at("fused") != 0;
+        changed = true;
+    }
     
+    if (changed) {
+        publish(threshold1, threshold2, apertureSize, fused);
+        markParametersChanged();
+    }
+
     return changed;
+}
+
+EdgeDetectionFilter::Isa EdgeDetectionFilter::bestIsa() {
+    static const Isa best = [] {
+        if (isAvailable(Isa::Avx2)) {
+            return Isa::Avx2;
+        }
+        if (isAvailable(Isa::Sse41)) {
+            return Isa::Sse41;
+        }
+        if (isAvailable(Isa::Neon)) {
+            return Isa::Neon;
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+
+bool EdgeDetectionFilter::isAvailable(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#ifdef SIMD_X86
+        case Isa::Sse41:
+            return cv::checkHardwareSupport(CV_CPU_SSE4_1);
+        case Isa::Avx2:
+            return cv::checkHardwareSupport(CV_CPU_AVX2);
+#endif
+#ifdef SIMD_NEON
+        case Isa::Neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* EdgeDetectionFilter::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Sse41:
+            return "SSE4.1";
+        case Isa::Avx2:
+            return "AVX2";
+        case Isa::Neon:
+            return "NEON";
+        default:
+            return "scalar";
+    }
+}
+
+bool EdgeDetectionFilter::usesFusedDetector(const cv::Mat& frame, const Settings& current) {
+    int channels = frame.channels();
+    return current.fused && current.apertureSize == 3 && frame.depth() == CV_8U &&
+           (channels == 1 || channels == 3);
+}
+
+std::shared_ptr<const EdgeDetectionFilter::Settings> EdgeDetectionFilter::snapshot() const {
+    return std::atomic_load(&settings);
+}
+
+void EdgeDetectionFilter::publish(double threshold1, double threshold2, int apertureSize, bool fused) {
+    auto next = std::make_shared<Settings>();
+    next->threshold1 = threshold1;
+    next->threshold2 = threshold2;
+    next->apertureSize = apertureSize;
+    next->fused = fused;
+    std::atomic_store(&settings, std::shared_ptr<const Settings>(std::move(next)));
+}
+
+std::unique_ptr<EdgeDetectionFilter::Scratch> EdgeDetectionFilter::acquireScratch() {
+    std::lock_guard<std::mutex> lock(scratchMutex);
+    if (freeScratch.empty()) {
+        return std::unique_ptr<Scratch>(new Scratch());
+    }
+    std::unique_ptr<Scratch> scratch = std::move(freeScratch.back());
+    freeScratch.pop_back();
+    return scratch;
+}
+
+void EdgeDetectionFilter::releaseScratch(std::unique_ptr<Scratch> scratch) {
+    std::lock_guard<std::mutex> lock(scratchMutex);
+    freeScratch.push_back(std::move(scratch));
 }
\ No newline at end of file
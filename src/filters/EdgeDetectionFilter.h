@@ -1,14 +1,39 @@
 #pragma once
 
 #include "Filter.h"
+#include <memory>
+#include <mutex>
+#include <vector>
 
 /**
  * @brief Applies edge detection to video frames
  * 
  * This filter detects edges in the image using the Canny edge detector.
+ *
+ * With the default 3x3 aperture on 8-bit gray or BGR frames it runs a
+ * fused detector: the grayscale conversion, Sobel gradients and
+ * non-maximum suppression are done row by row in one pass, hysteresis
+ * works on scratch buffers owned by the filter, and the edge map is
+ * written straight into the output, as BGR or (when the next filter
+ * accepts it) as a single channel. Other settings, or "fused" = 0, use
+ * cv::cvtColor and cv::Canny.
+ *
+ * The parameters form one immutable snapshot that configure() replaces
+ * atomically. A frame reads a single snapshot, so the detector it picks
+ * and the thresholds it uses never mix old and new settings.
  */
 class EdgeDetectionFilter : public Filter {
 public:
+    /**
+     * @brief Instruction set used by the fused detector's row kernels
+     */
+    enum class Isa {
+        Scalar,
+        Sse41,
+        Avx2,
+        Neon
+    };
+
     /**
      * @brief Construct with default parameters
      */
@@ -22,6 +47,11 @@ public:
      * @param apertureSize Aperture size for the Sobel operator
      */
     EdgeDetectionFilter(double threshold1, double threshold2, int apertureSize);
+
+    /**
+     * @brief Destructor
+     */
+    ~EdgeDetectionFilter() override;
     
     /**
      * @brief Apply edge detection to a frame
@@ -31,6 +61,50 @@ public:
      * @return true if processing was successful, false otherwise
      */
     bool apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) override;
+
+    /**
+     * @brief Apply edge detection with a specific instruction set
+     *
+     * Settings that do not use the fused detector ignore the instruction set.
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame after processing
+     * @param isa Instruction set; must be available on this CPU
+     * @return false if processing failed or the instruction set is not available
+     */
+    bool apply(const cv::Mat& inputFrame, cv::Mat& outputFrame, Isa isa);
+
+    /**
+     * @brief Apply edge detection, leaving the edge map single-channel
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The single-channel edge map
+     * @return true if processing was successful, false otherwise
+     */
+    bool applyAllowingGray(const cv::Mat& inputFrame, cv::Mat& outputFrame) override;
+
+    /**
+     * @brief Apply edge detection with gradients and output split into tiles
+     *
+     * Only the hysteresis step, which follows edges across the frame, runs
+     * on the calling thread. Settings that do not use the fused detector
+     * run on the calling thread entirely.
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame after processing
+     * @param tiles Executor that runs the tiles
+     * @param allowGray True to leave the edge map single-channel
+     * @return true if processing was successful, false otherwise
+     */
+    bool applyTiled(const cv::Mat& inputFrame, cv::Mat& outputFrame, TileExecutor& tiles,
+                    bool allowGray) override;
+
+    /**
+     * @brief Edge detection works on grayscale frames directly
+     *
+     * @return true
+     */
+    bool acceptsGrayInput() const override;
     
     /**
      * @brief Get the name of the filter
@@ -47,8 +121,58 @@ public:
      */
     bool configure(const std::map<std::string, double>& params) override;
 
+    /**
+     * @brief Get the fastest instruction set supported by this CPU
+     *
+     * @return Instruction set chosen by apply()
+     */
+    static Isa bestIsa();
+
+    /**
+     * @brief Check whether an instruction set can be used on this CPU
+     *
+     * @param isa Instruction set to check
+     * @return true if it is compiled in and supported at runtime
+     */
+    static bool isAvailable(Isa isa);
+
+    /**
+     * @brief Get a printable name for an instruction set
+     *
+     * @param isa Instruction set
+     * @return Name such as "SSE4.1"
+     */
+    static const char* isaName(Isa isa);
+
 private:
-    double threshold1;    ///< First threshold for hysteresis procedure
-    double threshold2;    ///< Second threshold for hysteresis procedure
-    int apertureSize;     ///< Aperture size for Sobel operator
+    struct Scratch;
+
+    // Never modified after it is published
+    struct Settings {
+        double threshold1;    ///< First threshold for hysteresis procedure
+        double threshold2;    ///< Second threshold for hysteresis procedure
+        int apertureSize;     ///< Aperture size for Sobel operator
+        bool fused;           ///< Use the fused detector when the frame allows it
+    };
+
+    // Read and replaced with std::atomic_load / std::atomic_store only
+    std::shared_ptr<const Settings> settings;
+
+    // Worker threads share the filter, so each call checks out its own
+    // scratch; buffers are kept for reuse on later frames
+    std::mutex scratchMutex;
+    std::vector<std::unique_ptr<Scratch>> freeScratch;
+
+    // Run the detector; grayOutput leaves the edge map single-channel
+    bool detect(const cv::Mat& inputFrame, cv::Mat& outputFrame, bool grayOutput, Isa isa,
+                const Settings& current);
+
+    // Check whether the fused detector handles this frame with these settings
+    static bool usesFusedDetector(const cv::Mat& frame, const Settings& current);
+
+    std::shared_ptr<const Settings> snapshot() const;
+    void publish(double threshold1, double threshold2, int apertureSize, bool fused);
+
+    std::unique_ptr<Scratch> acquireScratch();
+    void releaseScratch(std::unique_ptr<Scratch> scratch);
 };
\ No newline at end of file
@@ -1,8 +1,14 @@
 #pragma once
 
 #include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include <string>
 
+class TileExecutor;
+
 /**
  * @brief Abstract base class for all video filters
  * 
@@ -12,6 +18,15 @@
  */
 class Filter {
 public:
+    /**
+     * @brief How a filter reads its input, used to fuse filter chains
+     */
+    enum class AccessPattern {
+        Point,      ///< Each output pixel depends only on the same input pixel
+        Stencil,    ///< Each output pixel depends on rows within getStencilRadius()
+        Global      ///< The output depends on the whole frame
+    };
+
     /**
      * @brief Default constructor
      */
@@ -25,12 +40,61 @@ public:
     /**
      * @brief Apply the filter to a frame
      * 
+     * The output frame may already hold a reusable buffer of the right size.
+     * Implementations should write into it (e.g. with copyTo or as the
+     * destination of an OpenCV call) rather than make it share the data of
+     * the input frame.
+     * 
      * @param inputFrame The input frame to process
      * @param outputFrame The output frame after processing
      * @return true if processing was successful, false otherwise
      */
     virtual bool apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) = 0;
-    
+
+    /**
+     * @brief Apply the filter when the consumer accepts a grayscale result
+     *
+     * Called instead of apply() when the next filter in the chain reports
+     * acceptsGrayInput(). Filters whose result is naturally single-channel
+     * override this to skip expanding it back to the input's channel count.
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame; may be left single-channel
+     * @return true if processing was successful, false otherwise
+     */
+    virtual bool applyAllowingGray(const cv::Mat& inputFrame, cv::Mat& outputFrame) {
+        return apply(inputFrame, outputFrame);
+    }
+
+    /**
+     * @brief Apply the filter with its work split into horizontal tiles
+     *
+     * Used when one frame should finish sooner rather than many frames
+     * being filtered at once. Point and stencil filters are tiled by the
+     * caller (see FilterChainPlan); global filters that can split part of
+     * their work override this. The default runs apply() or
+     * applyAllowingGray() on the calling thread.
+     *
+     * @param inputFrame The input frame to process
+     * @param outputFrame The output frame after processing
+     * @param tiles Executor that runs the tiles
+     * @param allowGray True if the result may be left single-channel
+     * @return true if processing was successful, false otherwise
+     */
+    virtual bool applyTiled(const cv::Mat& inputFrame, cv::Mat& outputFrame, TileExecutor& tiles,
+                            bool allowGray) {
+        return allowGray ? applyAllowingGray(inputFrame, outputFrame) : apply(inputFrame, outputFrame);
+    }
+
+    /**
+     * @brief Check whether the filter takes 8-bit single-channel frames
+     *
+     * @return true if apply() handles grayscale input
+     */
+    virtual bool acceptsGrayInput() const {
+        return false;
+    }
+
     /**
      * @brief Get the name of the filter
      * 
@@ -48,13 +112,132 @@ public:
         return false; // Default implementation does nothing
     }
     
+    /**
+     * @brief Get how the filter reads its input
+     *
+     * Point and stencil filters let the video processor fuse neighbouring
+     * filters into fewer passes over the frame (see FilterChainPlan).
+     * Stencil filters must produce correct rows from a horizontal band of
+     * the frame that carries getStencilRadius() extra rows on each side.
+     *
+     * @return Access pattern; Global unless overridden
+     */
+    virtual AccessPattern getAccessPattern() const {
+        return AccessPattern::Global;
+    }
+
+    /**
+     * @brief Get the number of rows above and below that an output row reads
+     *
+     * @return Stencil radius in rows; only used for Stencil filters
+     */
+    virtual int getStencilRadius() const {
+        return 0;
+    }
+
+    /**
+     * @brief Apply a point filter to a run of pixels
+     *
+     * Only called for filters whose access pattern is Point, with input and
+     * output either identical or not overlapping. Must give the same result
+     * as apply() does for those pixels.
+     *
+     * @param input Interleaved 8-bit input pixels
+     * @param output Interleaved 8-bit output pixels
+     * @param pixels Number of pixels
+     * @param channels Channels per pixel
+     */
+    virtual void applyToRow(const uchar* input, uchar* output, int pixels, int channels) {
+        if (input != output) {
+            std::copy(input, input + static_cast<size_t>(pixels) * channels, output);
+        }
+    }
+
+    /**
+     * @brief Check whether the filter gives the same look at any resolution
+     *
+     * Such a filter can run on a downscaled frame unchanged when the video
+     * processor lowers the working resolution under load. Point filters
+     * are; filters whose parameters are measured in pixels are not and
+     * should provide createScaled() instead.
+     *
+     * @return true by default for Point filters
+     */
+    virtual bool isResolutionInvariant() const {
+        return getAccessPattern() == AccessPattern::Point;
+    }
+
+    /**
+     * @brief Create a copy of the filter for frames scaled by a factor
+     *
+     * The copy's pixel-sized parameters are scaled so that its result,
+     * upscaled again, approximates this filter's result at full resolution.
+     *
+     * @param scale Factor the frame dimensions were scaled by, in (0, 1]
+     * @return Scaled copy, or nullptr if the filter cannot be scaled
+     */
+    virtual std::shared_ptr<Filter> createScaled(double scale) const {
+        return nullptr;
+    }
+
+    /**
+     * @brief Create a copy that keeps the current parameters
+     *
+     * Execution plans run Stencil filters through such a copy, so the halo
+     * they reserve from getStencilRadius() matches the stencil used even
+     * when configure() is called while a frame is being filtered. The plan
+     * is rebuilt, with a new copy, once the parameter version changes.
+     *
+     * @return Copy, or nullptr if the filter's radius cannot change
+     */
+    virtual std::shared_ptr<Filter> createFrozen() const {
+        return nullptr;
+    }
+
+    /**
+     * @brief Get a counter that changes whenever the filter's output may change
+     *
+     * Bumped by configure() and setEnabled(), so cached execution plans
+     * know when to rebuild.
+     *
+     * @return Parameter version
+     */
+    uint64_t getParameterVersion() const {
+        return parameterVersion.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Get a number that identifies this filter object for the whole run
+     *
+     * Unlike the object's address it is never reused, so it can key
+     * cached results together with getParameterVersion().
+     *
+     * @return Instance id, unique within the process
+     */
+    uint64_t getInstanceId() const {
+        return instanceId;
+    }
+
+    /**
+     * @brief Check whether the filter can process frames independently
+     *
+     * Filters that carry state from one frame to the next must return false,
+     * which makes the video processor run the whole chain serially in frame
+     * order instead of spreading frames across its worker threads.
+     *
+     * @return true if frames may be filtered concurrently and out of order
+     */
+    virtual bool isStateless() const {
+        return true;
+    }
+
     /**
      * @brief Check if the filter is enabled
      * 
      * @return true if the filter is enabled, false otherwise
      */
     bool isEnabled() const {
-        return enabled;
+        return enabled.load(std::memory_order_acquire);
     }
     
     /**
@@ -63,9 +246,23 @@ public:
      * @param state True to enable, false to disable
      */
     void setEnabled(bool state) {
-        enabled = state;
+        enabled.store(state, std::memory_order_release);
+        markParametersChanged();
     }
 
 protected:
-    bool enabled = true;
+    std::atomic<bool> enabled{true};
+
+    /**
+     * @brief Record a parameter change; call from configure() when it changes anything
+     */
+    void markParametersChanged() {
+        parameterVersion.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+private:
+    std::atomic<uint64_t> parameterVersion{0};
+    const uint64_t instanceId = nextInstanceId.fetch_add(1, std::memory_order_relaxed);
+
+    static inline std::atomic<uint64_t> nextInstanceId{1};
 };
\ No newline at end of file
@@ -0,0 +1,316 @@
+#include "FilterChainPlan.h"
+#include <algorithm>
+
+namespace {
+
+// Run one filter over a band; point filters go through their row interface
+void applyToBand(Filter& filter, const cv::Mat& input, cv::Mat& output) {
+    if (filter.getAccessPattern() != Filter::AccessPattern::Point) {
+        filter.apply(input, output);
+        return;
+    }
+
+    output.create(input.size(), input.type());
+    for (int y = 0; y < input.rows; ++y) {
+        filter.applyToRow(input.ptr(y), output.ptr(y), input.cols, input.channels());
+    }
+}
+
+// SplitMix64 finaliser; spreads every input bit over the whole key
+uint64_t mix(uint64_t value) {
+    value += 0x9e3779b97f4a7c15ULL;
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
+
+}  // namespace
+
+bool FilterChainPlan::matches(const std::vector<std::shared_ptr<Filter>>& chain) const {
+    if (chain.size() != signature.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < chain.size(); ++i) {
+        const Signature& entry = signature[i];
+        if (chain[i] != entry.filter ||
+            chain[i]->isEnabled() != entry.enabled ||
+            chain[i]->getParameterVersion() != entry.version) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FilterChainPlan::build(const std::vector<std::shared_ptr<Filter>>& chain) {
+    // The first filter that differs from the last build is being tuned;
+    // a rebuild without changes keeps the previous one
+    for (size_t i = 0; i < chain.size() && !signature.empty(); ++i) {
+        if (i >= signature.size() || chain[i] != signature[i].filter ||
+            chain[i]->isEnabled() != signature[i].enabled ||
+            chain[i]->getParameterVersion() != signature[i].version) {
+            tunedPosition = i;
+            break;
+        }
+    }
+
+    stages.clear();
+    signature.clear();
+    tunedStage = NOT_TUNED;
+
+    uint64_t prefixHash = 0;
+    for (size_t position = 0; position < chain.size(); ++position) {
+        const std::shared_ptr<Filter>& filter = chain[position];
+
+        // Record the version first: a change made while planning forces a rebuild
+        bool enabled = filter->isEnabled();
+        uint64_t version = filter->getParameterVersion();
+        signature.push_back({filter, enabled, version});
+        if (!enabled) {
+            continue;
+        }
+        prefixHash = hashFilter(prefixHash, *filter, version);
+
+        Filter::AccessPattern pattern = filter->getAccessPattern();
+        bool global = pattern == Filter::AccessPattern::Global;
+        if (global || stages.empty() || stages.back().global) {
+            stages.emplace_back();
+            stages.back().global = global;
+        }
+
+        // A stencil's halo and kernel must come from the same parameters
+        std::shared_ptr<Filter> frozen =
+            pattern == Filter::AccessPattern::Stencil ? filter->createFrozen() : nullptr;
+        const std::shared_ptr<Filter>& runner = frozen ? frozen : filter;
+
+        Stage& stage = stages.back();
+        if (tunedStage == NOT_TUNED && tunedPosition != NOT_TUNED && position >= tunedPosition) {
+            tunedStage = stages.size() - 1;
+        }
+        stage.filters.push_back(runner);
+        stage.prefixHash = prefixHash;
+        stage.acceptsGray = stage.acceptsGray && filter->acceptsGrayInput();
+        if (pattern == Filter::AccessPattern::Stencil) {
+            stage.hasStencil = true;
+            stage.halo += std::max(0, runner->getStencilRadius());
+        }
+    }
+
+    PerformanceMonitor* monitor = recorder ? recorder->getMonitor() : nullptr;
+    if (monitor) {
+        for (Stage& stage : stages) {
+            std::string name;
+            for (const auto& filter : stage.filters) {
+                name += (name.empty() ? "" : " + ") + filter->getName();
+            }
+            stage.monitorStage = monitor->registerStage(name);
+        }
+    }
+}
+
+void FilterChainPlan::reserve(const cv::Size& size, int type) {
+    for (cv::Mat& buffer : stageBuffers) {
+        buffer.create(size, type);
+    }
+}
+
+void FilterChainPlan::setTileExecutor(TileExecutor* executor) {
+    tileExecutor = executor;
+}
+
+void FilterChainPlan::setRecorder(PerformanceMonitor::Recorder* recorder) {
+    this->recorder = recorder;
+    signature.clear();
+}
+
+void FilterChainPlan::setCache(FrameCache* frameCache) {
+    cache = frameCache;
+}
+
+uint64_t FilterChainPlan::resultKey(const std::vector<std::shared_ptr<Filter>>& chain, int frameIndex) {
+    uint64_t prefixHash = 0;
+    for (const auto& filter : chain) {
+        if (filter->isEnabled()) {
+            prefixHash = hashFilter(prefixHash, *filter, filter->getParameterVersion());
+        }
+    }
+    return frameKey(prefixHash, frameIndex);
+}
+
+uint64_t FilterChainPlan::hashFilter(uint64_t hash, const Filter& filter, uint64_t version) {
+    return mix(hash ^ mix(filter.getInstanceId()) ^ (version * 0x9e3779b97f4a7c15ULL));
+}
+
+uint64_t FilterChainPlan::frameKey(uint64_t prefixHash, int frameIndex) {
+    return mix(prefixHash + static_cast<uint64_t>(frameIndex));
+}
+
+void FilterChainPlan::execute(const cv::Mat& input, cv::Mat& output, int frameIndex) {
+    if (stages.empty()) {
+        input.copyTo(output);
+        return;
+    }
+
+    // Stages alternate between the two stage buffers, so each one reads the
+    // previous result in place; only the last stage writes to the output.
+    // A stage may hand a single-channel result to a next stage that
+    // accepts it, in which case the chain ends by expanding it once.
+    const cv::Mat* source = &input;
+    int next = 0;
+    size_t first = 0;
+
+    // Resume after the last stage whose result is cached; only a miss of
+    // the whole chain counts as a cache miss
+    bool caching = cache && frameIndex >= 0;
+    for (size_t i = stages.size(); caching && i-- > 0;) {
+        uint64_t key = frameKey(stages[i].prefixHash, frameIndex);
+        bool found = i + 1 == stages.size() ? cache->get(key, stageBuffers[0])
+                                            : cache->contains(key) && cache->get(key, stageBuffers[0]);
+        if (found) {
+            source = &stageBuffers[0];
+            next = 1;
+            first = i + 1;
+            break;
+        }
+    }
+
+    // A cached single-channel result was made for a next stage that took
+    // gray input; the chain may have changed since
+    if (first > 0 && first < stages.size() && source->channels() == 1 && input.channels() == 3 &&
+        !stages[first].acceptsGray) {
+        cv::cvtColor(*source, stageBuffers[1], cv::COLOR_GRAY2BGR);
+        source = &stageBuffers[1];
+        next = 0;
+    }
+
+    for (size_t i = first; i < stages.size(); ++i) {
+        bool last = i + 1 == stages.size();
+        bool keepsChannels = source->channels() == input.channels();
+        cv::Mat& target = (last && keepsChannels) ? output : stageBuffers[next];
+        uint64_t start = recorder ? PerformanceMonitor::now() : 0;
+        runStage(stages[i], *source, target, !last && stages[i + 1].acceptsGray);
+        if (recorder) {
+            recorder->record(stages[i].monitorStage, PerformanceMonitor::now() - start);
+        }
+        if (caching && i + 1 == tunedStage) {
+            cache->put(frameKey(stages[i].prefixHash, frameIndex), target);
+        }
+        source = &target;
+        next ^= 1;
+    }
+
+    if (source != &output) {
+        if (source->channels() == 1 && input.channels() == 3) {
+            cv::cvtColor(*source, output, cv::COLOR_GRAY2BGR);
+        } else {
+            source->copyTo(output);
+        }
+    }
+
+    // The whole chain's entry is the finished frame, after any expansion,
+    // so readers of resultKey() can pass it on as it is
+    if (caching && first < stages.size()) {
+        cache->put(frameKey(stages.back().prefixHash, frameIndex), output);
+    }
+}
+
+size_t FilterChainPlan::getStageCount() const {
+    return stages.size();
+}
+
+void FilterChainPlan::runStage(const Stage& stage, const cv::Mat& input, cv::Mat& output, bool allowGray) {
+    if (stage.global) {
+        Filter& filter = *stage.filters.front();
+        if (tileExecutor) {
+            filter.applyTiled(input, output, *tileExecutor, allowGray);
+        } else if (allowGray) {
+            filter.applyAllowingGray(input, output);
+        } else {
+            filter.apply(input, output);
+        }
+    } else if (tileExecutor) {
+        runTiles(stage, input, output);
+    } else if (stage.filters.size() == 1) {
+        // Nothing to fuse: the filter makes its own pass
+        Filter& filter = *stage.filters.front();
+        if (allowGray) {
+            filter.applyAllowingGray(input, output);
+        } else {
+            filter.apply(input, output);
+        }
+    } else if (!stage.hasStencil) {
+        output.create(input.size(), input.type());
+        runRows(stage, input, output, 0, input.rows);
+    } else {
+        runBands(stage, input, output);
+    }
+}
+
+void FilterChainPlan::runBands(const Stage& stage, const cv::Mat& input, cv::Mat& output) {
+    output.create(input.size(), input.type());
+
+    const int halo = stage.halo;
+    const size_t rowBytes = std::max<size_t>(1, input.cols * input.elemSize());
+    const int bandRows = std::max({1, 4 * halo, static_cast<int>(BAND_BYTES / rowBytes) - 2 * halo});
+    for (int first = 0; first < input.rows; first += bandRows) {
+        runBand(stage, input, output, first, std::min(input.rows, first + bandRows), bandBuffers);
+    }
+}
+
+void FilterChainPlan::runTiles(const Stage& stage, const cv::Mat& input, cv::Mat& output) {
+    output.create(input.size(), input.type());
+
+    if (!stage.hasStencil) {
+        tileExecutor->forEachTile(input.rows, [&](size_t, int first, int last) {
+            runRows(stage, input, output, first, last);
+        });
+        return;
+    }
+
+    if (tileBuffers.size() < tileExecutor->getTileCount(input.rows)) {
+        tileBuffers.resize(tileExecutor->getTileCount(input.rows));
+    }
+    tileExecutor->forEachTile(input.rows, [&](size_t tile, int first, int last) {
+        runBand(stage, input, output, first, last, tileBuffers[tile]);
+    });
+}
+
+void FilterChainPlan::runBand(const Stage& stage, const cv::Mat& input, cv::Mat& output,
+                              int first, int last, BandBuffers& buffers) {
+    const int halo = stage.halo;
+    const int top = std::max(0, first - halo);
+    const int bottom = std::min(input.rows, last + halo);
+
+    // Every filter processes the whole band including the halo; rows near
+    // an inner band edge come out wrong, but the halo is wide enough that
+    // none of them reach the rows kept from this band
+    cv::Mat band = input.rowRange(top, bottom);
+    const cv::Mat* source = &band;
+    cv::Mat views[2];
+    for (size_t i = 0; i < stage.filters.size(); ++i) {
+        // Standalone headers over the band buffers, so that filters treat
+        // the edges of the band as its borders
+        cv::Mat& buffer = buffers.buffers[i % 2];
+        if (buffer.rows < bottom - top || buffer.cols != input.cols || buffer.type() != input.type()) {
+            buffer.create(std::max(buffer.rows, bottom - top), input.cols, input.type());
+        }
+        cv::Mat& target = views[i % 2];
+        target = cv::Mat(bottom - top, input.cols, input.type(), buffer.data, buffer.step);
+        applyToBand(*stage.filters[i], *source, target);
+        source = &target;
+    }
+
+    cv::Mat rows = output.rowRange(first, last);
+    source->rowRange(first - top, last - top).copyTo(rows);
+}
+
+void FilterChainPlan::runRows(const Stage& stage, const cv::Mat& input, cv::Mat& output, int first, int last) {
+    for (int y = first; y < last; ++y) {
+        const uchar* source = input.ptr(y);
+        uchar* target = output.ptr(y);
+        for (const auto& filter : stage.filters) {
+            filter->applyToRow(source, target, input.cols, input.channels());
+            source = target;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,190 @@
+#pragma once
+
+#include "Filter.h"
+#include "../utils/TileExecutor.h"
+#include "../utils/PerformanceMonitor.h"
+#include "../utils/FrameCache.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Execution plan that fuses a filter chain into fewer frame passes
+ *
+ * Each enabled filter would otherwise read and write a full frame, so a
+ * chain of K cheap filters costs K trips through memory. The plan groups
+ * the chain by access pattern:
+ *
+ * - runs of point filters become one pass that sends each row through all
+ *   of them while it is in L1;
+ * - runs that also contain stencil filters are processed band by band:
+ *   each band of output rows is computed from the input rows it needs
+ *   (the band plus the summed stencil radii above and below) through two
+ *   band-sized buffers, so the intermediates stay in L2;
+ * - global filters run on the whole frame and split the chain.
+ *
+ * With a TileExecutor the bands become tiles of the executor's size that
+ * run in parallel, each with its own buffers, and global filters get the
+ * executor through Filter::applyTiled().
+ *
+ * With a recorder every stage is timed under the names of its filters,
+ * joined with " + " when the stage fuses several.
+ *
+ * With a cache, results are stored under the frame index and a hash of
+ * the enabled filters up to their stage and their parameter versions: the
+ * finished frame, and the input of the stage holding the filter that
+ * changed between the last two builds, i.e. the one being tuned. A frame
+ * resumes after the last cached stage, so tuning a filter only reprocesses
+ * the stages from that filter on, and a fully cached frame is a single
+ * copy. Other intermediates are not cached; copying each of them into the
+ * shared cache would cost every played frame a full-frame copy per stage.
+ *
+ * A plan is cheap to build but not thread-safe; each worker keeps its own
+ * and calls matches() before every frame to pick up chain and parameter
+ * changes.
+ */
+class FilterChainPlan {
+public:
+    /**
+     * @brief Check whether the plan was built for this chain as it is now
+     *
+     * Compares the filters, their enabled state and their parameter versions.
+     *
+     * @param chain Filter chain
+     * @return true if the plan is up to date
+     */
+    bool matches(const std::vector<std::shared_ptr<Filter>>& chain) const;
+
+    /**
+     * @brief Rebuild the plan for a chain
+     *
+     * @param chain Filter chain; disabled filters are left out
+     */
+    void build(const std::vector<std::shared_ptr<Filter>>& chain);
+
+    /**
+     * @brief Preallocate the full-frame intermediate buffers
+     *
+     * @param size Frame size
+     * @param type Frame type
+     */
+    void reserve(const cv::Size& size, int type);
+
+    /**
+     * @brief Split every stage into tiles that run in parallel
+     *
+     * @param executor Executor to use, or nullptr to run on the calling thread
+     */
+    void setTileExecutor(TileExecutor* executor);
+
+    /**
+     * @brief Record the latency of every stage
+     *
+     * Forces a rebuild, which registers the stage names with the
+     * recorder's monitor.
+     *
+     * @param recorder Recorder of the calling thread, or nullptr to stop timing
+     */
+    void setRecorder(PerformanceMonitor::Recorder* recorder);
+
+    /**
+     * @brief Store stage results in a cache shared with other plans
+     *
+     * @param cache Cache to use, or nullptr to cache nothing
+     */
+    void setCache(FrameCache* cache);
+
+    /**
+     * @brief Run the planned chain on a frame
+     *
+     * The output has the input's channel count, even if the chain passes
+     * grayscale frames between filters.
+     *
+     * @param input Input frame
+     * @param output Output frame; must not share data with the input
+     * @param frameIndex Position of the frame in its video, used as part of
+     *                   the cache keys; -1 bypasses the cache
+     */
+    void execute(const cv::Mat& input, cv::Mat& output, int frameIndex = -1);
+
+    /**
+     * @brief Get the cache key of a frame's result after the whole chain
+     *
+     * Matches the key execute() stores the finished output under, with
+     * the input's channel count, so a frame whose result is cached need
+     * not even be decoded.
+     *
+     * @param chain Filter chain
+     * @param frameIndex Position of the frame in its video
+     * @return Cache key
+     */
+    static uint64_t resultKey(const std::vector<std::shared_ptr<Filter>>& chain, int frameIndex);
+
+    /**
+     * @brief Get the number of passes over the full frame
+     *
+     * @return Number of planned stages
+     */
+    size_t getStageCount() const;
+
+private:
+    // Target size of one band buffer, small enough for two to stay in L2
+    static constexpr size_t BAND_BYTES = 256 * 1024;
+
+    struct Stage {
+        std::vector<std::shared_ptr<Filter>> filters;
+        bool global = false;        ///< A single global filter
+        bool hasStencil = false;    ///< Needs banding rather than a row pass
+        int halo = 0;               ///< Summed stencil radii
+        bool acceptsGray = true;    ///< Every filter takes grayscale input
+        size_t monitorStage = PerformanceMonitor::NO_STAGE; ///< Stage id for the recorder
+        uint64_t prefixHash = 0;    ///< Hash of the enabled filters up to this stage
+    };
+
+    struct Signature {
+        std::shared_ptr<Filter> filter;
+        bool enabled;
+        uint64_t version;
+    };
+
+    static constexpr size_t NOT_TUNED = static_cast<size_t>(-1);
+
+    // Intermediates of one band
+    struct BandBuffers {
+        cv::Mat buffers[2];
+    };
+
+    std::vector<Stage> stages;
+    std::vector<Signature> signature;
+    size_t tunedPosition = NOT_TUNED;   ///< Chain position of the last filter that changed
+    size_t tunedStage = NOT_TUNED;      ///< Stage whose input is cached
+    TileExecutor* tileExecutor = nullptr;
+    PerformanceMonitor::Recorder* recorder = nullptr;
+    FrameCache* cache = nullptr;
+
+    // Full-frame results of consecutive stages, and band intermediates for
+    // the serial path and for every tile
+    cv::Mat stageBuffers[2];
+    BandBuffers bandBuffers;
+    std::vector<BandBuffers> tileBuffers;
+
+    // Fold a filter's identity and parameter version into a prefix hash
+    static uint64_t hashFilter(uint64_t hash, const Filter& filter, uint64_t version);
+
+    // Cache key of a stage result for a frame
+    static uint64_t frameKey(uint64_t prefixHash, int frameIndex);
+
+    void runStage(const Stage& stage, const cv::Mat& input, cv::Mat& output, bool allowGray);
+
+    // A stage with stencil filters, one band of output rows at a time
+    void runBands(const Stage& stage, const cv::Mat& input, cv::Mat& output);
+
+    // A stage that is not global, split into tiles on the executor
+    void runTiles(const Stage& stage, const cv::Mat& input, cv::Mat& output);
+
+    // Output rows [first, last) of a stage with stencil filters
+    static void runBand(const Stage& stage, const cv::Mat& input, cv::Mat& output,
+                        int first, int last, BandBuffers& buffers);
+
+    // Output rows [first, last) of a point-only stage
+    static void runRows(const Stage& stage, const cv::Mat& input, cv::Mat& output, int first, int last);
+};
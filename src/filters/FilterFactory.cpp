@@ -0,0 +1,83 @@
+#include "FilterFactory.h"
+#include "GaussianBlurFilter.h"
+#include "EdgeDetectionFilter.h"
+#include "ColorEnhanceFilter.h"
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::vector<std::string> split(const std::string& text, char separator) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, separator)) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+}  // namespace
+
+std::shared_ptr<Filter> FilterFactory::create(const std::string& spec) {
+    std::vector<std::string> parts = split(spec, ':');
+    if (parts.empty()) {
+        std::cerr << "Error: Empty filter spec." << std::endl;
+        return nullptr;
+    }
+
+    std::shared_ptr<Filter> filter;
+    const std::string& name = parts[0];
+    if (name == "blur" || name == "gaussian") {
+        filter = std::make_shared<GaussianBlurFilter>();
+    } else if (name == "edge" || name == "canny") {
+        filter = std::make_shared<EdgeDetectionFilter>();
+    } else if (name == "enhance" || name == "color") {
+        filter = std::make_shared<ColorEnhanceFilter>();
+    } else {
+        std::cerr << "Error: Unknown filter '" << name << "'. Available: "
+                  << availableFilters() << std::endl;
+        return nullptr;
+    }
+
+    // Remaining parts are key=value parameters
+    std::map<std::string, double> params;
+    for (size_t i = 1; i < parts.size(); ++i) {
+        size_t equals = parts[i].find('=');
+        if (equals == std::string::npos) {
+            std::cerr << "Error: Expected key=value in filter spec: " << parts[i] << std::endl;
+            return nullptr;
+        }
+
+        try {
+            params[parts[i].substr(0, equals)] = std::stod(parts[i].substr(equals + 1));
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid number in filter spec: " << parts[i] << std::endl;
+            return nullptr;
+        }
+    }
+
+    if (!params.empty() && !filter->configure(params)) {
+        std::cerr << "Error: Filter '" << name << "' rejected parameters: " << spec << std::endl;
+        return nullptr;
+    }
+
+    return filter;
+}
+
+bool FilterFactory::createChain(const std::string& spec, std::vector<std::shared_ptr<Filter>>& chain) {
+    for (const std::string& filterSpec : split(spec, ',')) {
+        std::shared_ptr<Filter> filter = create(filterSpec);
+        if (!filter) {
+            return false;
+        }
+        chain.push_back(filter);
+    }
+    return true;
+}
+
+std::string FilterFactory::availableFilters() {
+    return "blur (gaussian), edge (canny), enhance (color)";
+}
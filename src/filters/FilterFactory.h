@@ -0,0 +1,41 @@
+#pragma once
+
+#include "Filter.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Creates filters from short text specifications
+ *
+ * A filter spec is a filter name optionally followed by colon-separated
+ * parameters, e.g. "blur:kernelSize=7:sigmaX=2". A chain spec is a
+ * comma-separated list of filter specs, e.g. "blur:kernelSize=7,edge".
+ * Parameters are passed to Filter::configure.
+ */
+class FilterFactory {
+public:
+    /**
+     * @brief Create a single filter
+     *
+     * @param spec Filter spec
+     * @return The configured filter, or nullptr if the spec is invalid
+     */
+    static std::shared_ptr<Filter> create(const std::string& spec);
+
+    /**
+     * @brief Create a chain of filters
+     *
+     * @param spec Chain spec
+     * @param chain Receives the filters in order
+     * @return true if every filter in the spec was created
+     */
+    static bool createChain(const std::string& spec, std::vector<std::shared_ptr<Filter>>& chain);
+
+    /**
+     * @brief Get the filter names understood by create()
+     *
+     * @return Comma-separated list of names
+     */
+    static std::string availableFilters();
+};
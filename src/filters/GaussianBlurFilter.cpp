@@ -1,35 +1,46 @@
 #include "GaussianBlurFilter.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
-GaussianBlurFilter::GaussianBlurFilter()
-    : kernelSize(5), sigmaX(1.5), sigmaY(1.5) {
+GaussianBlurFilter::GaussianBlurFilter() {
+    publish(5, 1.5, 1.5);
 }
 
-GaussianBlurFilter::GaussianBlurFilter(int kernelSize, double sigmaX, double sigmaY)
-    : kernelSize(kernelSize), sigmaX(sigmaX), sigmaY(sigmaY) {
+GaussianBlurFilter::GaussianBlurFilter(int kernelSize, double sigmaX, double sigmaY) {
     // Ensure kernel size is odd
     if (kernelSize % 2 == 0) {
-        this->kernelSize = kernelSize + 1;
+        kernelSize++;
         std::cout << "Warning: Kernel size must be odd. Adjusted to "
-                  << this->kernelSize << std::endl;
+                  << kernelSize << std::endl;
     }
+    publish(kernelSize, sigmaX, sigmaY);
+}
+
+GaussianBlurFilter::GaussianBlurFilter(std::shared_ptr<const Settings> frozenSettings)
+    : settings(std::move(frozenSettings)) {
 }
 
 bool GaussianBlurFilter::apply(const cv::Mat& inputFrame, cv::Mat& outputFrame) {
     if (!isEnabled() || inputFrame.empty()) {
-        outputFrame = inputFrame.clone();
+        inputFrame.copyTo(outputFrame);
         return false;
     }
 
+    std::shared_ptr<const Settings> current = snapshot();
     try {
-        // Apply Gaussian blur
+        if (current->blur.apply(inputFrame, outputFrame)) {
+            return true;
+        }
+
+        // Unsupported depth, tiny frame or in-place call
         cv::GaussianBlur(inputFrame, outputFrame,
-                         cv::Size(kernelSize, kernelSize),
-                         sigmaX, sigmaY);
+                         cv::Size(current->kernelSize, current->kernelSize),
+                         current->sigmaX, current->sigmaY);
         return true;
     } catch (const cv::Exception& e) {
         std::cerr << "Error in GaussianBlurFilter: " << e.what() << std::endl;
-        outputFrame = inputFrame.clone();
+        inputFrame.copyTo(outputFrame);
         return false;
     }
 }
@@ -39,6 +50,10 @@ std::string GaussianBlurFilter::getName() const {
 }
 
 bool GaussianBlurFilter::configure(const std::map<std::string, double>& params) {
+    std::shared_ptr<const Settings> current = snapshot();
+    int kernelSize = current->kernelSize;
+    double sigmaX = current->sigmaX;
+    double sigmaY = current->sigmaY;
     bool changed = false;
 
     if (params.count("kernelSize")) {
@@ -67,5 +82,51 @@ bool GaussianBlurFilter::configure(const std::map<std::string, double>& params)
         }
     }
 
+    if (changed) {
+        publish(kernelSize, sigmaX, sigmaY);
+        markParametersChanged();
+    }
+
     return changed;
-}
\ No newline at end of file
+}
+
+bool GaussianBlurFilter::acceptsGrayInput() const {
+    return true;
+}
+
+Filter::AccessPattern GaussianBlurFilter::getAccessPattern() const {
+    return AccessPattern::Stencil;
+}
+
+int GaussianBlurFilter::getStencilRadius() const {
+    return snapshot()->kernelSize / 2;
+}
+
+std::shared_ptr<Filter> GaussianBlurFilter::createScaled(double scale) const {
+    std::shared_ptr<const Settings> current = snapshot();
+    int scaledSize = std::max(1, static_cast<int>(std::lround(current->kernelSize * scale)) | 1);
+    auto scaled = std::make_shared<GaussianBlurFilter>(scaledSize, current->sigmaX * scale,
+                                                       current->sigmaY * scale);
+    scaled->setEnabled(isEnabled());
+    return scaled;
+}
+
+std::shared_ptr<Filter> GaussianBlurFilter::createFrozen() const {
+    // The kernels are shared, not rebuilt
+    std::shared_ptr<GaussianBlurFilter> frozen(new GaussianBlurFilter(snapshot()));
+    frozen->setEnabled(isEnabled());
+    return frozen;
+}
+
+std::shared_ptr<const GaussianBlurFilter::Settings> GaussianBlurFilter::snapshot() const {
+    return std::atomic_load(&settings);
+}
+
+void GaussianBlurFilter::publish(int kernelSize, double sigmaX, double sigmaY) {
+    auto next = std::make_shared<Settings>();
+    next->kernelSize = kernelSize;
+    next->sigmaX = sigmaX;
+    next->sigmaY = sigmaY;
+    next->blur.configure(kernelSize, sigmaX, sigmaY);
+    std::atomic_store(&settings, std::shared_ptr<const Settings>(std::move(next)));
+}
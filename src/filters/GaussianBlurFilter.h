@@ -1,12 +1,20 @@
 #pragma once
 
 #include "Filter.h"
+#include "SeparableBlur.h"
 
 /**
  * @brief Applies Gaussian blur to video frames
  * 
  * This filter smooths the image using a Gaussian filter with configurable
- * kernel size and sigma values.
+ * kernel size and sigma values. 8-bit frames go through the in-tree
+ * fixed-point SeparableBlur, whose kernels are rebuilt only when the
+ * parameters change; anything else falls back to cv::GaussianBlur.
+ *
+ * The parameters and their kernels form one immutable snapshot that
+ * configure() replaces atomically. A frame, the stencil radius reported
+ * for it and scaled copies each read a single snapshot, so they never mix
+ * old and new settings.
  */
 class GaussianBlurFilter : public Filter {
 public:
@@ -48,8 +56,60 @@ public:
      */
     bool configure(const std::map<std::string, double>& params) override;
 
+    /**
+     * @brief Blur works on any channel count
+     *
+     * @return true
+     */
+    bool acceptsGrayInput() const override;
+
+    /**
+     * @brief Blur reads a kernelSize x kernelSize neighbourhood
+     *
+     * @return AccessPattern::Stencil
+     */
+    AccessPattern getAccessPattern() const override;
+
+    /**
+     * @brief Get the vertical reach of the kernel
+     *
+     * @return kernelSize / 2
+     */
+    int getStencilRadius() const override;
+
+    /**
+     * @brief Create a blur for a downscaled frame
+     *
+     * Sigma and kernel size shrink with the frame, so the blur covers the
+     * same part of the picture.
+     *
+     * @param scale Factor the frame dimensions were scaled by
+     * @return Blur with scaled parameters and the same enabled state
+     */
+    std::shared_ptr<Filter> createScaled(double scale) const override;
+
+    /**
+     * @brief Create a blur that shares the current snapshot
+     *
+     * @return Copy whose parameters configure() on this filter does not change
+     */
+    std::shared_ptr<Filter> createFrozen() const override;
+
 private:
-    int kernelSize;     ///< Size of the Gaussian kernel
-    double sigmaX;      ///< Sigma value for X direction
-    double sigmaY;      ///< Sigma value for Y direction
+    // Never modified after it is published
+    struct Settings {
+        int kernelSize;     ///< Size of the Gaussian kernel
+        double sigmaX;      ///< Sigma value for X direction
+        double sigmaY;      ///< Sigma value for Y direction
+        SeparableBlur blur; ///< Quantized kernels for these parameters
+    };
+
+    // Read and replaced with std::atomic_load / std::atomic_store only
+    std::shared_ptr<const Settings> settings;
+
+    // Share an existing snapshot, for createFrozen()
+    explicit GaussianBlurFilter(std::shared_ptr<const Settings> frozenSettings);
+
+    std::shared_ptr<const Settings> snapshot() const;
+    void publish(int kernelSize, double sigmaX, double sigmaY);
 };
\ No newline at end of file
@@ -0,0 +1,410 @@
+#include "SeparableBlur.h"
+#include "../utils/Simd.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+const int HORIZONTAL_SHIFT = 8;
+const int VERTICAL_SHIFT = 15;
+const int OUTPUT_SHIFT = HORIZONTAL_SHIFT + VERTICAL_SHIFT;
+const uint32_t OUTPUT_ROUNDING = 1u << (OUTPUT_SHIFT - 1);
+
+// Largest supported kernel; bounds the per-call row pointer arrays
+const int MAX_TAPS = 63;
+
+// Row kernels work on interleaved elements (pixels * channels).
+// horizontal: out[i] = sum_k src[i + k * channels] * weights[k], where src
+//             points at a row padded by radius pixels on each side
+// vertical:   out[i] = (sum_k rows[k][i] * weights[k] + rounding) >> 23
+using HorizontalKernel = void (*)(const uint8_t* src, uint16_t* out, int count, int channels,
+                                  const uint16_t* weights, int taps);
+using VerticalKernel = void (*)(const uint16_t* const* rows, uint8_t* out, int count,
+                                const uint16_t* weights, int taps);
+
+void horizontalScalar(const uint8_t* src, uint16_t* out, int count, int channels,
+                      const uint16_t* weights, int taps) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t sum = 0;
+        for (int k = 0; k < taps; ++k) {
+            sum += src[i + k * channels] * weights[k];
+        }
+        out[i] = static_cast<uint16_t>(sum);
+    }
+}
+
+void verticalScalar(const uint16_t* const* rows, uint8_t* out, int count,
+                    const uint16_t* weights, int taps) {
+    for (int i = 0; i < count; ++i) {
+        uint32_t sum = OUTPUT_ROUNDING;
+        for (int k = 0; k < taps; ++k) {
+            sum += static_cast<uint32_t>(rows[k][i]) * weights[k];
+        }
+        out[i] = static_cast<uint8_t>(sum >> OUTPUT_SHIFT);
+    }
+}
+
+#ifdef SIMD_X86
+
+// The horizontal sums fit in 16 bits (255 * 256), so plain 16-bit
+// multiply-adds are exact
+SIMD_TARGET("sse4.1")
+void horizontalSse41(const uint8_t* src, uint16_t* out, int count, int channels,
+                     const uint16_t* weights, int taps) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i sum = _mm_setzero_si128();
+        for (int k = 0; k < taps; ++k) {
+            __m128i pixels = _mm_cvtepu8_epi16(
+                _mm_loadl_epi64(reinterpret_cast<const __m128i*>(src + i + k * channels)));
+            sum = _mm_add_epi16(sum, _mm_mullo_epi16(pixels, _mm_set1_epi16(static_cast<short>(weights[k]))));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), sum);
+    }
+    horizontalScalar(src + i, out + i, count - i, channels, weights, taps);
+}
+
+// 16x16 -> 32-bit products are rebuilt from the low and high halves
+SIMD_TARGET("sse4.1")
+void verticalSse41(const uint16_t* const* rows, uint8_t* out, int count,
+                   const uint16_t* weights, int taps) {
+    const __m128i rounding = _mm_set1_epi32(static_cast<int>(OUTPUT_ROUNDING));
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i low = rounding;
+        __m128i high = rounding;
+        for (int k = 0; k < taps; ++k) {
+            __m128i values = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rows[k] + i));
+            __m128i weight = _mm_set1_epi16(static_cast<short>(weights[k]));
+            __m128i productLow = _mm_mullo_epi16(values, weight);
+            __m128i productHigh = _mm_mulhi_epu16(values, weight);
+            low = _mm_add_epi32(low, _mm_unpacklo_epi16(productLow, productHigh));
+            high = _mm_add_epi32(high, _mm_unpackhi_epi16(productLow, productHigh));
+        }
+        __m128i result = _mm_packus_epi32(_mm_srli_epi32(low, OUTPUT_SHIFT),
+                                          _mm_srli_epi32(high, OUTPUT_SHIFT));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm_packus_epi16(result, result));
+    }
+    if (i < count) {
+        const uint16_t* shifted[MAX_TAPS];
+        for (int k = 0; k < taps; ++k) {
+            shifted[k] = rows[k] + i;
+        }
+        verticalScalar(shifted, out + i, count - i, weights, taps);
+    }
+}
+
+SIMD_TARGET("avx2")
+void horizontalAvx2(const uint8_t* src, uint16_t* out, int count, int channels,
+                    const uint16_t* weights, int taps) {
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i sum = _mm256_setzero_si256();
+        for (int k = 0; k < taps; ++k) {
+            __m256i pixels = _mm256_cvtepu8_epi16(
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + k * channels)));
+            sum = _mm256_add_epi16(sum, _mm256_mullo_epi16(pixels, _mm256_set1_epi16(static_cast<short>(weights[k]))));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+    }
+    horizontalScalar(src + i, out + i, count - i, channels, weights, taps);
+}
+
+SIMD_TARGET("avx2")
+void verticalAvx2(const uint16_t* const* rows, uint8_t* out, int count,
+                  const uint16_t* weights, int taps) {
+    const __m256i rounding = _mm256_set1_epi32(static_cast<int>(OUTPUT_ROUNDING));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i low = rounding;
+        __m256i high = rounding;
+        for (int k = 0; k < taps; ++k) {
+            __m256i values = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rows[k] + i));
+            __m256i weight = _mm256_set1_epi16(static_cast<short>(weights[k]));
+            __m256i productLow = _mm256_mullo_epi16(values, weight);
+            __m256i productHigh = _mm256_mulhi_epu16(values, weight);
+            low = _mm256_add_epi32(low, _mm256_unpacklo_epi16(productLow, productHigh));
+            high = _mm256_add_epi32(high, _mm256_unpackhi_epi16(productLow, productHigh));
+        }
+        // The unpack/pack pairs both work per 128-bit lane, so the element
+        // order is restored; only the final byte pack needs a lane fix-up
+        __m256i result = _mm256_packus_epi32(_mm256_srli_epi32(low, OUTPUT_SHIFT),
+                                             _mm256_srli_epi32(high, OUTPUT_SHIFT));
+        __m256i bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(result, result), 0x08);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm256_castsi256_si128(bytes));
+    }
+    if (i < count) {
+        const uint16_t* shifted[MAX_TAPS];
+        for (int k = 0; k < taps; ++k) {
+            shifted[k] = rows[k] + i;
+        }
+        verticalScalar(shifted, out + i, count - i, weights, taps);
+    }
+}
+
+#endif  // SIMD_X86
+
+#ifdef SIMD_NEON
+
+void horizontalNeon(const uint8_t* src, uint16_t* out, int count, int channels,
+                    const uint16_t* weights, int taps) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint16x8_t sum = vdupq_n_u16(0);
+        for (int k = 0; k < taps; ++k) {
+            uint16x8_t pixels = vmovl_u8(vld1_u8(src + i + k * channels));
+            sum = vmlaq_n_u16(sum, pixels, weights[k]);
+        }
+        vst1q_u16(out + i, sum);
+    }
+    horizontalScalar(src + i, out + i, count - i, channels, weights, taps);
+}
+
+void verticalNeon(const uint16_t* const* rows, uint8_t* out, int count,
+                  const uint16_t* weights, int taps) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint32x4_t low = vdupq_n_u32(OUTPUT_ROUNDING);
+        uint32x4_t high = vdupq_n_u32(OUTPUT_ROUNDING);
+        for (int k = 0; k < taps; ++k) {
+            uint16x8_t values = vld1q_u16(rows[k] + i);
+            low = vmlal_n_u16(low, vget_low_u16(values), weights[k]);
+            high = vmlal_n_u16(high, vget_high_u16(values), weights[k]);
+        }
+        // Narrow in two steps: >> 16 into 16 bits, then >> 7 into bytes
+        uint16x8_t result = vcombine_u16(vshrn_n_u32(low, 16), vshrn_n_u32(high, 16));
+        vst1_u8(out + i, vqshrn_n_u16(result, OUTPUT_SHIFT - 16));
+    }
+    if (i < count) {
+        const uint16_t* shifted[MAX_TAPS];
+        for (int k = 0; k < taps; ++k) {
+            shifted[k] = rows[k] + i;
+        }
+        verticalScalar(shifted, out + i, count - i, weights, taps);
+    }
+}
+
+#endif  // SIMD_NEON
+
+struct RowKernels {
+    HorizontalKernel horizontal;
+    VerticalKernel vertical;
+};
+
+RowKernels kernelsFor(SeparableBlur::Isa isa) {
+    switch (isa) {
+#ifdef SIMD_X86
+        case SeparableBlur::Isa::Avx2:
+            return {horizontalAvx2, verticalAvx2};
+        case SeparableBlur::Isa::Sse41:
+            return {horizontalSse41, verticalSse41};
+#endif
+#ifdef SIMD_NEON
+        case SeparableBlur::Isa::Neon:
+            return {horizontalNeon, verticalNeon};
+#endif
+        default:
+            return {horizontalScalar, verticalScalar};
+    }
+}
+
+// cv::BORDER_REFLECT_101 index mapping; valid while |overshoot| < length
+inline int reflect101(int index, int length) {
+    if (index < 0) {
+        return -index;
+    }
+    if (index >= length) {
+        return 2 * length - 2 - index;
+    }
+    return index;
+}
+
+// Rounds to the target scale and moves the rounding error onto the
+// centre tap so that the weights sum to exactly one
+std::vector<uint16_t> quantize(const std::vector<double>& weights, int shift) {
+    const int scale = 1 << shift;
+    std::vector<uint16_t> quantized(weights.size());
+
+    int sum = 0;
+    for (size_t k = 0; k < weights.size(); ++k) {
+        int value = static_cast<int>(std::lround(weights[k] * scale));
+        value = std::max(0, std::min(scale, value));
+        quantized[k] = static_cast<uint16_t>(value);
+        sum += value;
+    }
+
+    size_t centre = weights.size() / 2;
+    quantized[centre] = static_cast<uint16_t>(quantized[centre] + (scale - sum));
+    return quantized;
+}
+
+std::vector<double> gaussianWeights(int kernelSize, double sigma) {
+    cv::Mat kernel = cv::getGaussianKernel(kernelSize, sigma, CV_64F);
+    std::vector<double> weights(kernelSize);
+    for (int k = 0; k < kernelSize; ++k) {
+        weights[k] = kernel.at<double>(k);
+    }
+    return weights;
+}
+
+}  // namespace
+
+SeparableBlur::SeparableBlur() {
+    setKernels({1.0}, {1.0});
+}
+
+void SeparableBlur::configure(int kernelSize, double sigmaX, double sigmaY) {
+    kernelSize = std::max(1, kernelSize | 1);
+    if (sigmaY <= 0) {
+        sigmaY = sigmaX;
+    }
+    setKernels(gaussianWeights(kernelSize, sigmaX), gaussianWeights(kernelSize, sigmaY));
+}
+
+void SeparableBlur::setKernels(const std::vector<double>& horizontal, const std::vector<double>& vertical) {
+    // Built aside and swapped in, so blurs in progress keep their kernels
+    auto quantized = std::make_shared<Weights>();
+    quantized->horizontal = quantize(horizontal, HORIZONTAL_SHIFT);
+    quantized->vertical = quantize(vertical, VERTICAL_SHIFT);
+    std::atomic_store(&weights, std::shared_ptr<const Weights>(std::move(quantized)));
+}
+
+int SeparableBlur::kernelSize() const {
+    return static_cast<int>(snapshot()->horizontal.size());
+}
+
+bool SeparableBlur::supports(const cv::Mat& frame) const {
+    return supports(frame, *snapshot());
+}
+
+bool SeparableBlur::apply(const cv::Mat& src, cv::Mat& dst) const {
+    return apply(src, dst, bestIsa());
+}
+
+bool SeparableBlur::apply(const cv::Mat& src, cv::Mat& dst, Isa isa) const {
+    std::shared_ptr<const Weights> current = snapshot();
+    if (!supports(src, *current) || !isAvailable(isa)) {
+        return false;
+    }
+
+    dst.create(src.size(), src.type());
+    if (dst.data == src.data) {
+        // Rows are read after earlier output rows are written
+        return false;
+    }
+
+    applyRaw(*current, src.data, src.step, dst.data, dst.step, src.cols, src.rows, src.channels(), isa);
+    return true;
+}
+
+void SeparableBlur::applyRaw(const uint8_t* src, size_t srcStep, uint8_t* dst, size_t dstStep,
+                             int width, int height, int channels, Isa isa) const {
+    applyRaw(*snapshot(), src, srcStep, dst, dstStep, width, height, channels, isa);
+}
+
+std::shared_ptr<const SeparableBlur::Weights> SeparableBlur::snapshot() const {
+    return std::atomic_load(&weights);
+}
+
+bool SeparableBlur::supports(const cv::Mat& frame, const Weights& weights) {
+    int taps = static_cast<int>(weights.horizontal.size());
+    int radius = taps / 2;
+    return taps <= MAX_TAPS && frame.depth() == CV_8U && frame.channels() <= 4 && frame.dims == 2 &&
+           frame.cols > radius && frame.rows > radius;
+}
+
+void SeparableBlur::applyRaw(const Weights& weights, const uint8_t* src, size_t srcStep, uint8_t* dst,
+                             size_t dstStep, int width, int height, int channels, Isa isa) {
+    const RowKernels kernels = kernelsFor(isa);
+    const int taps = static_cast<int>(weights.horizontal.size());
+    const int radius = taps / 2;
+    const int rowElements = width * channels;
+
+    // Per-thread scratch: one padded source row and a ring of horizontally
+    // filtered rows, reused across frames
+    thread_local std::vector<uint8_t> paddedRow;
+    thread_local std::vector<uint16_t> ringStorage;
+    thread_local std::vector<int> ringRows;
+
+    paddedRow.resize(static_cast<size_t>(width + 2 * radius) * channels);
+    ringStorage.resize(static_cast<size_t>(taps) * rowElements);
+    ringRows.assign(taps, -1);
+
+    auto filterRow = [&](int sourceRow, uint16_t* out) {
+        const uint8_t* row = src + static_cast<size_t>(sourceRow) * srcStep;
+        std::copy(row, row + rowElements, paddedRow.begin() + radius * channels);
+        for (int x = 1; x <= radius; ++x) {
+            std::copy(row + reflect101(-x, width) * channels, row + (reflect101(-x, width) + 1) * channels,
+                      paddedRow.begin() + (radius - x) * channels);
+            int right = width - 1 + x;
+            std::copy(row + reflect101(right, width) * channels, row + (reflect101(right, width) + 1) * channels,
+                      paddedRow.begin() + (radius + right) * channels);
+        }
+        kernels.horizontal(paddedRow.data(), out, rowElements, channels, weights.horizontal.data(), taps);
+    };
+
+    const uint16_t* rows[MAX_TAPS];
+    for (int y = 0; y < height; ++y) {
+        for (int k = 0; k < taps; ++k) {
+            int sourceRow = reflect101(y - radius + k, height);
+            // Slot by source row: reflected rows near the borders are
+            // filtered once and shared by several taps
+            int slot = sourceRow % taps;
+            uint16_t* slotData = ringStorage.data() + static_cast<size_t>(slot) * rowElements;
+            if (ringRows[slot] != sourceRow) {
+                filterRow(sourceRow, slotData);
+                ringRows[slot] = sourceRow;
+            }
+            rows[k] = slotData;
+        }
+        kernels.vertical(rows, dst + static_cast<size_t>(y) * dstStep, rowElements, weights.vertical.data(), taps);
+    }
+}
+
+SeparableBlur::Isa SeparableBlur::bestIsa() {
+    static const Isa best = [] {
+        if (isAvailable(Isa::Avx2)) {
+            return Isa::Avx2;
+        }
+        if (isAvailable(Isa::Sse41)) {
+            return Isa::Sse41;
+        }
+        if (isAvailable(Isa::Neon)) {
+            return Isa::Neon;
+        }
+        return Isa::Scalar;
+    }();
+    return best;
+}
+
+bool SeparableBlur::isAvailable(Isa isa) {
+    switch (isa) {
+        case Isa::Scalar:
+            return true;
+#ifdef SIMD_X86
+        case Isa::Sse41:
+            return cv::checkHardwareSupport(CV_CPU_SSE4_1);
+        case Isa::Avx2:
+            return cv::checkHardwareSupport(CV_CPU_AVX2);
+#endif
+#ifdef SIMD_NEON
+        case Isa::Neon:
+            return true;
+#endif
+        default:
+            return false;
+    }
+}
+
+const char* SeparableBlur::isaName(Isa isa) {
+    switch (isa) {
+        case Isa::Sse41:
+            return "SSE4.1";
+        case Isa::Avx2:
+            return "AVX2";
+        case Isa::Neon:
+            return "NEON";
+        default:
+            return "scalar";
+    }
+}
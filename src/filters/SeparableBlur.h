@@ -0,0 +1,149 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Fixed-point separable Gaussian blur for 8-bit frames
+ *
+ * The 1-D kernels are quantized once in configure() and reused for every
+ * frame. Each row is filtered horizontally into 16-bit sums (Q8 weights)
+ * kept in a small ring of rows, and each output row is then produced by
+ * the vertical pass (Q15 weights) with 32-bit accumulation and rounding,
+ * so no floating point is used per pixel. Borders are handled like
+ * cv::BORDER_REFLECT_101, the OpenCV default.
+ *
+ * Both passes have AVX2, SSE4.1 and NEON implementations; the best one the
+ * CPU supports is chosen at runtime, with a scalar fallback.
+ *
+ * The quantized kernels are immutable once built. configure() publishes a
+ * new set atomically and every blur takes one snapshot when it starts, so
+ * reconfiguring while other threads blur is safe: each call uses either
+ * the old or the new kernels throughout.
+ */
+class SeparableBlur {
+public:
+    /**
+     * @brief Instruction set used by the row kernels
+     */
+    enum class Isa {
+        Scalar,
+        Sse41,
+        Avx2,
+        Neon
+    };
+
+    /**
+     * @brief Construct an identity (unconfigured) blur
+     */
+    SeparableBlur();
+
+    /**
+     * @brief Compute and quantize the Gaussian kernels
+     *
+     * @param kernelSize Odd kernel size
+     * @param sigmaX Standard deviation in X (<= 0 derives it from the size, like OpenCV)
+     * @param sigmaY Standard deviation in Y (<= 0 uses sigmaX)
+     */
+    void configure(int kernelSize, double sigmaX, double sigmaY);
+
+    /**
+     * @brief Quantize arbitrary normalized 1-D kernels
+     *
+     * @param horizontal Weights of the horizontal pass (odd length, sum 1)
+     * @param vertical Weights of the vertical pass (same length, sum 1)
+     */
+    void setKernels(const std::vector<double>& horizontal, const std::vector<double>& vertical);
+
+    /**
+     * @brief Check whether a frame can be blurred by this implementation
+     *
+     * Requires an 8-bit frame with 1-4 channels that is larger than the
+     * kernel radius in both directions, and a kernel of at most 63 taps.
+     *
+     * @param frame Frame to check
+     * @return true if apply() will handle the frame
+     */
+    bool supports(const cv::Mat& frame) const;
+
+    /**
+     * @brief Blur a frame with the best available instruction set
+     *
+     * @param src Input frame
+     * @param dst Output frame; must not share data with src
+     * @return false if the frame is not supported (dst is left untouched)
+     */
+    bool apply(const cv::Mat& src, cv::Mat& dst) const;
+
+    /**
+     * @brief Blur a frame with a specific instruction set
+     *
+     * @param src Input frame
+     * @param dst Output frame; must not share data with src
+     * @param isa Instruction set; must be available on this CPU
+     * @return false if the frame is not supported (dst is left untouched)
+     */
+    bool apply(const cv::Mat& src, cv::Mat& dst, Isa isa) const;
+
+    /**
+     * @brief Blur a raw interleaved 8-bit image
+     *
+     * @param src First row of the input
+     * @param srcStep Bytes between input rows
+     * @param dst First row of the output
+     * @param dstStep Bytes between output rows
+     * @param width Width in pixels
+     * @param height Height in rows
+     * @param channels Interleaved channels per pixel
+     * @param isa Instruction set; must be available on this CPU
+     */
+    void applyRaw(const uint8_t* src, size_t srcStep, uint8_t* dst, size_t dstStep,
+                  int width, int height, int channels, Isa isa) const;
+
+    /**
+     * @brief Get the kernel size
+     *
+     * @return Number of taps of each 1-D kernel
+     */
+    int kernelSize() const;
+
+    /**
+     * @brief Get the fastest instruction set supported by this CPU
+     *
+     * @return Instruction set chosen by apply()
+     */
+    static Isa bestIsa();
+
+    /**
+     * @brief Check whether an instruction set can be used on this CPU
+     *
+     * @param isa Instruction set to check
+     * @return true if it is compiled in and supported at runtime
+     */
+    static bool isAvailable(Isa isa);
+
+    /**
+     * @brief Get a printable name for an instruction set
+     *
+     * @param isa Instruction set
+     * @return Name such as "AVX2"
+     */
+    static const char* isaName(Isa isa);
+
+private:
+    // Quantized kernels; never modified after they are published
+    struct Weights {
+        std::vector<uint16_t> horizontal;   ///< Q8, sums to 256
+        std::vector<uint16_t> vertical;     ///< Q15, sums to 32768
+    };
+
+    // Read and replaced with std::atomic_load / std::atomic_store only
+    std::shared_ptr<const Weights> weights;
+
+    std::shared_ptr<const Weights> snapshot() const;
+    static bool supports(const cv::Mat& frame, const Weights& weights);
+    static void applyRaw(const Weights& weights, const uint8_t* src, size_t srcStep, uint8_t* dst,
+                         size_t dstStep, int width, int height, int channels, Isa isa);
+};
@@ -2,13 +2,15 @@
 #include <memory>
 #include "VideoProcessor.h"
 #include "ui/UserInterface.h"
+#include "cli/HeadlessRunner.h"
 
 /**
  * @brief Entry point for the Video Filter Application
  *
  * This application demonstrates video processing capabilities using OpenCV
  * and C++ multithreading. It allows loading video files, applying various
- * filters, and saving the processed output.
+ * filters, and saving the processed output. When started with any option
+ * (e.g. --in/--out) it runs headless, without creating a window.
  *
  * @param argc Number of command line arguments
  * @param argv Command line arguments
@@ -21,8 +23,46 @@ int main(int argc, char* argv[]) {
     std::cout << std::endl;
 
     try {
-        // Create the video processor
+        // Run without a display when asked for a batch transcode
+        if (HeadlessRunner::isHeadlessInvocation(argc, argv)) {
+            HeadlessOptions options;
+            if (!HeadlessRunner::parseArguments(argc, argv, options)) {
+                HeadlessRunner::printUsage();
+                return 1;
+            }
+
+            HeadlessRunner runner(options);
+            return runner.run();
+        }
+
+        // Create the video processor; the live preview filters each frame
+        // in tiles across the cores rather than keeping many frames in
+        // flight, so what is shown lags the source less
         auto processor = std::make_shared<VideoProcessor>();
+        processor->setWorkerCount(2);
+        processor->setTileRows(64);
+
+        // Scrubbing jumps to indexed keyframes and steps back through
+        // recently decoded frames
+        VideoProcessor::SeekOptions seekOptions;
+        seekOptions.indexKeyframes = true;
+        seekOptions.useSidecar = true;
+        seekOptions.cacheBytes = 256 * 1024 * 1024;
+        processor->setSeekOptions(seekOptions);
+
+        // Tweaking a filter reprocesses only the stages from that filter on,
+        // and revisited frames come straight from the cache
+        processor->setFilterCacheBudget(256 * 1024 * 1024);
+
+        // Play at the source rate; frames the filters cannot finish in time
+        // are filtered at half resolution, so the preview never lags behind
+        VideoProcessor::RealTime realTime;
+        realTime.policy = VideoProcessor::RealTime::Policy::Degrade;
+        processor->setRealTime(realTime);
+
+        // Under sustained load, filter at a lower resolution before frames
+        // start arriving late; saving a video still runs at full resolution
+        processor->setQualityGovernor(true);
 
         // Create the user interface
         UserInterface ui(processor);
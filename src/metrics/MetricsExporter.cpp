@@ -0,0 +1,409 @@
+#include "MetricsExporter.h"
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace {
+
+const std::string SOCKET_PREFIX = "unix:";
+
+// Escape a string for a JSON string or a Prometheus label value
+std::string escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (static_cast<unsigned char>(c) >= 0x20) {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+uint64_t unixTimeMs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count());
+}
+
+// Writes Prometheus metric descriptions and samples, adding the job label
+class PrometheusWriter {
+public:
+    PrometheusWriter(std::ostream& out, const std::string& label) : out(out) {
+        if (!label.empty()) {
+            jobLabel = "job=\"" + escape(label) + "\"";
+        }
+    }
+
+    void describe(const std::string& name, const std::string& type, const std::string& help) {
+        out << "# HELP videofilter_" << name << " " << help << "\n";
+        out << "# TYPE videofilter_" << name << " " << type << "\n";
+    }
+
+    template <typename T>
+    void sample(const std::string& name, T value, const std::string& labels = "") {
+        out << "videofilter_" << name;
+        std::string all = jobLabel;
+        if (!labels.empty()) {
+            all += (all.empty() ? "" : ",") + labels;
+        }
+        if (!all.empty()) {
+            out << "{" << all << "}";
+        }
+        out << " " << value << "\n";
+    }
+
+private:
+    std::ostream& out;
+    std::string jobLabel;
+};
+
+std::string label(const std::string& name, const std::string& value) {
+    return name + "=\"" + escape(value) + "\"";
+}
+
+}  // namespace
+
+MetricsExporter::MetricsExporter(const VideoProcessor& processor, const Options& options)
+    : processor(processor), options(options), stopRequested(false), running(false), listenSocket(-1) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::parseFormat(const std::string& name, Format& format) {
+    if (name == "json") {
+        format = Format::JsonLines;
+    } else if (name == "prometheus") {
+        format = Format::Prometheus;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool MetricsExporter::start() {
+    if (running) {
+        return true;
+    }
+    stopRequested = false;
+
+    if (options.target.compare(0, SOCKET_PREFIX.size(), SOCKET_PREFIX) == 0) {
+        socketPath = options.target.substr(SOCKET_PREFIX.size());
+        if (!openSocket()) {
+            return false;
+        }
+        thread = std::thread(&MetricsExporter::socketThreadFunc, this);
+    } else {
+        filePath = options.target;
+        if (options.format == Format::JsonLines) {
+            jsonFile.open(filePath, std::ios::out | std::ios::app);
+            if (!jsonFile.is_open()) {
+                std::cerr << "Error: Could not open metrics file: " << filePath << std::endl;
+                return false;
+            }
+        }
+        thread = std::thread(&MetricsExporter::fileThreadFunc, this);
+    }
+
+    running = true;
+    return true;
+}
+
+void MetricsExporter::stop() {
+    if (!running) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopRequested = true;
+    }
+    stopCondition.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+
+    if (!filePath.empty()) {
+        writeFileSnapshot();
+        jsonFile.close();
+    }
+    closeSocket();
+    running = false;
+}
+
+void MetricsExporter::fileThreadFunc() {
+    auto interval = std::chrono::milliseconds(std::max(1, options.intervalMs));
+    auto next = std::chrono::steady_clock::now() + interval;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopCondition.wait_until(lock, next, [this] { return stopRequested; })) {
+        lock.unlock();
+        writeFileSnapshot();
+        lock.lock();
+        next += interval;
+    }
+}
+
+void MetricsExporter::writeFileSnapshot() {
+    std::string snapshot = formatSnapshot();
+
+    if (options.format == Format::JsonLines) {
+        jsonFile << snapshot << std::flush;
+        return;
+    }
+
+    // Scrapers must never see a half-written file, so write a temporary
+    // file next to it and rename it over the target
+    std::string temporary = filePath + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::out | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write metrics file: " << temporary << std::endl;
+            return;
+        }
+        file << snapshot;
+    }
+#ifdef _WIN32
+    std::remove(filePath.c_str());
+#endif
+    if (std::rename(temporary.c_str(), filePath.c_str()) != 0) {
+        std::cerr << "Error: Could not replace metrics file: " << filePath << std::endl;
+    }
+}
+
+#ifndef _WIN32
+
+bool MetricsExporter::openSocket() {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Invalid metrics socket path: " << socketPath << std::endl;
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    listenSocket = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSocket < 0) {
+        std::cerr << "Error: Could not create metrics socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    // A socket file left by an earlier run would make bind() fail
+    unlink(socketPath.c_str());
+    if (bind(listenSocket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+        listen(listenSocket, 8) != 0) {
+        std::cerr << "Error: Could not listen on metrics socket " << socketPath << ": "
+                  << std::strerror(errno) << std::endl;
+        closeSocket();
+        return false;
+    }
+    return true;
+}
+
+void MetricsExporter::closeSocket() {
+    if (listenSocket >= 0) {
+        close(listenSocket);
+        listenSocket = -1;
+        unlink(socketPath.c_str());
+    }
+}
+
+void MetricsExporter::socketThreadFunc() {
+    // Poll with a timeout so that stop() is noticed without a wake-up pipe
+    const int pollMs = 100;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopRequested) {
+                break;
+            }
+        }
+
+        pollfd descriptor = {listenSocket, POLLIN, 0};
+        if (poll(&descriptor, 1, pollMs) <= 0 || !(descriptor.revents & POLLIN)) {
+            continue;
+        }
+
+        int client = accept(listenSocket, nullptr, nullptr);
+        if (client < 0) {
+            continue;
+        }
+
+        std::string snapshot = formatSnapshot();
+        const char* data = snapshot.data();
+        size_t remaining = snapshot.size();
+        while (remaining > 0) {
+            ssize_t written = send(client, data, remaining, MSG_NOSIGNAL);
+            if (written <= 0) {
+                break;
+            }
+            data += written;
+            remaining -= static_cast<size_t>(written);
+        }
+        close(client);
+    }
+}
+
+#else
+
+bool MetricsExporter::openSocket() {
+    std::cerr << "Error: Metrics sockets are not supported on this platform." << std::endl;
+    return false;
+}
+
+void MetricsExporter::closeSocket() {
+}
+
+void MetricsExporter::socketThreadFunc() {
+}
+
+#endif
+
+std::string MetricsExporter::formatSnapshot() const {
+    return options.format == Format::Prometheus ? formatPrometheus() : formatJson();
+}
+
+std::string MetricsExporter::formatJson() const {
+    const PerformanceMonitor& monitor = processor.getPerformanceMonitor();
+    VideoProcessor::EncoderStats encoder = processor.getEncoderStats();
+    FramePool::Stats pools[] = {processor.getCapturePoolStats(), processor.getOutputPoolStats()};
+    const char* poolNames[] = {"capture", "output"};
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "{\"timestamp_ms\":" << unixTimeMs();
+    if (!options.label.empty()) {
+        out << ",\"job\":\"" << escape(options.label) << "\"";
+    }
+    out << ",\"frames_in\":" << processor.getCapturedFrameCount()
+        << ",\"frames_out\":" << processor.getProcessedFrameCount()
+        << ",\"frames_dropped\":" << processor.getDroppedFrameCount()
+        << ",\"frames_late\":" << processor.getLateFrameCount()
+        << ",\"fps\":" << processor.getFrameRate();
+
+    out << ",\"stages\":{";
+    bool first = true;
+    for (const auto& stage : monitor.getStageStats()) {
+        out << (first ? "" : ",") << "\"" << escape(stage.name) << "\":{\"count\":" << stage.count
+            << ",\"mean_ms\":" << stage.meanMs << ",\"p50_ms\":" << stage.p50Ms
+            << ",\"p95_ms\":" << stage.p95Ms << ",\"p99_ms\":" << stage.p99Ms
+            << ",\"max_ms\":" << stage.maxMs << "}";
+        first = false;
+    }
+
+    out << "},\"queues\":{";
+    first = true;
+    for (const auto& queue : monitor.getQueueStats()) {
+        out << (first ? "" : ",") << "\"" << escape(queue.name) << "\":{\"depth\":" << queue.depth
+            << ",\"peak\":" << queue.peakDepth << ",\"capacity\":" << queue.capacity << "}";
+        first = false;
+    }
+
+    out << "},\"pools\":{";
+    for (int i = 0; i < 2; ++i) {
+        out << (i ? "," : "") << "\"" << poolNames[i] << "\":{\"capacity\":" << pools[i].capacity
+            << ",\"in_use\":" << pools[i].inUse << ",\"peak_in_use\":" << pools[i].peakInUse
+            << ",\"allocation_misses\":" << pools[i].allocationMisses
+            << ",\"bytes_reserved\":" << pools[i].bytesReserved << "}";
+    }
+
+    out << "},\"encoder\":{\"frames_written\":" << encoder.framesWritten
+        << ",\"backlog\":" << encoder.queueDepth << ",\"peak_backlog\":" << encoder.peakQueueDepth
+        << ",\"capacity\":" << encoder.queueCapacity << "}}\n";
+    return out.str();
+}
+
+std::string MetricsExporter::formatPrometheus() const {
+    const PerformanceMonitor& monitor = processor.getPerformanceMonitor();
+    VideoProcessor::EncoderStats encoder = processor.getEncoderStats();
+    FramePool::Stats pools[] = {processor.getCapturePoolStats(), processor.getOutputPoolStats()};
+    const char* poolNames[] = {"capture", "output"};
+    std::vector<PerformanceMonitor::StageStats> stages = monitor.getStageStats();
+    std::vector<PerformanceMonitor::QueueStats> queues = monitor.getQueueStats();
+
+    std::ostringstream out;
+    out << std::setprecision(9);
+    PrometheusWriter writer(out, options.label);
+
+    writer.describe("frames_in_total", "counter", "Frames decoded");
+    writer.sample("frames_in_total", processor.getCapturedFrameCount());
+    writer.describe("frames_out_total", "counter", "Frames that left the pipeline");
+    writer.sample("frames_out_total", processor.getProcessedFrameCount());
+    writer.describe("frames_dropped_total", "counter", "Decoded frames discarded, e.g. after a seek");
+    writer.sample("frames_dropped_total", processor.getDroppedFrameCount());
+    writer.describe("frames_late_total", "counter", "Frames that missed their source time in real-time mode");
+    writer.sample("frames_late_total", processor.getLateFrameCount());
+    writer.describe("fps", "gauge", "Smoothed output frame rate");
+    writer.sample("fps", processor.getFrameRate());
+
+    writer.describe("stage_latency_seconds", "summary", "Latency of pipeline and filter stages");
+    for (const auto& stage : stages) {
+        std::string name = label("stage", stage.name);
+        writer.sample("stage_latency_seconds", stage.p50Ms / 1e3, name + ",quantile=\"0.5\"");
+        writer.sample("stage_latency_seconds", stage.p95Ms / 1e3, name + ",quantile=\"0.95\"");
+        writer.sample("stage_latency_seconds", stage.p99Ms / 1e3, name + ",quantile=\"0.99\"");
+        writer.sample("stage_latency_seconds_sum", stage.meanMs * stage.count / 1e3, name);
+        writer.sample("stage_latency_seconds_count", stage.count, name);
+    }
+    writer.describe("stage_latency_max_seconds", "gauge", "Slowest sample of a stage");
+    for (const auto& stage : stages) {
+        writer.sample("stage_latency_max_seconds", stage.maxMs / 1e3, label("stage", stage.name));
+    }
+
+    writer.describe("queue_depth", "gauge", "Frames waiting in a pipeline queue");
+    for (const auto& queue : queues) {
+        writer.sample("queue_depth", queue.depth, label("queue", queue.name));
+    }
+    writer.describe("queue_peak_depth", "gauge", "Deepest a pipeline queue has been");
+    for (const auto& queue : queues) {
+        writer.sample("queue_peak_depth", queue.peakDepth, label("queue", queue.name));
+    }
+    writer.describe("queue_capacity", "gauge", "Frames a pipeline queue can hold");
+    for (const auto& queue : queues) {
+        writer.sample("queue_capacity", queue.capacity, label("queue", queue.name));
+    }
+
+    writer.describe("pool_bytes_reserved", "gauge", "Memory held by a frame pool");
+    for (int i = 0; i < 2; ++i) {
+        writer.sample("pool_bytes_reserved", pools[i].bytesReserved, label("pool", poolNames[i]));
+    }
+    writer.describe("pool_frames_in_use", "gauge", "Pooled frames handed out");
+    for (int i = 0; i < 2; ++i) {
+        writer.sample("pool_frames_in_use", pools[i].inUse, label("pool", poolNames[i]));
+    }
+    writer.describe("pool_capacity", "gauge", "Frames preallocated by a pool");
+    for (int i = 0; i < 2; ++i) {
+        writer.sample("pool_capacity", pools[i].capacity, label("pool", poolNames[i]));
+    }
+    writer.describe("pool_allocation_misses_total", "counter", "Frames allocated because a pool was empty");
+    for (int i = 0; i < 2; ++i) {
+        writer.sample("pool_allocation_misses_total", pools[i].allocationMisses, label("pool", poolNames[i]));
+    }
+
+    writer.describe("encoder_frames_written_total", "counter", "Frames passed to the video writer");
+    writer.sample("encoder_frames_written_total", encoder.framesWritten);
+    writer.describe("encoder_backlog_frames", "gauge", "Frames waiting for the encoder");
+    writer.sample("encoder_backlog_frames", encoder.queueDepth);
+    writer.describe("encoder_peak_backlog_frames", "gauge", "Deepest the encoder backlog has been");
+    writer.sample("encoder_peak_backlog_frames", encoder.peakQueueDepth);
+    return out.str();
+}
\ No newline at end of file
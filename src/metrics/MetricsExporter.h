@@ -0,0 +1,126 @@
+#pragma once
+
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <fstream>
+#include "../VideoProcessor.h"
+
+/**
+ * @brief Periodically exports the metrics of a VideoProcessor
+ *
+ * Snapshots hold frames in, out and dropped, the frame rate, per-stage
+ * latency percentiles (including every filter stage), queue occupancy,
+ * frame pool memory and the encoder backlog, formatted as JSON lines or
+ * in the Prometheus text format.
+ *
+ * The target is a file or, with a "unix:" prefix, a local Unix socket:
+ *
+ * - a JSON lines file gets one line appended per interval;
+ * - a Prometheus file is replaced atomically every interval, which suits
+ *   the node exporter's textfile collector;
+ * - a socket answers every connection with a fresh snapshot and closes
+ *   it, so tests and local agents can scrape it with e.g.
+ *   `nc -U /tmp/videofilter.sock` and no network service.
+ *
+ * Everything runs on the exporter's own thread and only reads counters
+ * the pipeline keeps anyway, so a processor without an exporter pays
+ * nothing for it.
+ */
+class MetricsExporter {
+public:
+    /**
+     * @brief Snapshot format
+     */
+    enum class Format {
+        JsonLines,      ///< One JSON object per line
+        Prometheus      ///< Prometheus text exposition format
+    };
+
+    /**
+     * @brief Where and how to export
+     */
+    struct Options {
+        std::string target;             ///< File path, or "unix:" followed by a socket path
+        Format format = Format::JsonLines;
+        int intervalMs = 1000;          ///< Time between file snapshots
+        std::string label;              ///< Identifies the job, e.g. the input file
+    };
+
+    /**
+     * @brief Constructor
+     *
+     * @param processor Processor to read; must outlive the exporter
+     * @param options Export options
+     */
+    MetricsExporter(const VideoProcessor& processor, const Options& options);
+
+    /**
+     * @brief Destructor; stops the exporter
+     */
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    /**
+     * @brief Open the target and start exporting
+     *
+     * @return true if the target could be opened
+     */
+    bool start();
+
+    /**
+     * @brief Stop exporting; a file target gets one last snapshot
+     */
+    void stop();
+
+    /**
+     * @brief Format the current metrics
+     *
+     * @return Snapshot in the configured format
+     */
+    std::string formatSnapshot() const;
+
+    /**
+     * @brief Parse a format name ("json" or "prometheus")
+     *
+     * @param name Format name
+     * @param format Receives the format
+     * @return true if the name is known
+     */
+    static bool parseFormat(const std::string& name, Format& format);
+
+private:
+    const VideoProcessor& processor;
+    Options options;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable stopCondition;
+    bool stopRequested;
+    bool running;
+
+    // File target
+    std::string filePath;
+    std::ofstream jsonFile;
+
+    // Socket target
+    std::string socketPath;
+    int listenSocket;
+
+    // Thread functions for the two kinds of target
+    void fileThreadFunc();
+    void socketThreadFunc();
+
+    // Write one snapshot to the file target
+    void writeFileSnapshot();
+
+    // Open and close the listening socket
+    bool openSocket();
+    void closeSocket();
+
+    std::string formatJson() const;
+    std::string formatPrometheus() const;
+};
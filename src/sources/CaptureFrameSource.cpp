@@ -0,0 +1,54 @@
+#include "CaptureFrameSource.h"
+#include <algorithm>
+
+bool CaptureFrameSource::open(const std::string& filename) {
+    this->filename = filename;
+    keyframes.reset();
+    return capture.open(filename);
+}
+
+bool CaptureFrameSource::read(cv::Mat& frame) {
+    return capture.read(frame);
+}
+
+bool CaptureFrameSource::grab() {
+    return capture.grab();
+}
+
+bool CaptureFrameSource::retrieve(cv::Mat& frame) {
+    return capture.retrieve(frame);
+}
+
+bool CaptureFrameSource::isKeyframe() const {
+    int frame = getPosition() - 1;
+    return keyframes && keyframes->waitUntilScanned(frame) && keyframes->isKeyframe(frame);
+}
+
+bool CaptureFrameSource::indexKeyframes() {
+    if (!keyframes) {
+        keyframes = std::make_shared<KeyframeIndex>();
+        keyframes->build(filename, false);
+    }
+    return keyframes->waitUntilScanned(0);
+}
+
+bool CaptureFrameSource::seek(int frameIndex) {
+    return capture.set(cv::CAP_PROP_POS_FRAMES, frameIndex);
+}
+
+int CaptureFrameSource::getPosition() const {
+    return static_cast<int>(capture.get(cv::CAP_PROP_POS_FRAMES));
+}
+
+int CaptureFrameSource::getFrameCount() const {
+    return std::max(0, static_cast<int>(capture.get(cv::CAP_PROP_FRAME_COUNT)));
+}
+
+cv::Size CaptureFrameSource::getFrameSize() const {
+    return cv::Size(static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+double CaptureFrameSource::getFps() const {
+    return capture.get(cv::CAP_PROP_FPS);
+}
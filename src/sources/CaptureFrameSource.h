@@ -0,0 +1,40 @@
+#pragma once
+
+#include "FrameSource.h"
+#include "KeyframeIndex.h"
+#include <memory>
+
+/**
+ * @brief Frame source that decodes a video file or stream with cv::VideoCapture
+ *
+ * Keyframes are looked up in a KeyframeIndex that indexKeyframes() builds
+ * from a demuxer scan of the file. The decoder's own keyframe flag cannot
+ * be used: it belongs to the last packet sent to the decoder, which with
+ * frame threading or reordered frames is not the frame handed out.
+ */
+class CaptureFrameSource : public FrameSource {
+public:
+    /**
+     * @brief Open a video
+     *
+     * @param filename File name or URL understood by cv::VideoCapture
+     * @return true if the video was opened
+     */
+    bool open(const std::string& filename);
+
+    bool read(cv::Mat& frame) override;
+    bool grab() override;
+    bool retrieve(cv::Mat& frame) override;
+    bool isKeyframe() const override;
+    bool indexKeyframes() override;
+    bool seek(int frameIndex) override;
+    int getPosition() const override;
+    int getFrameCount() const override;
+    cv::Size getFrameSize() const override;
+    double getFps() const override;
+
+private:
+    cv::VideoCapture capture;
+    std::string filename;
+    std::shared_ptr<KeyframeIndex> keyframes;   ///< Built by indexKeyframes()
+};
@@ -0,0 +1,58 @@
+#include "FrameSource.h"
+#include "CaptureFrameSource.h"
+#include "RawFrameSource.h"
+#include "SyntheticFrameSource.h"
+#include <iostream>
+
+namespace {
+
+bool hasPrefix(const std::string& text, const std::string& prefix) {
+    return text.compare(0, prefix.size(), prefix) == 0;
+}
+
+}  // namespace
+
+bool FrameSource::read(cv::Mat& frame) {
+    return grab() && retrieve(frame);
+}
+
+bool FrameSource::isKeyframe() const {
+    return true;
+}
+
+bool FrameSource::indexKeyframes() {
+    return true;
+}
+
+std::unique_ptr<FrameSource> FrameSource::create(const std::string& spec) {
+    if (spec == "synthetic" || hasPrefix(spec, "synthetic:")) {
+        SyntheticFrameSource::Options options;
+        if (spec.size() > 10 && !SyntheticFrameSource::parseOptions(spec.substr(10), options)) {
+            return nullptr;
+        }
+        return std::make_unique<SyntheticFrameSource>(options);
+    }
+
+    if (hasPrefix(spec, "raw:")) {
+        // raw:<format>:<path>; the path may contain colons itself
+        size_t separator = spec.find(':', 4);
+        cv::Size size;
+        double fps = 0.0;
+        if (separator == std::string::npos ||
+            !RawFrameSource::parseFormat(spec.substr(4, separator - 4), size, fps)) {
+            std::cerr << "Error: Expected raw:<width>x<height>[@fps]:<path>, got: " << spec << std::endl;
+            return nullptr;
+        }
+        auto source = std::make_unique<RawFrameSource>();
+        if (!source->open(spec.substr(separator + 1), size, fps)) {
+            return nullptr;
+        }
+        return source;
+    }
+
+    auto source = std::make_unique<CaptureFrameSource>();
+    if (!source->open(spec)) {
+        return nullptr;
+    }
+    return source;
+}
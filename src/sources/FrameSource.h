@@ -0,0 +1,120 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Sequential source of BGR frames for the processing pipeline
+ *
+ * VideoProcessor reads its input through this interface, so the pipeline
+ * can be fed from a decoded video file, from frames generated in memory
+ * or from a file of raw frames. Frames are numbered from 0; reading
+ * returns the frame at the current position and advances it.
+ *
+ * A source is used by one thread at a time.
+ */
+class FrameSource {
+public:
+    virtual ~FrameSource() = default;
+
+    /**
+     * @brief Read the frame at the current position and advance
+     *
+     * Same as grab() followed by retrieve().
+     *
+     * @param frame Receives the frame; an existing buffer of the right size
+     *              and type is reused
+     * @return false at the end of the source or on a read error
+     */
+    virtual bool read(cv::Mat& frame);
+
+    /**
+     * @brief Advance past the frame at the current position
+     *
+     * Does only the work needed to move on, e.g. decoding without the
+     * colour conversion and copy. Call retrieve() to get the frame after
+     * all; skipped frames cost much less than read().
+     *
+     * @return false at the end of the source or on a read error
+     */
+    virtual bool grab() = 0;
+
+    /**
+     * @brief Get the frame passed by the last grab()
+     *
+     * @param frame Receives the frame; an existing buffer of the right size
+     *              and type is reused
+     * @return false if no frame was grabbed or it could not be produced
+     */
+    virtual bool retrieve(cv::Mat& frame) = 0;
+
+    /**
+     * @brief Check whether the frame passed by the last grab() is a keyframe
+     *
+     * Sources without inter-frame coding, and those that cannot tell,
+     * report every frame as a keyframe.
+     *
+     * @return true if the frame can be decoded on its own
+     */
+    virtual bool isKeyframe() const;
+
+    /**
+     * @brief Prepare isKeyframe() to answer for every frame
+     *
+     * Call before the first grab() that needs keyframe flags.
+     *
+     * @return false if the source cannot tell keyframes apart
+     */
+    virtual bool indexKeyframes();
+
+    /**
+     * @brief Move the read position
+     *
+     * @param frameIndex Index of the next frame to read
+     * @return true if the position was changed
+     */
+    virtual bool seek(int frameIndex) = 0;
+
+    /**
+     * @brief Get the index of the next frame to be read
+     *
+     * @return Current read position
+     */
+    virtual int getPosition() const = 0;
+
+    /**
+     * @brief Get the number of frames in the source
+     *
+     * @return Frame count, or 0 if unknown
+     */
+    virtual int getFrameCount() const = 0;
+
+    /**
+     * @brief Get the size of every frame
+     *
+     * @return Frame size
+     */
+    virtual cv::Size getFrameSize() const = 0;
+
+    /**
+     * @brief Get the nominal frame rate
+     *
+     * @return Frames per second, or 0 if unknown
+     */
+    virtual double getFps() const = 0;
+
+    /**
+     * @brief Open a source from a text specification
+     *
+     * - "synthetic:width=1280:height=720:pattern=bars:..." generates frames
+     *   in memory (see SyntheticFrameSource);
+     * - "raw:1920x1080@30:path/to/frames.bgr" reads packed BGR frames from a
+     *   file (see RawFrameSource);
+     * - anything else is a file name or URL opened with cv::VideoCapture.
+     *
+     * @param spec Source specification
+     * @return The opened source, or nullptr if it could not be opened
+     */
+    static std::unique_ptr<FrameSource> create(const std::string& spec);
+};
@@ -0,0 +1,134 @@
+#include "IndexedFrameSource.h"
+
+namespace {
+
+// cv::VideoCapture's FFmpeg backend seeks to the last keyframe at least
+// this many frames before the requested one
+const int BACKEND_SEEK_DISTANCE = 16;
+
+}  // namespace
+
+IndexedFrameSource::IndexedFrameSource(std::unique_ptr<FrameSource> innerSource,
+                                       std::shared_ptr<KeyframeIndex> keyframeIndex, size_t cacheBytes)
+    : inner(std::move(innerSource)), index(std::move(keyframeIndex)), cache(cacheBytes),
+      cacheFrames(0), position(0), innerPosition(0), grabbed(-1), grabbedFromCache(false) {
+    cv::Size size = inner->getFrameSize();
+    size_t frameBytes = static_cast<size_t>(size.area()) * 3;
+    cacheFrames = frameBytes > 0 ? cacheBytes / frameBytes : 0;
+    innerPosition = inner->getPosition();
+    position = innerPosition;
+}
+
+bool IndexedFrameSource::grab() {
+    int target = position;
+    if (cache.contains(static_cast<uint64_t>(target))) {
+        grabbed = target;
+        grabbedFromCache = true;
+        position.compare_exchange_strong(target, target + 1);
+        return true;
+    }
+
+    if (!moveInnerTo(target) || !inner->grab()) {
+        grabbed = -1;
+        return false;
+    }
+    grabbed = target;
+    grabbedFromCache = false;
+    innerPosition = target + 1;
+
+    // A seek() since the read started wins over advancing
+    position.compare_exchange_strong(target, target + 1);
+    return true;
+}
+
+bool IndexedFrameSource::retrieve(cv::Mat& frame) {
+    if (grabbed < 0) {
+        return false;
+    }
+    if (grabbedFromCache) {
+        return cache.get(static_cast<uint64_t>(grabbed), frame);
+    }
+    if (!inner->retrieve(frame)) {
+        return false;
+    }
+    cache.put(static_cast<uint64_t>(grabbed), frame);
+    return true;
+}
+
+bool IndexedFrameSource::isKeyframe() const {
+    return index->waitUntilScanned(grabbed) && index->isKeyframe(grabbed);
+}
+
+bool IndexedFrameSource::indexKeyframes() {
+    return index->waitUntilScanned(0);
+}
+
+bool IndexedFrameSource::seek(int frameIndex) {
+    int frameCount = inner->getFrameCount();
+    if (frameIndex < 0 || (frameCount > 0 && frameIndex > frameCount)) {
+        return false;
+    }
+    position = frameIndex;
+    return true;
+}
+
+int IndexedFrameSource::getPosition() const {
+    return position;
+}
+
+int IndexedFrameSource::getFrameCount() const {
+    return inner->getFrameCount();
+}
+
+cv::Size IndexedFrameSource::getFrameSize() const {
+    return inner->getFrameSize();
+}
+
+double IndexedFrameSource::getFps() const {
+    return inner->getFps();
+}
+
+FrameCache::Stats IndexedFrameSource::getCacheStats() const {
+    return cache.getStats();
+}
+
+bool IndexedFrameSource::moveInnerTo(int target) {
+    if (innerPosition == target) {
+        return true;
+    }
+
+    // Without an index entry yet, leave the seek to the inner source.
+    // cv::VideoCapture only seeks by frame: CAP_PROP_POS_MSEC is turned
+    // into a frame number and takes the same path, and there is no byte
+    // offset. Its FFmpeg backend seeks to the last keyframe at least
+    // BACKEND_SEEK_DISTANCE frames before the requested one and decodes
+    // forward. Asking for the frame that distance past the keyframe a seek
+    // to the target would land on costs the same as asking for the target,
+    // and the frames from there on are decoded here, where they can be
+    // cached. Asking for a keyframe itself would decode the GOP before it.
+    int keyframe = index->keyframeAtOrBefore(target);
+    bool decodeOn = keyframe >= 0 && innerPosition < target && innerPosition >= keyframe;
+    if (!decodeOn) {
+        int landing = index->keyframeAtOrBefore(target - BACKEND_SEEK_DISTANCE);
+        int start = landing >= 0 ? landing + BACKEND_SEEK_DISTANCE : target;
+        if (!inner->seek(start)) {
+            return false;
+        }
+        innerPosition = start;
+    }
+
+    // Decode up to the target; the last frames before it are kept for
+    // stepping back, the earlier ones are only grabbed
+    int firstCached = target - static_cast<int>(cacheFrames);
+    while (innerPosition < target) {
+        if (!inner->grab()) {
+            return false;
+        }
+        if (innerPosition >= firstCached && !cache.contains(static_cast<uint64_t>(innerPosition)) &&
+            inner->retrieve(scratch)) {
+            cache.put(static_cast<uint64_t>(innerPosition), scratch);
+        }
+        ++innerPosition;
+    }
+    return true;
+}
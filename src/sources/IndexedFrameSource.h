@@ -0,0 +1,73 @@
+#pragma once
+
+#include "FrameSource.h"
+#include "KeyframeIndex.h"
+#include "../utils/FrameCache.h"
+#include <atomic>
+#include <memory>
+
+/**
+ * @brief Frame source that makes seeking in a decoded video cheap
+ *
+ * Wraps another source, normally a CaptureFrameSource, and uses a
+ * KeyframeIndex of the file:
+ *
+ * - a seek only records the target; the next grab() positions the inner
+ *   source, so seekToFrame() returns immediately and the work happens on
+ *   the reading thread;
+ * - a target ahead of the decoder in the same GOP is reached by decoding
+ *   forward, without seeking at all;
+ * - otherwise the inner source seeks so that it starts decoding at the
+ *   keyframe a plain seek to the target starts at, and the rest of the
+ *   way is decoded here;
+ * - decoded frames, including those passed on the way to a target, go
+ *   into a FrameCache, so stepping back into recently decoded GOPs does
+ *   not decode anything.
+ *
+ * seek() may be called from another thread than the one reading.
+ */
+class IndexedFrameSource : public FrameSource {
+public:
+    /**
+     * @brief Wrap a source
+     *
+     * @param inner Source to read from
+     * @param index Keyframe index of the same video; may still be building
+     * @param cacheBytes Memory for decoded frames; 0 disables the cache
+     */
+    IndexedFrameSource(std::unique_ptr<FrameSource> inner, std::shared_ptr<KeyframeIndex> index,
+                       size_t cacheBytes);
+
+    bool grab() override;
+    bool retrieve(cv::Mat& frame) override;
+    bool isKeyframe() const override;
+    bool indexKeyframes() override;
+    bool seek(int frameIndex) override;
+    int getPosition() const override;
+    int getFrameCount() const override;
+    cv::Size getFrameSize() const override;
+    double getFps() const override;
+
+    /**
+     * @brief Get usage counters of the decoded frame cache
+     *
+     * @return Cache statistics
+     */
+    FrameCache::Stats getCacheStats() const;
+
+private:
+    std::unique_ptr<FrameSource> inner;
+    std::shared_ptr<KeyframeIndex> index;
+    FrameCache cache;
+    size_t cacheFrames;             ///< Frames that fit in the cache
+
+    std::atomic<int> position;      ///< Next frame to hand out
+    int innerPosition;              ///< Next frame the inner source produces
+    int grabbed;                    ///< Frame passed by the last grab(), -1 if none
+    bool grabbedFromCache;
+    cv::Mat scratch;
+
+    // Bring the inner source to `target`, decoding forward from the
+    // nearest keyframe or the current position, whichever is closer
+    bool moveInnerTo(int target);
+};
@@ -0,0 +1,201 @@
+#include "KeyframeIndex.h"
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+// v1 indices counted packets, which differs from the display order
+// around reordered frames
+const char* const SIDECAR_HEADER = "VideoFilterApp keyframe index v2";
+
+// Publish scan progress in steps, so lookups rarely contend with the scan
+constexpr int PUBLISH_INTERVAL = 256;
+
+uintmax_t fileSize(const std::string& filename) {
+    std::error_code error;
+    uintmax_t size = std::filesystem::file_size(filename, error);
+    return error ? 0 : size;
+}
+
+}  // namespace
+
+KeyframeIndex::KeyframeIndex()
+    : scannedFrames(0), scanEnded(false), complete(false), stopRequested(false) {
+}
+
+KeyframeIndex::~KeyframeIndex() {
+    stopRequested = true;
+    if (builder.joinable()) {
+        builder.join();
+    }
+}
+
+void KeyframeIndex::build(const std::string& filename, bool useSidecar) {
+    if (useSidecar && load(filename)) {
+        return;
+    }
+    builder = std::thread([this, filename, useSidecar] {
+        scan(filename, useSidecar);
+        endScan();
+    });
+}
+
+bool KeyframeIndex::isComplete() const {
+    return complete;
+}
+
+int KeyframeIndex::keyframeAtOrBefore(int frame) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (frame < 0 || (!complete && frame >= scannedFrames)) {
+        return -1;
+    }
+    auto next = std::upper_bound(keyframes.begin(), keyframes.end(), frame);
+    return next == keyframes.begin() ? -1 : *(next - 1);
+}
+
+bool KeyframeIndex::waitUntilScanned(int frame) const {
+    std::unique_lock<std::mutex> lock(mutex);
+    progress.wait(lock, [&] { return complete || scanEnded || frame < scannedFrames; });
+    // A stream whose first packets carry no keyframe flag has none at all
+    return complete || (!scanEnded && frame < scannedFrames && !keyframes.empty());
+}
+
+bool KeyframeIndex::isKeyframe(int frame) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return std::binary_search(keyframes.begin(), keyframes.end(), frame);
+}
+
+size_t KeyframeIndex::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return keyframes.size();
+}
+
+std::string KeyframeIndex::sidecarPath(const std::string& filename) {
+    return filename + ".keyframes";
+}
+
+void KeyframeIndex::scan(std::string filename, bool saveSidecar) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 7)
+    // Raw mode hands out packets instead of decoded frames, so grab() only demuxes
+    cv::VideoCapture demuxer(filename, cv::CAP_FFMPEG, {cv::CAP_PROP_FORMAT, -1});
+    if (!demuxer.isOpened()) {
+        std::cerr << "Warning: Could not index keyframes of " << filename << std::endl;
+        return;
+    }
+
+    // Packets come in decode order; their timestamps, which the backend
+    // reports in frames, give the display position that seeks count in.
+    // Where they are missing or go backwards the packet count stands in.
+    std::vector<int> found;
+    int frame = 0;
+    int previous = -1;
+    double origin = 0.0;
+    while (!stopRequested && demuxer.grab()) {
+        double pts = demuxer.get(cv::CAP_PROP_PTS);
+        if (frame == 0) {
+            origin = pts;
+        }
+        if (demuxer.get(cv::CAP_PROP_LRF_HAS_KEY_FRAME) != 0) {
+            int position = static_cast<int>(std::lround(pts - origin));
+            if (position <= previous) {
+                position = std::max(frame, previous + 1);
+            }
+            found.push_back(position);
+            previous = position;
+        }
+        ++frame;
+
+        if (frame % PUBLISH_INTERVAL == 0) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                keyframes.insert(keyframes.end(), found.begin(), found.end());
+                scannedFrames = frame;
+                found.clear();
+            }
+            progress.notify_all();
+        }
+    }
+    if (stopRequested) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        keyframes.insert(keyframes.end(), found.begin(), found.end());
+        scannedFrames = frame;
+    }
+    if (keyframes.empty()) {
+        // The backend does not flag keyframes; an empty index answers nothing
+        return;
+    }
+    complete = true;
+
+    if (saveSidecar && !save(filename)) {
+        std::cerr << "Warning: Could not write " << sidecarPath(filename) << std::endl;
+    }
+#else
+    (void)filename;
+    (void)saveSidecar;
+#endif
+}
+
+void KeyframeIndex::endScan() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        scanEnded = true;
+    }
+    progress.notify_all();
+}
+
+bool KeyframeIndex::load(const std::string& filename) {
+    std::ifstream file(sidecarPath(filename));
+    std::string header;
+    if (!file || !std::getline(file, header) || header != SIDECAR_HEADER) {
+        return false;
+    }
+
+    // The index is only valid for the file it was built from
+    uintmax_t size = 0;
+    int frames = 0;
+    std::string sizeKey;
+    std::string framesKey;
+    if (!(file >> sizeKey >> size >> framesKey >> frames) || sizeKey != "size" ||
+        framesKey != "frames" || size != fileSize(filename)) {
+        return false;
+    }
+
+    std::vector<int> loaded;
+    int keyframe = 0;
+    while (file >> keyframe) {
+        loaded.push_back(keyframe);
+    }
+    if (loaded.empty() || !std::is_sorted(loaded.begin(), loaded.end())) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    keyframes = std::move(loaded);
+    scannedFrames = frames;
+    complete = true;
+    return true;
+}
+
+bool KeyframeIndex::save(const std::string& filename) const {
+    std::ofstream file(sidecarPath(filename));
+    if (!file) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    file << SIDECAR_HEADER << "\n";
+    file << "size " << fileSize(filename) << "\n";
+    file << "frames " << scannedFrames << "\n";
+    for (int keyframe : keyframes) {
+        file << keyframe << "\n";
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Positions of the keyframes of a video file
+ *
+ * The index is built on a background thread by demuxing the file with a
+ * second cv::VideoCapture in raw packet mode, which reads the keyframe
+ * flag of every packet without decoding anything. It can be used while it
+ * is being built: lookups for frames the scan has already passed are
+ * answered, later ones report that the index does not know yet.
+ *
+ * Optionally the index is stored next to the video as
+ * "<video>.keyframes" and reused while the file size is unchanged.
+ *
+ * Keyframes are listed by their position in display order, the order
+ * frame indices and seeks count in. The scan sees packets in decode
+ * order, which differs wherever frames are reordered, so it converts each
+ * keyframe's presentation timestamp into a frame position. Without
+ * timestamps (OpenCV before 4.7 or a stream lacking them) it falls back to
+ * the packet count. That matches the display order at keyframes for
+ * closed GOPs; with open GOPs a keyframe may then be reported a few frames
+ * early, which only costs a little extra decoding.
+ */
+class KeyframeIndex {
+public:
+    KeyframeIndex();
+
+    /**
+     * @brief Stop a build that is still running
+     */
+    ~KeyframeIndex();
+
+    KeyframeIndex(const KeyframeIndex&) = delete;
+    KeyframeIndex& operator=(const KeyframeIndex&) = delete;
+
+    /**
+     * @brief Load the sidecar file or start building the index in the background
+     *
+     * @param filename Video file to index
+     * @param useSidecar Load the index from, and save it to, the sidecar file
+     */
+    void build(const std::string& filename, bool useSidecar);
+
+    /**
+     * @brief Check whether the whole file has been indexed
+     *
+     * @return true once every packet was scanned or the index was loaded
+     */
+    bool isComplete() const;
+
+    /**
+     * @brief Find the last keyframe at or before a frame
+     *
+     * @param frame Frame index in display order
+     * @return Keyframe index, or -1 if the scan has not reached the frame yet
+     */
+    int keyframeAtOrBefore(int frame) const;
+
+    /**
+     * @brief Wait until the index can answer for a frame
+     *
+     * The scan demuxes far faster than frames decode, so a reader waits
+     * at most for one batch of packets.
+     *
+     * @param frame Frame index in display order
+     * @return true once the scan has passed the frame, false if the index
+     *         cannot be built (OpenCV before 4.7, no FFmpeg backend, or no
+     *         keyframe flags in the stream)
+     */
+    bool waitUntilScanned(int frame) const;
+
+    /**
+     * @brief Check whether a frame is a keyframe
+     *
+     * @param frame Frame index
+     * @return true if the index lists the frame as a keyframe
+     */
+    bool isKeyframe(int frame) const;
+
+    /**
+     * @brief Get the number of keyframes found so far
+     *
+     * @return Keyframe count
+     */
+    size_t size() const;
+
+    /**
+     * @brief Get the sidecar file name for a video
+     *
+     * @param filename Video file
+     * @return Path of its keyframe index
+     */
+    static std::string sidecarPath(const std::string& filename);
+
+private:
+    mutable std::mutex mutex;
+    std::vector<int> keyframes;     ///< Display positions, ascending
+    int scannedFrames;              ///< Frames the scan has passed
+    bool scanEnded;                 ///< The scan stopped, whether or not it succeeded
+    mutable std::condition_variable progress;
+    std::atomic<bool> complete;
+    std::atomic<bool> stopRequested;
+    std::thread builder;
+
+    void scan(std::string filename, bool saveSidecar);
+    void endScan();
+    bool load(const std::string& filename);
+    bool save(const std::string& filename) const;
+};
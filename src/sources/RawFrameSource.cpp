@@ -0,0 +1,108 @@
+#include "RawFrameSource.h"
+#include <iostream>
+
+bool RawFrameSource::open(const std::string& filename, cv::Size frameSize, double frameRate) {
+    file.close();
+    file.clear();
+    file.open(filename, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    size = frameSize;
+    fps = frameRate;
+    position = 0;
+    filePosition = 0;
+    grabbed = -1;
+
+    file.seekg(0, std::ios::end);
+    std::streamoff length = file.tellg();
+    file.seekg(0, std::ios::beg);
+    frameCount = static_cast<int>(length / static_cast<std::streamoff>(frameBytes()));
+    if (length % static_cast<std::streamoff>(frameBytes()) != 0) {
+        std::cerr << "Warning: " << filename << " ends with a partial frame; is the frame size right?"
+                  << std::endl;
+    }
+    return frameCount > 0;
+}
+
+bool RawFrameSource::parseFormat(const std::string& text, cv::Size& frameSize, double& frameRate) {
+    size_t times = text.find('x');
+    if (times == std::string::npos) {
+        return false;
+    }
+    size_t at = text.find('@', times);
+
+    try {
+        frameSize.width = std::stoi(text.substr(0, times));
+        frameSize.height = std::stoi(text.substr(times + 1, at == std::string::npos ? std::string::npos : at - times - 1));
+        frameRate = at == std::string::npos ? 30.0 : std::stod(text.substr(at + 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    return frameSize.width > 0 && frameSize.height > 0 && frameRate > 0;
+}
+
+bool RawFrameSource::grab() {
+    if (position >= frameCount) {
+        grabbed = -1;
+        return false;
+    }
+    grabbed = position++;
+    return true;
+}
+
+bool RawFrameSource::retrieve(cv::Mat& frame) {
+    if (grabbed < 0) {
+        return false;
+    }
+    if (filePosition != grabbed) {
+        file.clear();
+        file.seekg(static_cast<std::streamoff>(grabbed) * static_cast<std::streamoff>(frameBytes()));
+    }
+    frame.create(size, CV_8UC3);
+
+    // Pooled frames are continuous, so this is normally one read per frame
+    if (frame.isContinuous()) {
+        file.read(reinterpret_cast<char*>(frame.data), static_cast<std::streamsize>(frameBytes()));
+    } else {
+        std::streamsize rowBytes = static_cast<std::streamsize>(size.width) * 3;
+        for (int y = 0; y < size.height && file; ++y) {
+            file.read(reinterpret_cast<char*>(frame.ptr(y)), rowBytes);
+        }
+    }
+    if (!file) {
+        filePosition = -1;
+        return false;
+    }
+    filePosition = grabbed + 1;
+    return true;
+}
+
+bool RawFrameSource::seek(int frameIndex) {
+    if (frameIndex < 0 || frameIndex > frameCount) {
+        return false;
+    }
+    position = frameIndex;
+    grabbed = -1;
+    return true;
+}
+
+int RawFrameSource::getPosition() const {
+    return position;
+}
+
+int RawFrameSource::getFrameCount() const {
+    return frameCount;
+}
+
+cv::Size RawFrameSource::getFrameSize() const {
+    return size;
+}
+
+double RawFrameSource::getFps() const {
+    return fps;
+}
+
+size_t RawFrameSource::frameBytes() const {
+    return static_cast<size_t>(size.width) * size.height * 3;
+}
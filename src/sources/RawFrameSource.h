@@ -0,0 +1,57 @@
+#pragma once
+
+#include "FrameSource.h"
+#include <fstream>
+#include <string>
+
+/**
+ * @brief Frame source that reads headerless packed BGR frames from a file
+ *
+ * The file holds frames of width * height * 3 bytes back to back, as
+ * written by e.g. `ffmpeg -i in.mp4 -f rawvideo -pix_fmt bgr24 out.bgr`.
+ * Reading is a plain file read straight into the frame buffer, so a clip
+ * that fits in the page cache replays without any decoding cost, and
+ * seeking is exact. Grabbing only moves the position; a skipped frame is
+ * never read from the file.
+ */
+class RawFrameSource : public FrameSource {
+public:
+    /**
+     * @brief Open a raw frame file
+     *
+     * @param filename Path to the file
+     * @param size Size of every frame
+     * @param fps Nominal frame rate
+     * @return true if the file was opened and holds at least one frame
+     */
+    bool open(const std::string& filename, cv::Size size, double fps);
+
+    /**
+     * @brief Parse a frame format of the form WIDTHxHEIGHT[@FPS]
+     *
+     * @param text Format, e.g. "1920x1080@30"; the frame rate defaults to 30
+     * @param size Receives the frame size
+     * @param fps Receives the frame rate
+     * @return true if the format is valid
+     */
+    static bool parseFormat(const std::string& text, cv::Size& size, double& fps);
+
+    bool grab() override;
+    bool retrieve(cv::Mat& frame) override;
+    bool seek(int frameIndex) override;
+    int getPosition() const override;
+    int getFrameCount() const override;
+    cv::Size getFrameSize() const override;
+    double getFps() const override;
+
+private:
+    std::ifstream file;
+    cv::Size size;
+    double fps = 0.0;
+    int frameCount = 0;
+    int position = 0;
+    int filePosition = 0;   ///< Frame the file pointer is at
+    int grabbed = -1;       ///< Frame passed by the last grab(), -1 if none
+
+    size_t frameBytes() const;
+};
@@ -0,0 +1,248 @@
+#include "SyntheticFrameSource.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+// Rows the noise image is rotated by from one frame to the next; odd and
+// not a divisor of common frame heights, so the noise does not repeat soon
+constexpr int NOISE_ROW_STEP = 37;
+
+void addNoise(const uchar* src, const uchar* noise, uchar* dst, size_t count, int amplitude) {
+    for (size_t i = 0; i < count; ++i) {
+        int value = src[i] + noise[i] - amplitude;
+        dst[i] = static_cast<uchar>(std::min(255, std::max(0, value)));
+    }
+}
+
+bool parsePattern(const std::string& name, SyntheticFrameSource::Pattern& pattern) {
+    if (name == "bars") {
+        pattern = SyntheticFrameSource::Pattern::Bars;
+    } else if (name == "gradient") {
+        pattern = SyntheticFrameSource::Pattern::Gradient;
+    } else if (name == "checker") {
+        pattern = SyntheticFrameSource::Pattern::Checker;
+    } else if (name == "scene") {
+        pattern = SyntheticFrameSource::Pattern::Scene;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+SyntheticFrameSource::SyntheticFrameSource(const Options& options)
+    : options(options), position(0), grabbed(-1) {
+    renderPattern();
+
+    if (options.noise > 0) {
+        noise.create(options.size, CV_8UC3);
+        cv::RNG rng(options.seed ^ 0x9e3779b97f4a7c15ULL);
+        rng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(2 * options.noise + 1));
+    }
+}
+
+bool SyntheticFrameSource::parseOptions(const std::string& text, Options& options) {
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ':')) {
+        if (part.empty()) {
+            continue;
+        }
+        size_t equals = part.find('=');
+        if (equals == std::string::npos) {
+            std::cerr << "Error: Expected key=value in synthetic source spec: " << part << std::endl;
+            return false;
+        }
+        std::string key = part.substr(0, equals);
+        std::string value = part.substr(equals + 1);
+
+        bool valid = true;
+        try {
+            if (key == "width") {
+                options.size.width = std::stoi(value);
+                valid = options.size.width > 0;
+            } else if (key == "height") {
+                options.size.height = std::stoi(value);
+                valid = options.size.height > 0;
+            } else if (key == "fps") {
+                options.fps = std::stod(value);
+                valid = options.fps > 0;
+            } else if (key == "frames") {
+                options.frameCount = std::stoi(value);
+                valid = options.frameCount >= 0;
+            } else if (key == "pattern") {
+                valid = parsePattern(value, options.pattern);
+            } else if (key == "motion") {
+                options.motion = std::stoi(value);
+            } else if (key == "noise") {
+                options.noise = std::stoi(value);
+                valid = options.noise >= 0 && options.noise <= 127;
+            } else if (key == "seed") {
+                options.seed = std::stoull(value);
+            } else if (key == "gop") {
+                options.keyframeInterval = std::stoi(value);
+                valid = options.keyframeInterval > 0;
+            } else {
+                std::cerr << "Error: Unknown synthetic source setting '" << key
+                          << "'. Available: width, height, fps, frames, pattern, motion, noise, seed, gop"
+                          << std::endl;
+                return false;
+            }
+        } catch (const std::exception&) {
+            valid = false;
+        }
+
+        if (!valid) {
+            std::cerr << "Error: Invalid value in synthetic source spec: " << part << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+bool SyntheticFrameSource::grab() {
+    if (options.frameCount > 0 && position >= options.frameCount) {
+        grabbed = -1;
+        return false;
+    }
+    grabbed = position++;
+    return true;
+}
+
+bool SyntheticFrameSource::retrieve(cv::Mat& frame) {
+    if (grabbed < 0) {
+        return false;
+    }
+    render(grabbed, frame);
+    return true;
+}
+
+bool SyntheticFrameSource::isKeyframe() const {
+    return grabbed >= 0 && grabbed % options.keyframeInterval == 0;
+}
+
+bool SyntheticFrameSource::seek(int frameIndex) {
+    if (frameIndex < 0 || (options.frameCount > 0 && frameIndex > options.frameCount)) {
+        return false;
+    }
+    position = frameIndex;
+    grabbed = -1;
+    return true;
+}
+
+int SyntheticFrameSource::getPosition() const {
+    return position;
+}
+
+int SyntheticFrameSource::getFrameCount() const {
+    return options.frameCount;
+}
+
+cv::Size SyntheticFrameSource::getFrameSize() const {
+    return options.size;
+}
+
+double SyntheticFrameSource::getFps() const {
+    return options.fps;
+}
+
+void SyntheticFrameSource::render(int frameIndex, cv::Mat& frame) const {
+    const int width = options.size.width;
+    const int height = options.size.height;
+    frame.create(options.size, CV_8UC3);
+
+    // Scroll by rotating every row: the pattern from column `shift` on
+    // comes first, then its first `shift` columns
+    int shift = static_cast<int>(static_cast<int64_t>(frameIndex) * options.motion % width);
+    if (shift < 0) {
+        shift += width;
+    }
+    const size_t headBytes = static_cast<size_t>(width - shift) * 3;
+    const size_t tailBytes = static_cast<size_t>(shift) * 3;
+    const int noiseOffset = static_cast<int>(static_cast<int64_t>(frameIndex) * NOISE_ROW_STEP % height);
+
+    for (int y = 0; y < height; ++y) {
+        const uchar* src = pattern.ptr<uchar>(y);
+        uchar* dst = frame.ptr<uchar>(y);
+        if (options.noise == 0) {
+            std::memcpy(dst, src + tailBytes, headBytes);
+            std::memcpy(dst + headBytes, src, tailBytes);
+        } else {
+            const uchar* noiseRow = noise.ptr<uchar>((y + noiseOffset) % height);
+            addNoise(src + tailBytes, noiseRow, dst, headBytes, options.noise);
+            addNoise(src, noiseRow + headBytes, dst + headBytes, tailBytes, options.noise);
+        }
+    }
+}
+
+void SyntheticFrameSource::renderPattern() {
+    const int width = options.size.width;
+    const int height = options.size.height;
+    pattern.create(options.size, CV_8UC3);
+
+    switch (options.pattern) {
+    case Pattern::Bars: {
+        // 75% bars: white, yellow, cyan, green, magenta, red, blue, black
+        static const cv::Vec3b BARS[] = {
+            {191, 191, 191}, {0, 191, 191}, {191, 191, 0}, {0, 191, 0},
+            {191, 0, 191}, {0, 0, 191}, {191, 0, 0}, {0, 0, 0},
+        };
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b* row = pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width; ++x) {
+                row[x] = BARS[x * 8 / width];
+            }
+        }
+        break;
+    }
+    case Pattern::Gradient:
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b* row = pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width; ++x) {
+                int blue = 255 * x / width;
+                int green = 255 * y / height;
+                row[x] = cv::Vec3b(static_cast<uchar>(blue), static_cast<uchar>(green),
+                                   static_cast<uchar>(255 - (blue + green) / 2));
+            }
+        }
+        break;
+    case Pattern::Checker: {
+        int square = std::max(8, height / 9);
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b* row = pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width; ++x) {
+                uchar level = ((x / square + y / square) & 1) ? 235 : 16;
+                row[x] = cv::Vec3b(level, level, level);
+            }
+        }
+        break;
+    }
+    case Pattern::Scene: {
+        for (int y = 0; y < height; ++y) {
+            cv::Vec3b* row = pattern.ptr<cv::Vec3b>(y);
+            for (int x = 0; x < width; ++x) {
+                uchar shade = static_cast<uchar>(64 + 96 * x / width + 64 * y / height);
+                row[x] = cv::Vec3b(shade, static_cast<uchar>(shade / 2 + 40), static_cast<uchar>(200 - shade / 2));
+            }
+        }
+
+        cv::RNG rng(options.seed);
+        int shapes = std::max(1, options.size.area() / 20000);
+        for (int i = 0; i < shapes; ++i) {
+            cv::Point centre(rng.uniform(0, width), rng.uniform(0, height));
+            cv::Scalar colour(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+            int extent = std::max(1, rng.uniform(height / 80, height / 10 + 1));
+            if (i % 2 == 0) {
+                cv::circle(pattern, centre, extent, colour, cv::FILLED);
+            } else {
+                cv::rectangle(pattern, cv::Rect(centre.x, centre.y, extent * 2, extent), colour, cv::FILLED);
+            }
+        }
+        break;
+    }
+    }
+}
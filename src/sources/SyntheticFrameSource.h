@@ -0,0 +1,93 @@
+#pragma once
+
+#include "FrameSource.h"
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Frame source that generates deterministic frames in memory
+ *
+ * Feeds the pipeline without a decoder, so filter and pipeline throughput
+ * can be measured without codec cost and its run-to-run variation. Frame
+ * n depends only on the options and n, which makes every run and every
+ * seek reproducible.
+ *
+ * The pattern is rendered once when the source is created. Each frame is
+ * that pattern scrolled sideways by `motion` pixels per frame, plus
+ * optional noise taken from a pregenerated noise image with its rows
+ * rotated per frame, so producing a frame costs about one frame copy.
+ */
+class SyntheticFrameSource : public FrameSource {
+public:
+    /**
+     * @brief Test patterns
+     */
+    enum class Pattern {
+        Bars,       ///< Eight vertical colour bars
+        Gradient,   ///< Diagonal colour gradient
+        Checker,    ///< Black and white checkerboard
+        Scene       ///< Shaded background with filled shapes
+    };
+
+    /**
+     * @brief Generator settings
+     */
+    struct Options {
+        cv::Size size = cv::Size(1280, 720);
+        double fps = 30.0;
+        int frameCount = 300;           ///< Frames before the end; 0 generates frames forever
+        Pattern pattern = Pattern::Scene;
+        int motion = 4;                 ///< Pixels the pattern scrolls left per frame
+        int noise = 0;                  ///< Peak noise added to or subtracted from each channel
+        uint64_t seed = 1;              ///< Seed of the shapes and the noise
+        int keyframeInterval = 30;      ///< Frames between frames reported as keyframes
+    };
+
+    /**
+     * @brief Create a generator
+     *
+     * @param options Generator settings; they must be valid (see parseOptions())
+     */
+    explicit SyntheticFrameSource(const Options& options);
+
+    /**
+     * @brief Parse colon-separated key=value settings
+     *
+     * Keys are width, height, fps, frames, pattern (bars, gradient,
+     * checker or scene), motion, noise, seed and gop (keyframe
+     * interval), e.g.
+     * "width=1920:height=1080:pattern=bars:noise=8". Keys that are not
+     * given keep their value in options.
+     *
+     * @param text Settings to parse
+     * @param options Receives the settings
+     * @return true if every setting was valid
+     */
+    static bool parseOptions(const std::string& text, Options& options);
+
+    bool grab() override;
+    bool retrieve(cv::Mat& frame) override;
+    bool isKeyframe() const override;
+    bool seek(int frameIndex) override;
+    int getPosition() const override;
+    int getFrameCount() const override;
+    cv::Size getFrameSize() const override;
+    double getFps() const override;
+
+    /**
+     * @brief Render a frame without moving the read position
+     *
+     * @param frameIndex Index of the frame
+     * @param frame Receives the frame
+     */
+    void render(int frameIndex, cv::Mat& frame) const;
+
+private:
+    Options options;
+    cv::Mat pattern;
+    cv::Mat noise;      ///< Values 0..2*noise, centred on noise
+    int position;
+    int grabbed;        ///< Frame passed by the last grab(), -1 if none
+
+    void renderPattern();
+};
@@ -1,18 +1,51 @@
 #include "UserInterface.h"
 #include "../filters/GaussianBlurFilter.h"
 #include "../filters/EdgeDetectionFilter.h"
+#include "../filters/ColorEnhanceFilter.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <sstream>
+#include <thread>
 
 // Constants for UI
 const int DISPLAY_WIDTH = 1280;
 const int DISPLAY_HEIGHT = 720;
+const int SEEK_JUMP_SECONDS = 5;
+const double BLUR_SIGMA_STEP = 1.25;
+const double MIN_BLUR_SIGMA = 0.5;
+const double MAX_BLUR_SIGMA = 20.0;
+const double DEFAULT_MAX_REFRESH_RATE = 60.0;
+const int IDLE_WAIT_MS = 50;     // Longest the loop sleeps before checking for keys
+
+namespace {
+
+// Darken a rectangle as if a black panel of the given opacity covered it;
+// only the pixels under the panel are touched
+void shadeRegion(cv::Mat& frame, cv::Rect rect, double opacity) {
+    cv::Mat region = frame(rect & cv::Rect(0, 0, frame.cols, frame.rows));
+    region.convertTo(region, -1, 1.0 - opacity);
+}
+
+// Handle pending window events and return a key press, without blocking
+int pollKeyPress() {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    return cv::pollKey();
+#else
+    return cv::waitKey(1);
+#endif
+}
+
+}  // namespace
 
 UserInterface::UserInterface(std::shared_ptr<VideoProcessor> processor)
-    : processor(processor), windowName("Video Filter App"), running(false) {
+    : processor(processor), windowName("Video Filter App"), running(false), blurSigma(1.5),
+      maxRefreshRate(DEFAULT_MAX_REFRESH_RATE) {
     // Initialize the UI
     cv::namedWindow(windowName, cv::WINDOW_NORMAL);
     cv::resizeWindow(windowName, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+    processor->setDisplaySize(cv::Size(DISPLAY_WIDTH, DISPLAY_HEIGHT));
     
     // Initialize available filters
     initializeFilters();
@@ -30,14 +63,38 @@ int UserInterface::run() {
     drawControls(blankFrame);
     cv::imshow(windowName, blankFrame);
     
-    // Main event loop
+    // Main event loop: sleep until the processor has a new frame, then
+    // repaint, no sooner than the refresh cap allows. While paused or
+    // hidden the loop only wakes up to check for keys.
+    auto nextRepaint = std::chrono::steady_clock::now();
     while (running) {
-        updateDisplay();
+        std::this_thread::sleep_until(nextRepaint);
+        bool repaint = false;
+        if (isWindowVisible()) {
+            repaint = processor->waitForDisplayFrame(std::chrono::milliseconds(IDLE_WAIT_MS));
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_WAIT_MS));
+        }
         
-        // Handle keyboard input (30ms wait for key)
-        int key = cv::waitKey(30);
+        // Handle keyboard input
+        int key = pollKeyPress();
         if (key > 0) {
             handleKeyPress(key);
+            repaint = true;
+        }
+        
+        // Parameter changes show on the paused frame right away
+        if (processor->refreshPausedFrame()) {
+            repaint = true;
+        }
+        
+        if (repaint) {
+            updateDisplay();
+            if (maxRefreshRate > 0) {
+                nextRepaint = std::chrono::steady_clock::now() +
+                              std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                  std::chrono::duration<double>(1.0 / maxRefreshRate));
+            }
         }
     }
     
@@ -45,6 +102,15 @@ int UserInterface::run() {
     return 0;
 }
 
+void UserInterface::setMaxRefreshRate(double rate) {
+    maxRefreshRate = std::max(0.0, rate);
+}
+
+bool UserInterface::isWindowVisible() const {
+    // Backends that cannot tell report a negative value
+    return cv::getWindowProperty(windowName, cv::WND_PROP_VISIBLE) != 0;
+}
+
 void UserInterface::onOpenFile() {
     // Use FileDialog to open a file explorer window
     std::string filename = FileDialog::openFile("Open Video File", "", {"*.mp4", "*.avi", "*.mkv"});
@@ -89,6 +155,22 @@ void UserInterface::onSaveVideo() {
     }
 }
 
+void UserInterface::onSeek(int frameOffset) {
+    int target = processor->getCurrentFramePosition() + frameOffset;
+    int lastFrame = processor->getTotalFrames() - 1;
+    processor->seekToFrame(std::max(0, std::min(target, lastFrame)));
+}
+
+void UserInterface::onTuneBlur(double factor) {
+    blurSigma = std::max(MIN_BLUR_SIGMA, std::min(blurSigma * factor, MAX_BLUR_SIGMA));
+
+    // Grow the kernel with sigma so that it covers about three sigmas
+    int kernelSize = 2 * static_cast<int>(std::ceil(3.0 * blurSigma)) + 1;
+    availableFilters[0]->configure({{"sigmaX", blurSigma}, {"sigmaY", blurSigma},
+                                    {"kernelSize", static_cast<double>(kernelSize)}});
+    std::cout << "Blur sigma: " << blurSigma << std::endl;
+}
+
 void UserInterface::handleKeyPress(int key) {
     switch (key) {
         case 27:  // ESC key
@@ -111,6 +193,28 @@ void UserInterface::handleKeyPress(int key) {
         case '2':
             onAddFilter(1);  // Edge detection
             break;
+        case '3':
+            onAddFilter(2);  // Color enhancement
+            break;
+        case ',':
+            onSeek(-1);  // One frame back
+            break;
+        case '.':
+            onSeek(1);   // One frame forward
+            break;
+        case '[':
+            onSeek(-SEEK_JUMP_SECONDS * std::max(1, static_cast<int>(processor->getFps())));
+            break;
+        case ']':
+            onSeek(SEEK_JUMP_SECONDS * std::max(1, static_cast<int>(processor->getFps())));
+            break;
+        case '+':
+        case '=':
+            onTuneBlur(BLUR_SIGMA_STEP);
+            break;
+        case '-':
+            onTuneBlur(1.0 / BLUR_SIGMA_STEP);
+            break;
         case 'q':
         case 'Q':
             running = false;
@@ -125,41 +229,43 @@ void UserInterface::handleKeyPress(int key) {
 }
 
 void UserInterface::updateDisplay() {
-    if (processor->isProcessing()) {
-        cv::Mat frame = processor->getLatestFrame();
-        
-        if (!frame.empty()) {
-            // Resize for display if needed
-            if (frame.cols != DISPLAY_WIDTH || frame.rows != DISPLAY_HEIGHT) {
-                cv::resize(frame, frame, cv::Size(DISPLAY_WIDTH, DISPLAY_HEIGHT));
-            }
-            
-            // Add UI elements
-            drawControls(frame);
-            drawPerformanceInfo(frame);
+    // A hidden or minimized window needs no frames, so none are scaled
+    if (!isWindowVisible()) {
+        return;
+    }
+    
+    // Taking the frame also keeps a stopped pipeline from waking the loop
+    // again with the same one
+    cv::Mat displayFrame;
+    if (!processor->getDisplayFrame(displayFrame)) {
+        return;
+    }
+    
+    // The display frame already has the display size; the overlays go on a
+    // copy so it stays clean for the next repaint
+    displayFrame.copyTo(canvas);
+    cv::Mat& frame = canvas;
+    
+    // Add UI elements
+    drawControls(frame);
+    drawPerformanceInfo(frame);
 
-            // Check for video ended state
-            if (processor->hasVideoEnded()) {
-                // Add a "Video Ended" message
-                cv::Mat overlay;
-                frame.copyTo(overlay);
-                cv::rectangle(overlay, cv::Rect(frame.cols/2 - 150, frame.rows/2 - 40, 300, 80),
-                           cv::Scalar(0, 0, 0), -1);
-                cv::addWeighted(overlay, 0.7, frame, 0.3, 0, frame);
-
-                cv::putText(frame, "Video Ended",
-                         cv::Point(frame.cols/2 - 100, frame.rows/2),
-                         cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 2);
-
-                cv::putText(frame, "Press 'R' to restart",
-                         cv::Point(frame.cols/2 - 130, frame.rows/2 + 30),
-                         cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 1);
-            }
-            
-            // Display the frame
-            cv::imshow(windowName, frame);
-        }
+    // Check for video ended state
+    if (processor->hasVideoEnded()) {
+        // Add a "Video Ended" message
+        shadeRegion(frame, cv::Rect(frame.cols/2 - 150, frame.rows/2 - 40, 300, 80), 0.7);
+
+        cv::putText(frame, "Video Ended",
+                 cv::Point(frame.cols/2 - 100, frame.rows/2),
+                 cv::FONT_HERSHEY_SIMPLEX, 1.0, cv::Scalar(255, 255, 255), 2);
+
+        cv::putText(frame, "Press 'R' to restart",
+                 cv::Point(frame.cols/2 - 130, frame.rows/2 + 30),
+                 cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(255, 255, 255), 1);
     }
+    
+    // Display the frame
+    cv::imshow(windowName, frame);
 }
 
 void UserInterface::drawControls(cv::Mat& frame) {
@@ -169,10 +275,7 @@ void UserInterface::drawControls(cv::Mat& frame) {
     cv::Scalar bgColor(0, 0, 0, 0.7);
     
     // Create a semi-transparent overlay for controls
-    cv::Mat overlay;
-    frame.copyTo(overlay);
-    cv::rectangle(overlay, cv::Rect(10, 10, 350, 200), cv::Scalar(0, 0, 0), -1);
-    cv::addWeighted(overlay, 0.5, frame, 0.5, 0, frame);
+    shadeRegion(frame, cv::Rect(10, 10, 350, 320), 0.5);
     
     // Add control instructions
     cv::putText(frame, "Controls:", cv::Point(20, y), 
@@ -199,6 +302,22 @@ void UserInterface::drawControls(cv::Mat& frame) {
                 cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
     y += lineHeight;
     
+    cv::putText(frame, "3 - Add Color Enhance filter", cv::Point(20, y), 
+                cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
+    y += lineHeight;
+    
+    cv::putText(frame, ", / . - Step back / forward", cv::Point(20, y), 
+                cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
+    y += lineHeight;
+    
+    cv::putText(frame, "[ / ] - Jump 5 s back / forward", cv::Point(20, y), 
+                cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
+    y += lineHeight;
+    
+    cv::putText(frame, "+ / - - Blur sigma up / down", cv::Point(20, y), 
+                cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
+    y += lineHeight;
+    
     cv::putText(frame, "ESC/Q - Quit", cv::Point(20, y), 
                 cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
 }
@@ -206,13 +325,21 @@ void UserInterface::drawControls(cv::Mat& frame) {
 void UserInterface::drawPerformanceInfo(cv::Mat& frame) {
     int y = 30;
     int lineHeight = 30;
+    int statLineHeight = 22;
     cv::Scalar textColor(255, 255, 255);
     
+    const PerformanceMonitor& monitor = processor->getPerformanceMonitor();
+    std::vector<PerformanceMonitor::StageStats> stages = monitor.getStageStats();
+    std::vector<PerformanceMonitor::QueueStats> queues = monitor.getQueueStats();
+    FrameCache::Stats cache = processor->getFilterCacheStats();
+    bool showCache = cache.budget > 0;
+    QualityGovernor::Stats quality = processor->getQualityStats();
+    bool showQuality = quality.budgetMs > 0;
+    
     // Create a semi-transparent overlay for performance info
-    cv::Mat overlay;
-    frame.copyTo(overlay);
-    cv::rectangle(overlay, cv::Rect(frame.cols - 350, 10, 340, 120), cv::Scalar(0, 0, 0), -1);
-    cv::addWeighted(overlay, 0.5, frame, 0.5, 0, frame);
+    int height = 120 + statLineHeight * static_cast<int>(stages.size() + (queues.empty() ? 0 : 1) +
+                                                         (showCache ? 1 : 0) + (showQuality ? 1 : 0));
+    shadeRegion(frame, cv::Rect(frame.cols - 350, 10, 340, height), 0.5);
     
     // Add performance information
     cv::putText(frame, "Performance:", cv::Point(frame.cols - 340, y), 
@@ -236,10 +363,50 @@ void UserInterface::drawPerformanceInfo(cv::Mat& frame) {
     ss << "Active Filters: " << processor->getFilters().size();
     cv::putText(frame, ss.str(), cv::Point(frame.cols - 340, y), 
                 cv::FONT_HERSHEY_SIMPLEX, 0.6, textColor, 1);
+    y += statLineHeight;
+    
+    if (showCache) {
+        uint64_t lookups = cache.hits + cache.misses;
+        ss.str("");
+        ss << "Filter cache: " << std::setprecision(0) << (lookups > 0 ? 100.0 * cache.hits / lookups : 0.0)
+           << "% hits, " << cache.bytes / (1024 * 1024) << "/" << cache.budget / (1024 * 1024) << " MB";
+        cv::putText(frame, ss.str(), cv::Point(frame.cols - 340, y), 
+                    cv::FONT_HERSHEY_SIMPLEX, 0.45, textColor, 1);
+        y += statLineHeight;
+    }
+    
+    if (showQuality) {
+        ss.str("");
+        ss << "Resolution: " << std::setprecision(0) << 100.0 * quality.scale << "%, filters "
+           << std::setprecision(1) << quality.averageMs << " / " << quality.budgetMs << " ms";
+        cv::putText(frame, ss.str(), cv::Point(frame.cols - 340, y), 
+                    cv::FONT_HERSHEY_SIMPLEX, 0.45, textColor, 1);
+        y += statLineHeight;
+    }
+    
+    // Stage latencies as p50 / p99 in ms, then queue depths
+    for (const auto& stage : stages) {
+        ss.str("");
+        ss << stage.name << ": " << std::setprecision(2) << stage.p50Ms << " / " << stage.p99Ms << " ms";
+        cv::putText(frame, ss.str(), cv::Point(frame.cols - 340, y), 
+                    cv::FONT_HERSHEY_SIMPLEX, 0.45, textColor, 1);
+        y += statLineHeight;
+    }
+    
+    if (!queues.empty()) {
+        ss.str("");
+        ss << "Queues:";
+        for (const auto& queue : queues) {
+            ss << " " << queue.name << " " << queue.depth << "/" << queue.capacity;
+        }
+        cv::putText(frame, ss.str(), cv::Point(frame.cols - 340, y), 
+                    cv::FONT_HERSHEY_SIMPLEX, 0.45, textColor, 1);
+    }
 }
 
 void UserInterface::initializeFilters() {
     // Initialize available filters
     availableFilters.push_back(std::make_shared<GaussianBlurFilter>());
     availableFilters.push_back(std::make_shared<EdgeDetectionFilter>());
+    availableFilters.push_back(std::make_shared<ColorEnhanceFilter>());
 }
\ No newline at end of file
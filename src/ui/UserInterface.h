@@ -28,6 +28,17 @@ public:
      */
     int run();
 
+    /**
+     * @brief Limit how often the window is repainted
+     *
+     * The window is repainted when a new frame is ready, so it follows the
+     * source frame rate up to this limit. Frames that arrive faster are
+     * skipped without being scaled.
+     *
+     * @param rate Repaints per second, or 0 for no limit
+     */
+    void setMaxRefreshRate(double rate);
+
 private:
     // Video processor
     std::shared_ptr<VideoProcessor> processor;
@@ -35,6 +46,9 @@ private:
     // UI state
     std::string windowName;
     bool running;
+    double blurSigma;
+    cv::Mat canvas;     ///< Display frame with the overlays drawn on it
+    double maxRefreshRate;
     
     // Available filters
     std::vector<std::shared_ptr<Filter>> availableFilters;
@@ -44,11 +58,14 @@ private:
     void onTogglePlayPause();
     void onAddFilter(int filterIndex);
     void onSaveVideo();
+    void onSeek(int frameOffset);
+    void onTuneBlur(double factor);
     
     // Keyboard event handler
     void handleKeyPress(int key);
     
     // Display functions
+    bool isWindowVisible() const;
     void updateDisplay();
     void drawControls(cv::Mat& frame);
     void drawPerformanceInfo(cv::Mat& frame);
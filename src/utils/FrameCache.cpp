@@ -0,0 +1,88 @@
+#include "FrameCache.h"
+
+FrameCache::FrameCache(size_t budgetBytes)
+    : budget(budgetBytes), bytes(0), hits(0), misses(0) {
+}
+
+void FrameCache::setBudget(size_t budgetBytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budget = budgetBytes;
+    evictFor(0);
+}
+
+bool FrameCache::get(uint64_t key, cv::Mat& frame) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = lookup.find(key);
+    if (found == lookup.end()) {
+        ++misses;
+        return false;
+    }
+
+    entries.splice(entries.begin(), entries, found->second);
+    found->second->frame.copyTo(frame);
+    ++hits;
+    return true;
+}
+
+bool FrameCache::contains(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return lookup.count(key) > 0;
+}
+
+void FrameCache::put(uint64_t key, const cv::Mat& frame) {
+    size_t size = frameBytes(frame);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (size == 0 || size > budget) {
+        return;
+    }
+
+    auto found = lookup.find(key);
+    if (found != lookup.end()) {
+        bytes -= frameBytes(found->second->frame);
+        spare = found->second->frame;
+        entries.erase(found->second);
+        lookup.erase(found);
+    }
+    evictFor(size);
+
+    // copyTo() reuses the spare buffer when it has the same size and type
+    Entry entry{key, spare};
+    spare.release();
+    frame.copyTo(entry.frame);
+    entries.push_front(std::move(entry));
+    lookup[key] = entries.begin();
+    bytes += size;
+}
+
+void FrameCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    lookup.clear();
+    spare.release();
+    bytes = 0;
+}
+
+FrameCache::Stats FrameCache::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.hits = hits;
+    stats.misses = misses;
+    stats.entries = entries.size();
+    stats.bytes = bytes;
+    stats.budget = budget;
+    return stats;
+}
+
+size_t FrameCache::frameBytes(const cv::Mat& frame) {
+    return frame.total() * frame.elemSize();
+}
+
+void FrameCache::evictFor(size_t incoming) {
+    while (!entries.empty() && bytes + incoming > budget) {
+        Entry& oldest = entries.back();
+        bytes -= frameBytes(oldest.frame);
+        spare = oldest.frame;
+        lookup.erase(oldest.key);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+/**
+ * @brief Least-recently-used cache of frames with a memory budget
+ *
+ * Frames are copied in and out, so callers never share storage with the
+ * cache. Evicted buffers are reused for later insertions of the same
+ * size, so a full cache does not allocate. All methods are thread-safe.
+ */
+class FrameCache {
+public:
+    /**
+     * @brief Usage counters for a cache
+     */
+    struct Stats {
+        uint64_t hits = 0;          ///< Lookups that found their frame
+        uint64_t misses = 0;        ///< Lookups that did not
+        size_t entries = 0;         ///< Frames currently cached
+        size_t bytes = 0;           ///< Memory held by the cached frames
+        size_t budget = 0;          ///< Memory limit
+    };
+
+    /**
+     * @brief Construct a cache
+     *
+     * @param budgetBytes Memory limit; 0 disables caching
+     */
+    explicit FrameCache(size_t budgetBytes = 0);
+
+    /**
+     * @brief Change the memory limit, evicting frames if it shrank
+     *
+     * @param budgetBytes Memory limit; 0 disables caching
+     */
+    void setBudget(size_t budgetBytes);
+
+    /**
+     * @brief Copy a cached frame out and mark it as recently used
+     *
+     * @param key Key of the frame
+     * @param frame Receives a copy of the frame
+     * @return true if the frame was cached
+     */
+    bool get(uint64_t key, cv::Mat& frame);
+
+    /**
+     * @brief Check whether a frame is cached, without counting a lookup
+     *
+     * @param key Key of the frame
+     * @return true if the frame is cached
+     */
+    bool contains(uint64_t key) const;
+
+    /**
+     * @brief Copy a frame into the cache, evicting the least recently used ones
+     *
+     * Frames larger than the whole budget are not cached.
+     *
+     * @param key Key of the frame; an existing entry is replaced
+     * @param frame Frame to copy
+     */
+    void put(uint64_t key, const cv::Mat& frame);
+
+    /**
+     * @brief Drop every cached frame
+     */
+    void clear();
+
+    /**
+     * @brief Get usage counters
+     *
+     * @return Cache statistics
+     */
+    Stats getStats() const;
+
+private:
+    struct Entry {
+        uint64_t key;
+        cv::Mat frame;
+    };
+
+    mutable std::mutex mutex;
+    std::list<Entry> entries;   ///< Most recently used first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> lookup;
+    size_t budget;
+    size_t bytes;
+    cv::Mat spare;              ///< Last evicted buffer, reused by put()
+    uint64_t hits;
+    uint64_t misses;
+
+    static size_t frameBytes(const cv::Mat& frame);
+
+    // Evict until `incoming` more bytes fit in the budget
+    void evictFor(size_t incoming);
+};
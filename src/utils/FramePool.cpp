@@ -0,0 +1,96 @@
+#include "FramePool.h"
+#include <algorithm>
+
+FramePool::FramePool()
+    : state(std::make_shared<State>()) {
+}
+
+void FramePool::reset(size_t capacity, cv::Size size, int type) {
+    std::vector<cv::Mat> buffers;
+    buffers.reserve(capacity);
+    for (size_t i = 0; i < capacity; ++i) {
+        buffers.emplace_back(size, type);
+    }
+
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->freeBuffers = std::move(buffers);
+    state->size = size;
+    state->type = type;
+    ++state->generation;
+
+    state->stats = Stats();
+    state->stats.capacity = capacity;
+    state->stats.bytesReserved = capacity * size.area() * CV_ELEM_SIZE(type);
+    state->available.notify_all();
+}
+
+FramePool::Handle FramePool::acquire() {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->freeBuffers.empty()) {
+        uint64_t generation = state->generation;
+        cv::Mat buffer = takeFreeBuffer();
+        lock.unlock();
+        return wrap(std::move(buffer), true, generation);
+    }
+
+    // Pool exhausted: fall back to a one-off allocation
+    ++state->stats.allocationMisses;
+    cv::Size size = state->size;
+    int type = state->type;
+    lock.unlock();
+    return wrap(cv::Mat(size, type), false, 0);
+}
+
+FramePool::Handle FramePool::acquireFor(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->available.wait_for(lock, timeout, [this] { return !state->freeBuffers.empty(); })) {
+        return nullptr;
+    }
+
+    uint64_t generation = state->generation;
+    cv::Mat buffer = takeFreeBuffer();
+    lock.unlock();
+    return wrap(std::move(buffer), true, generation);
+}
+
+FramePool::Stats FramePool::getStats() const {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->stats;
+}
+
+size_t FramePool::capacityForBudget(size_t budgetBytes, cv::Size size, int type) {
+    size_t frameBytes = static_cast<size_t>(size.area()) * CV_ELEM_SIZE(type);
+    if (frameBytes == 0) {
+        return 1;
+    }
+    return std::max<size_t>(1, budgetBytes / frameBytes);
+}
+
+cv::Mat FramePool::takeFreeBuffer() {
+    cv::Mat buffer = std::move(state->freeBuffers.back());
+    state->freeBuffers.pop_back();
+
+    if (buffer.size() != state->size || buffer.type() != state->type) {
+        buffer.create(state->size, state->type);
+        ++state->stats.allocationMisses;
+    }
+
+    state->stats.inUse++;
+    state->stats.peakInUse = std::max(state->stats.peakInUse, state->stats.inUse);
+    return buffer;
+}
+
+FramePool::Handle FramePool::wrap(cv::Mat buffer, bool pooled, uint64_t generation) {
+    std::shared_ptr<State> owner = state;
+    return Handle(new cv::Mat(std::move(buffer)), [owner, pooled, generation](cv::Mat* frame) {
+        if (pooled) {
+            std::lock_guard<std::mutex> lock(owner->mutex);
+            if (generation == owner->generation) {
+                owner->freeBuffers.push_back(std::move(*frame));
+                owner->stats.inUse--;
+                owner->available.notify_one();
+            }
+        }
+        delete frame;
+    });
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <vector>
+#include <chrono>
+
+/**
+ * @brief Fixed-capacity pool of preallocated frame buffers
+ *
+ * Buffers are handed out as shared handles. When the last handle to a
+ * buffer goes away the buffer returns to the pool instead of being freed,
+ * so steady-state processing does not allocate frame memory. The pool can
+ * be reset at any time; buffers still held from before a reset are simply
+ * released when their handles are dropped.
+ */
+class FramePool {
+public:
+    /**
+     * @brief Shared handle to a pooled frame
+     *
+     * Copy the handle to share the frame. Do not keep cv::Mat headers to
+     * the buffer beyond the lifetime of the handle, because the pool will
+     * reuse the storage.
+     */
+    using Handle = std::shared_ptr<cv::Mat>;
+
+    /**
+     * @brief Usage counters for a pool
+     */
+    struct Stats {
+        size_t capacity = 0;            ///< Number of pooled buffers
+        size_t inUse = 0;               ///< Pooled buffers currently handed out
+        size_t peakInUse = 0;           ///< Highest inUse value since the last reset
+        uint64_t allocationMisses = 0;  ///< Acquisitions that had to allocate frame memory
+        size_t bytesReserved = 0;       ///< Memory held by the pooled buffers
+    };
+
+    /**
+     * @brief Construct an empty pool
+     */
+    FramePool();
+
+    /**
+     * @brief Preallocate the pool for a frame format
+     *
+     * @param capacity Number of buffers to preallocate
+     * @param size Frame size
+     * @param type OpenCV type of the frames (e.g. CV_8UC3)
+     */
+    void reset(size_t capacity, cv::Size size, int type);
+
+    /**
+     * @brief Get a buffer without waiting
+     *
+     * If every pooled buffer is in use, a one-off buffer is allocated and
+     * counted as a miss; it is freed rather than pooled when released.
+     *
+     * @return Handle to a frame of the pool's size and type
+     */
+    Handle acquire();
+
+    /**
+     * @brief Wait for a pooled buffer
+     *
+     * This bounds memory use: callers block while the whole pool is in use.
+     *
+     * @param timeout Maximum time to wait
+     * @return Handle to a pooled frame, or nullptr if the wait timed out
+     */
+    Handle acquireFor(std::chrono::milliseconds timeout);
+
+    /**
+     * @brief Get the pool counters
+     *
+     * @return Snapshot of the pool statistics
+     */
+    Stats getStats() const;
+
+    /**
+     * @brief Compute how many frames fit into a memory budget
+     *
+     * @param budgetBytes Memory budget in bytes
+     * @param size Frame size
+     * @param type OpenCV type of the frames
+     * @return Number of frames that fit, at least one
+     */
+    static size_t capacityForBudget(size_t budgetBytes, cv::Size size, int type);
+
+private:
+    // Shared with outstanding handles so they can return buffers safely
+    struct State {
+        mutable std::mutex mutex;
+        std::condition_variable available;
+        std::vector<cv::Mat> freeBuffers;
+        cv::Size size;
+        int type = CV_8UC3;
+        uint64_t generation = 0;
+        Stats stats;
+    };
+
+    std::shared_ptr<State> state;
+
+    // Wrap a buffer into a handle that returns it to the pool on release
+    Handle wrap(cv::Mat buffer, bool pooled, uint64_t generation);
+
+    // Take a free buffer with the lock held, reallocating if a filter replaced its storage
+    cv::Mat takeFreeBuffer();
+};
@@ -1,5 +1,326 @@
-//
-// Created by Damian on 3/6/2025.
-//
-
 #include "PerformanceMonitor.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+constexpr uint64_t SUB_BUCKETS = uint64_t(1) << LatencyHistogram::SUB_BUCKET_BITS;
+
+// Add to a counter that only the calling thread writes
+template <typename T>
+void increment(std::atomic<T>& counter, T amount) {
+    counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+void raiseTo(std::atomic<size_t>& peak, size_t value) {
+    size_t current = peak.load(std::memory_order_relaxed);
+    while (value > current && !peak.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+int highestBit(uint64_t value) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, value);
+    return static_cast<int>(index);
+#else
+    return 63 - __builtin_clzll(value);
+#endif
+}
+
+double toMilliseconds(uint64_t nanoseconds) {
+    return nanoseconds / 1e6;
+}
+
+}  // namespace
+
+void LatencyHistogram::record(uint64_t nanoseconds) {
+    increment(counts[bucketIndex(nanoseconds)], uint64_t(1));
+    increment(sum, nanoseconds);
+    if (nanoseconds > max.load(std::memory_order_relaxed)) {
+        max.store(nanoseconds, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::addTo(std::vector<uint64_t>& merged) const {
+    for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+        merged[i] += counts[i].load(std::memory_order_relaxed);
+    }
+}
+
+uint64_t LatencyHistogram::getSum() const {
+    return sum.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+void LatencyHistogram::clear() {
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+size_t LatencyHistogram::bucketIndex(uint64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<size_t>(value);
+    }
+
+    // Bucket group by highest set bit, then the next SUB_BUCKET_BITS bits
+    int magnitude = highestBit(value);
+    if (magnitude > MAX_MAGNITUDE) {
+        return BUCKET_COUNT - 1;
+    }
+    int shift = magnitude - SUB_BUCKET_BITS;
+    return (static_cast<size_t>(shift + 1) << SUB_BUCKET_BITS) +
+           static_cast<size_t>((value >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+
+    int shift = static_cast<int>(index >> SUB_BUCKET_BITS) - 1;
+    uint64_t lowest = (SUB_BUCKETS + (index & (SUB_BUCKETS - 1))) << shift;
+    return lowest + (uint64_t(1) << shift) - 1;
+}
+
+PerformanceMonitor::Shard::~Shard() {
+    for (auto& histogram : histograms) {
+        delete histogram.load(std::memory_order_relaxed);
+    }
+}
+
+PerformanceMonitor::Recorder::~Recorder() {
+    if (monitor) {
+        monitor->releaseShard(shard);
+    }
+}
+
+PerformanceMonitor::Recorder::Recorder(Recorder&& other) noexcept
+    : monitor(other.monitor), shard(other.shard) {
+    other.monitor = nullptr;
+    other.shard = nullptr;
+}
+
+PerformanceMonitor::Recorder& PerformanceMonitor::Recorder::operator=(Recorder&& other) noexcept {
+    if (this != &other) {
+        if (monitor) {
+            monitor->releaseShard(shard);
+        }
+        monitor = other.monitor;
+        shard = other.shard;
+        other.monitor = nullptr;
+        other.shard = nullptr;
+    }
+    return *this;
+}
+
+void PerformanceMonitor::Recorder::record(size_t stage, uint64_t nanoseconds) {
+    if (!shard || stage >= MAX_STAGES) {
+        return;
+    }
+
+    // Only this recorder stores histograms into its shard; readers load
+    // them with acquire and may see a stage appear at any time
+    LatencyHistogram* histogram = shard->histograms[stage].load(std::memory_order_relaxed);
+    if (!histogram) {
+        histogram = new LatencyHistogram();
+        shard->histograms[stage].store(histogram, std::memory_order_release);
+    }
+    histogram->record(nanoseconds);
+}
+
+PerformanceMonitor* PerformanceMonitor::Recorder::getMonitor() const {
+    return monitor;
+}
+
+PerformanceMonitor::PerformanceMonitor() {
+    registerStage("Decode");
+    registerStage("Queue wait");
+    registerStage("Filters");
+    registerStage("Encode");
+    registerStage("Display copy");
+}
+
+PerformanceMonitor::Recorder PerformanceMonitor::createRecorder() {
+    std::lock_guard<std::mutex> lock(mutex);
+    Recorder recorder;
+    recorder.monitor = this;
+    if (!freeShards.empty()) {
+        recorder.shard = freeShards.back();
+        freeShards.pop_back();
+    } else {
+        shards.push_back(std::make_unique<Shard>());
+        recorder.shard = shards.back().get();
+    }
+    return recorder;
+}
+
+void PerformanceMonitor::releaseShard(Shard* shard) {
+    std::lock_guard<std::mutex> lock(mutex);
+    freeShards.push_back(shard);
+}
+
+size_t PerformanceMonitor::registerStage(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto existing = std::find(stageNames.begin(), stageNames.end(), name);
+    if (existing != stageNames.end()) {
+        return static_cast<size_t>(existing - stageNames.begin());
+    }
+    if (stageNames.size() >= MAX_STAGES) {
+        return NO_STAGE;
+    }
+    stageNames.push_back(name);
+    return stageNames.size() - 1;
+}
+
+size_t PerformanceMonitor::registerQueue(const std::string& name, size_t capacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t queue = static_cast<size_t>(std::find(queueNames.begin(), queueNames.end(), name) - queueNames.begin());
+    if (queue == queueNames.size()) {
+        if (queueNames.size() >= MAX_QUEUES) {
+            return MAX_QUEUES;
+        }
+        queueNames.push_back(name);
+    }
+    queues[queue].capacity.store(capacity, std::memory_order_relaxed);
+    return queue;
+}
+
+void PerformanceMonitor::setQueueDepth(size_t queue, size_t depth) {
+    if (queue >= MAX_QUEUES) {
+        return;
+    }
+    queues[queue].depth.store(depth, std::memory_order_relaxed);
+    raiseTo(queues[queue].peakDepth, depth);
+}
+
+PerformanceMonitor::StageStats PerformanceMonitor::mergeStage(size_t stage) const {
+    StageStats stats;
+    stats.name = stageNames[stage];
+
+    std::vector<uint64_t> merged;
+    uint64_t sum = 0;
+    uint64_t max = 0;
+    for (const auto& shard : shards) {
+        const LatencyHistogram* histogram = shard->histograms[stage].load(std::memory_order_acquire);
+        if (!histogram) {
+            continue;
+        }
+        if (merged.empty()) {
+            merged.assign(LatencyHistogram::BUCKET_COUNT, 0);
+        }
+        histogram->addTo(merged);
+        sum += histogram->getSum();
+        max = std::max(max, histogram->getMax());
+    }
+
+    for (uint64_t count : merged) {
+        stats.count += count;
+    }
+    if (stats.count == 0) {
+        return stats;
+    }
+
+    // Smallest bucket bound that covers the given share of the samples
+    auto percentile = [&](double share) {
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(share * stats.count + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < merged.size(); ++i) {
+            seen += merged[i];
+            if (seen >= rank) {
+                return toMilliseconds(std::min(LatencyHistogram::bucketUpperBound(i), max));
+            }
+        }
+        return toMilliseconds(max);
+    };
+
+    stats.meanMs = toMilliseconds(sum) / stats.count;
+    stats.p50Ms = percentile(0.50);
+    stats.p95Ms = percentile(0.95);
+    stats.p99Ms = percentile(0.99);
+    stats.maxMs = toMilliseconds(max);
+    return stats;
+}
+
+std::vector<PerformanceMonitor::StageStats> PerformanceMonitor::getStageStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<StageStats> result;
+    for (size_t stage = 0; stage < stageNames.size(); ++stage) {
+        StageStats stats = mergeStage(stage);
+        if (stats.count > 0) {
+            result.push_back(std::move(stats));
+        }
+    }
+    return result;
+}
+
+std::vector<PerformanceMonitor::QueueStats> PerformanceMonitor::getQueueStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<QueueStats> result;
+    for (size_t queue = 0; queue < queueNames.size(); ++queue) {
+        QueueStats stats;
+        stats.name = queueNames[queue];
+        stats.depth = queues[queue].depth.load(std::memory_order_relaxed);
+        stats.peakDepth = queues[queue].peakDepth.load(std::memory_order_relaxed);
+        stats.capacity = queues[queue].capacity.load(std::memory_order_relaxed);
+        result.push_back(std::move(stats));
+    }
+    return result;
+}
+
+void PerformanceMonitor::printReport(std::ostream& out) const {
+    std::vector<StageStats> stages = getStageStats();
+    std::vector<QueueStats> queueStats = getQueueStats();
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+
+    out << "  " << std::left << std::setw(28) << "Stage (ms)" << std::right
+        << std::setw(9) << "count" << std::setw(9) << "mean" << std::setw(9) << "p50"
+        << std::setw(9) << "p95" << std::setw(9) << "p99" << std::setw(9) << "max" << std::endl;
+    out << std::fixed << std::setprecision(3);
+    for (const StageStats& stage : stages) {
+        out << "  " << std::left << std::setw(28) << stage.name << std::right
+            << std::setw(9) << stage.count << std::setw(9) << stage.meanMs << std::setw(9) << stage.p50Ms
+            << std::setw(9) << stage.p95Ms << std::setw(9) << stage.p99Ms << std::setw(9) << stage.maxMs
+            << std::endl;
+    }
+    for (const QueueStats& queue : queueStats) {
+        out << "  Queue " << queue.name << ": depth " << queue.depth << ", peak "
+            << queue.peakDepth << "/" << queue.capacity << std::endl;
+    }
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void PerformanceMonitor::reset() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& shard : shards) {
+        for (auto& slot : shard->histograms) {
+            LatencyHistogram* histogram = slot.load(std::memory_order_acquire);
+            if (histogram) {
+                histogram->clear();
+            }
+        }
+    }
+    for (Queue& queue : queues) {
+        queue.depth.store(0, std::memory_order_relaxed);
+        queue.peakDepth.store(0, std::memory_order_relaxed);
+    }
+}
+
+uint64_t PerformanceMonitor::now() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
\ No newline at end of file
@@ -1,8 +1,274 @@
-//
-// Created by Damian on 3/6/2025.
-//
+#pragma once
 
-#ifndef PERFORMANCEMONITOR_H
-#define PERFORMANCEMONITOR_H
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
 
-#endif //PERFORMANCEMONITOR_H
+/**
+ * @brief Latency histogram with logarithmic buckets, in nanoseconds
+ *
+ * Works like an HDR histogram: values are grouped by their highest set bit
+ * and every power of two is split into 32 linear sub-buckets, so a
+ * recorded value is known to within about 3% from 1 ns to half an hour.
+ * One thread records while any thread may read; the counters are relaxed
+ * atomics, so neither side ever blocks.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int MAX_MAGNITUDE = 40;    ///< Larger values land in the top bucket
+    static constexpr size_t BUCKET_COUNT = static_cast<size_t>(MAX_MAGNITUDE - SUB_BUCKET_BITS + 2)
+                                           << SUB_BUCKET_BITS;
+
+    /**
+     * @brief Record one value; only one thread may record into a histogram
+     *
+     * @param nanoseconds Value to record
+     */
+    void record(uint64_t nanoseconds);
+
+    /**
+     * @brief Add the bucket counts to a merged histogram
+     *
+     * @param merged BUCKET_COUNT counters to add to
+     */
+    void addTo(std::vector<uint64_t>& merged) const;
+
+    /**
+     * @brief Get the sum of all recorded values
+     *
+     * @return Sum in nanoseconds
+     */
+    uint64_t getSum() const;
+
+    /**
+     * @brief Get the largest recorded value
+     *
+     * @return Exact maximum in nanoseconds
+     */
+    uint64_t getMax() const;
+
+    /**
+     * @brief Forget all recorded values
+     */
+    void clear();
+
+    /**
+     * @brief Get the bucket that holds a value
+     *
+     * @param value Value in nanoseconds
+     * @return Bucket index below BUCKET_COUNT
+     */
+    static size_t bucketIndex(uint64_t value);
+
+    /**
+     * @brief Get the largest value that falls into a bucket
+     *
+     * @param index Bucket index
+     * @return Upper bound in nanoseconds
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+private:
+    std::array<std::atomic<uint64_t>, BUCKET_COUNT> counts{};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> max{0};
+};
+
+/**
+ * @brief Low-overhead latency and queue-depth instrumentation
+ *
+ * Each thread that records takes a Recorder, which owns one histogram per
+ * stage, so recording is a few uncontended atomic stores and never takes
+ * a lock. Readers merge the histograms of all recorders to get
+ * percentiles, which lets the UI overlay and the headless statistics show
+ * the same numbers. Stages are registered by name (the pipeline steps
+ * below, plus one per filter stage of the chain) and queues report their
+ * current and peak depth.
+ */
+class PerformanceMonitor {
+public:
+    // Stages every pipeline records
+    static constexpr size_t DECODE = 0;         ///< FrameSource::grab() and retrieve()
+    static constexpr size_t QUEUE_WAIT = 1;     ///< Decoded frame waiting for a worker
+    static constexpr size_t FILTERS = 2;        ///< Whole filter chain
+    static constexpr size_t ENCODE = 3;         ///< VideoWriter::write
+    static constexpr size_t DISPLAY_COPY = 4;   ///< Copy of the latest frame for display
+
+    static constexpr size_t MAX_STAGES = 64;
+    static constexpr size_t MAX_QUEUES = 8;
+    static constexpr size_t NO_STAGE = MAX_STAGES;  ///< Returned when the registry is full; ignored
+
+    /**
+     * @brief Latency percentiles of one stage
+     */
+    struct StageStats {
+        std::string name;
+        uint64_t count = 0;     ///< Recorded samples
+        double meanMs = 0.0;
+        double p50Ms = 0.0;     ///< Percentiles are bucket upper bounds (within ~3%)
+        double p95Ms = 0.0;
+        double p99Ms = 0.0;
+        double maxMs = 0.0;     ///< Exact
+    };
+
+    /**
+     * @brief Depth of one queue
+     */
+    struct QueueStats {
+        std::string name;
+        size_t depth = 0;       ///< Depth at the last update
+        size_t peakDepth = 0;   ///< Deepest since the last reset
+        size_t capacity = 0;
+    };
+
+private:
+    // Histograms of one recorder, created when a stage is first recorded
+    struct Shard {
+        std::array<std::atomic<LatencyHistogram*>, MAX_STAGES> histograms{};
+        ~Shard();
+    };
+
+public:
+    /**
+     * @brief Per-thread handle for recording latencies
+     *
+     * Not thread-safe: use one recorder per thread, or guard a shared one
+     * with a mutex. The histograms stay in the monitor after the recorder
+     * is destroyed and are reused by the next recorder it creates.
+     */
+    class Recorder {
+    public:
+        Recorder() = default;
+        ~Recorder();
+        Recorder(Recorder&& other) noexcept;
+        Recorder& operator=(Recorder&& other) noexcept;
+        Recorder(const Recorder&) = delete;
+        Recorder& operator=(const Recorder&) = delete;
+
+        /**
+         * @brief Record the latency of a stage
+         *
+         * @param stage Stage id from registerStage() or one of the fixed stages
+         * @param nanoseconds Latency
+         */
+        void record(size_t stage, uint64_t nanoseconds);
+
+        /**
+         * @brief Get the monitor that created this recorder
+         *
+         * @return Monitor, or nullptr for a default-constructed recorder
+         */
+        PerformanceMonitor* getMonitor() const;
+
+    private:
+        friend class PerformanceMonitor;
+        PerformanceMonitor* monitor = nullptr;
+        Shard* shard = nullptr;
+    };
+
+    /**
+     * @brief Constructor; registers the fixed pipeline stages
+     */
+    PerformanceMonitor();
+
+    PerformanceMonitor(const PerformanceMonitor&) = delete;
+    PerformanceMonitor& operator=(const PerformanceMonitor&) = delete;
+
+    /**
+     * @brief Create a recorder for the calling thread
+     *
+     * The monitor must outlive the recorder.
+     *
+     * @return New recorder
+     */
+    Recorder createRecorder();
+
+    /**
+     * @brief Get the id of a stage, registering it on first use
+     *
+     * @param name Stage name
+     * @return Stage id, or NO_STAGE if MAX_STAGES names are taken
+     */
+    size_t registerStage(const std::string& name);
+
+    /**
+     * @brief Get the id of a queue, registering it on first use
+     *
+     * @param name Queue name
+     * @param capacity Queue capacity (updated if the queue exists)
+     * @return Queue id, or MAX_QUEUES if MAX_QUEUES names are taken
+     */
+    size_t registerQueue(const std::string& name, size_t capacity);
+
+    /**
+     * @brief Report the current depth of a queue
+     *
+     * Lock-free; may be called from any thread.
+     *
+     * @param queue Queue id from registerQueue()
+     * @param depth Current depth
+     */
+    void setQueueDepth(size_t queue, size_t depth);
+
+    /**
+     * @brief Get the percentiles of every stage that has samples
+     *
+     * @return Stage statistics in registration order
+     */
+    std::vector<StageStats> getStageStats() const;
+
+    /**
+     * @brief Get the depth of every registered queue
+     *
+     * @return Queue statistics in registration order
+     */
+    std::vector<QueueStats> getQueueStats() const;
+
+    /**
+     * @brief Print a table of stage percentiles and queue depths
+     *
+     * @param out Stream to print to
+     */
+    void printReport(std::ostream& out) const;
+
+    /**
+     * @brief Forget all samples and queue peaks
+     *
+     * Samples recorded while the reset runs may survive it.
+     */
+    void reset();
+
+    /**
+     * @brief Get a monotonic timestamp
+     *
+     * @return Nanoseconds since an arbitrary epoch
+     */
+    static uint64_t now();
+
+private:
+    struct Queue {
+        std::atomic<size_t> depth{0};
+        std::atomic<size_t> peakDepth{0};
+        std::atomic<size_t> capacity{0};
+    };
+
+    // Guards the names and the shard lists; never taken while recording
+    mutable std::mutex mutex;
+    std::vector<std::string> stageNames;
+    std::vector<std::string> queueNames;
+    std::array<Queue, MAX_QUEUES> queues;
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<Shard*> freeShards;
+
+    // Called by a recorder that goes away
+    void releaseShard(Shard* shard);
+
+    // Stage statistics merged over every shard
+    StageStats mergeStage(size_t stage) const;
+};
@@ -0,0 +1,88 @@
+#include "QualityGovernor.h"
+
+namespace {
+
+constexpr double LADDER[] = {1.0, 0.75, 0.5};
+constexpr size_t LEVELS = sizeof(LADDER) / sizeof(LADDER[0]);
+
+// Step down above this share of the budget, up only when the next level
+// is projected below the lower one
+constexpr double DOWN_THRESHOLD = 0.9;
+constexpr double UP_THRESHOLD = 0.6;
+constexpr int DOWN_FRAMES = 5;
+constexpr int UP_FRAMES = 30;
+
+// Weight of a new sample in the moving average
+constexpr double SMOOTHING = 0.2;
+
+}  // namespace
+
+QualityGovernor::QualityGovernor()
+    : scale(1.0), level(0), budgetNs(0.0), averageNs(0.0), overBudget(0), underBudget(0),
+      seeded(false), levelChanges(0) {
+}
+
+void QualityGovernor::reset(double budgetMs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    budgetNs = budgetMs > 0 ? budgetMs * 1e6 : 0.0;
+    setLevel(0);
+    levelChanges = 0;
+}
+
+double QualityGovernor::getScale() const {
+    return scale.load(std::memory_order_relaxed);
+}
+
+void QualityGovernor::record(double frameScale, uint64_t filterNs) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (budgetNs <= 0 || frameScale != LADDER[level]) {
+        return;
+    }
+
+    double sample = static_cast<double>(filterNs);
+    averageNs = seeded ? averageNs + SMOOTHING * (sample - averageNs) : sample;
+    seeded = true;
+
+    if (level + 1 < LEVELS && averageNs > DOWN_THRESHOLD * budgetNs) {
+        if (++overBudget >= DOWN_FRAMES) {
+            setLevel(level + 1);
+            ++levelChanges;
+        }
+        return;
+    }
+    overBudget = 0;
+
+    // Filter time grows with the pixel count, i.e. the square of the scale
+    if (level > 0) {
+        double ratio = LADDER[level - 1] / LADDER[level];
+        if (averageNs * ratio * ratio < UP_THRESHOLD * budgetNs) {
+            if (++underBudget >= UP_FRAMES) {
+                setLevel(level - 1);
+                ++levelChanges;
+            }
+            return;
+        }
+    }
+    underBudget = 0;
+}
+
+QualityGovernor::Stats QualityGovernor::getStats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats stats;
+    stats.level = level;
+    stats.scale = LADDER[level];
+    stats.averageMs = averageNs / 1e6;
+    stats.budgetMs = budgetNs / 1e6;
+    stats.levelChanges = levelChanges;
+    return stats;
+}
+
+void QualityGovernor::setLevel(size_t newLevel) {
+    // Samples from the old level say little about the new one
+    level = newLevel;
+    scale.store(LADDER[level], std::memory_order_relaxed);
+    averageNs = 0.0;
+    seeded = false;
+    overBudget = 0;
+    underBudget = 0;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+/**
+ * @brief Picks the resolution frames are filtered at from the time they take
+ *
+ * Workers report how long each frame spent in the filters, together with
+ * the scale it was filtered at. The governor keeps a moving average and
+ * walks a ladder of scales (1.0, 0.75, 0.5):
+ *
+ * - it steps down when the average stays above the frame budget for a
+ *   few frames in a row;
+ * - it steps up when the average, projected to the next larger scale by
+ *   the ratio of pixel counts, stays well below the budget for about a
+ *   second's worth of frames.
+ *
+ * The gap between the two thresholds and the longer wait before stepping
+ * up keep a chain that is close to the budget from flipping between
+ * levels. All methods are thread-safe.
+ */
+class QualityGovernor {
+public:
+    /**
+     * @brief Current level and load
+     */
+    struct Stats {
+        size_t level = 0;           ///< Index into the ladder; 0 is full resolution
+        double scale = 1.0;         ///< Scale frames are filtered at
+        double averageMs = 0.0;     ///< Moving average of the filter time at this level
+        double budgetMs = 0.0;      ///< Filter time available per frame
+        uint64_t levelChanges = 0;  ///< Steps taken since the last reset()
+    };
+
+    QualityGovernor();
+
+    /**
+     * @brief Return to full resolution and set the frame budget
+     *
+     * @param budgetMs Filter time one worker may spend on a frame; 0 keeps
+     *                 full resolution
+     */
+    void reset(double budgetMs);
+
+    /**
+     * @brief Get the scale to filter the next frame at
+     *
+     * @return Scale factor of both dimensions, 1.0 for full resolution
+     */
+    double getScale() const;
+
+    /**
+     * @brief Report the filter time of a frame
+     *
+     * Frames filtered at another scale than the current level, e.g. ones
+     * started before the last step, are ignored.
+     *
+     * @param scale Scale the frame was filtered at
+     * @param filterNs Time spent scaling and filtering it
+     */
+    void record(double scale, uint64_t filterNs);
+
+    /**
+     * @brief Get the current level and load
+     *
+     * @return Governor statistics
+     */
+    Stats getStats() const;
+
+private:
+    mutable std::mutex mutex;
+    std::atomic<double> scale;
+    size_t level;
+    double budgetNs;
+    double averageNs;
+    int overBudget;     ///< Consecutive frames above the step-down threshold
+    int underBudget;    ///< Consecutive frames below the step-up threshold
+    bool seeded;
+    uint64_t levelChanges;
+
+    void setLevel(size_t newLevel);
+};
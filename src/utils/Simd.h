@@ -0,0 +1,29 @@
+#pragma once
+
+/**
+ * @brief Compile-time SIMD support shared by the hand-vectorized kernels
+ *
+ * SIMD_X86 is defined on x86 targets, where SSE4.1 and AVX2 kernels are
+ * compiled per function with SIMD_TARGET and chosen at runtime with
+ * cv::checkHardwareSupport. SIMD_NEON is defined when NEON is part of the
+ * target ISA and can be used unconditionally.
+ */
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#define SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang need the target attribute to emit AVX2/SSE4.1 code in a
+// translation unit compiled for the baseline ISA; MSVC accepts the
+// intrinsics anywhere
+#if defined(__GNUC__) || defined(__clang__)
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#else
+#define SIMD_TARGET(isa)
+#endif
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer ring buffer
+ *
+ * Exactly one thread may push and exactly one other thread may pop. The
+ * fast path is an acquire load of the other side's index, which is cached
+ * and rarely taken, a release store of its own index, and a sequentially
+ * consistent fence followed by a relaxed load of the sleeper count. The
+ * fence is what keeps a wakeup from being lost (see wakeIfWaiting()); on
+ * x86 it costs about as much as an uncontended atomic increment. The
+ * blocking push() and pop() spin for a short while and then sleep on a
+ * condition variable; the other side only takes the mutex to wake them
+ * when somebody is actually sleeping, so an uncontended handoff never
+ * locks.
+ *
+ * @tparam T Element type; popped slots are reset to T() so that resources
+ *           such as shared frame handles are released promptly
+ */
+template <typename T>
+class SpscRing {
+public:
+    /**
+     * @brief Construct a ring
+     *
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     */
+    explicit SpscRing(size_t capacity = 16) {
+        reset(capacity);
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    /**
+     * @brief Drop all elements and resize the ring
+     *
+     * Not thread-safe: only call while neither side is using the ring.
+     *
+     * @param capacity Minimum number of elements; rounded up to a power of two
+     */
+    void reset(size_t capacity) {
+        size_t rounded = 1;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+
+        slots.assign(rounded, T());
+        mask = rounded - 1;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        cachedHead = 0;
+        cachedTail = 0;
+    }
+
+    /**
+     * @brief Get the number of slots
+     *
+     * @return Ring capacity
+     */
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+    /**
+     * @brief Get the number of queued elements
+     *
+     * Exact when called from the producer or consumer, approximate elsewhere.
+     *
+     * @return Queue depth
+     */
+    size_t size() const {
+        return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief Check whether the ring is empty
+     *
+     * @return true if nothing is queued
+     */
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /**
+     * @brief Push without blocking (producer only)
+     *
+     * @param item Element to move into the ring; left untouched on failure
+     * @return true if the element was queued, false if the ring was full
+     */
+    bool tryPush(T&& item) {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) {
+                return false;
+            }
+        }
+
+        slots[t & mask] = std::move(item);
+        tail.store(t + 1, std::memory_order_release);
+        wakeIfWaiting();
+        return true;
+    }
+
+    /**
+     * @brief Pop without blocking (consumer only)
+     *
+     * @param item Receives the oldest element
+     * @return true if an element was popped, false if the ring was empty
+     */
+    bool tryPop(T& item) {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+
+        item = std::move(slots[h & mask]);
+        slots[h & mask] = T();
+        head.store(h + 1, std::memory_order_release);
+        wakeIfWaiting();
+        return true;
+    }
+
+    /**
+     * @brief Peek at the oldest element (consumer only)
+     *
+     * @return Pointer to the oldest element, or nullptr if the ring is empty
+     */
+    T* front() {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return nullptr;
+            }
+        }
+        return &slots[h & mask];
+    }
+
+    /**
+     * @brief Push, waiting while the ring is full (producer only)
+     *
+     * @param item Element to move into the ring
+     * @param cancelled Predicate that aborts the wait when it returns true
+     * @return true if the element was queued, false if the wait was cancelled
+     */
+    template <typename Predicate>
+    bool push(T&& item, Predicate cancelled) {
+        for (int attempt = 0; ; ++attempt) {
+            if (tryPush(std::move(item))) {
+                return true;
+            }
+            if (cancelled()) {
+                return false;
+            }
+            if (attempt < SPIN_ATTEMPTS) {
+                std::this_thread::yield();
+                continue;
+            }
+            sleepUntil([this, &cancelled] {
+                return size() <= mask || cancelled();
+            });
+        }
+    }
+
+    /**
+     * @brief Pop, waiting while the ring is empty (consumer only)
+     *
+     * @param item Receives the oldest element
+     * @param finished Predicate that returns true once the producer will not
+     *                 push any more; elements queued before that are still
+     *                 returned
+     * @return true if an element was popped, false if the ring is empty and
+     *         the producer has finished
+     */
+    template <typename Predicate>
+    bool pop(T& item, Predicate finished) {
+        for (int attempt = 0; ; ++attempt) {
+            if (tryPop(item)) {
+                return true;
+            }
+            if (finished()) {
+                return tryPop(item);
+            }
+            if (attempt < SPIN_ATTEMPTS) {
+                std::this_thread::yield();
+                continue;
+            }
+            sleepUntil([this, &finished] {
+                return !empty() || finished();
+            });
+        }
+    }
+
+    /**
+     * @brief Wake any sleeping side so it re-checks its predicate
+     *
+     * Call after changing the state that a cancel or finish predicate reads.
+     */
+    void wakeAll() {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        wakeup.notify_all();
+    }
+
+private:
+    // Spins (with yield) before a blocked side goes to sleep
+    static constexpr int SPIN_ATTEMPTS = 64;
+
+    // Upper bound on a single sleep, as a safety net for missed predicate changes
+    static constexpr std::chrono::milliseconds MAX_SLEEP{50};
+
+    std::vector<T> slots;
+    size_t mask = 0;
+
+    // Consumer-owned index and the producer's cached view of it
+    alignas(64) std::atomic<size_t> head{0};
+    alignas(64) size_t cachedHead = 0;
+
+    // Producer-owned index and the consumer's cached view of it
+    alignas(64) std::atomic<size_t> tail{0};
+    alignas(64) size_t cachedTail = 0;
+
+    // Slow path for blocked sides
+    alignas(64) std::atomic<int> sleepers{0};
+    std::mutex sleepMutex;
+    std::condition_variable wakeup;
+
+    void wakeIfWaiting() {
+        // Pairs with the fence in sleepUntil: either the sleeper sees the new
+        // index in its predicate, or this side sees the sleeper and wakes it.
+        // Reading the count before the fence to skip it would reopen the
+        // race, leaving a sleeper to wait out MAX_SLEEP.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wakeup.notify_all();
+        }
+    }
+
+    template <typename Predicate>
+    void sleepUntil(Predicate ready) {
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            wakeup.wait_for(lock, MAX_SLEEP, ready);
+        }
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+};
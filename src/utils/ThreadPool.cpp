@@ -0,0 +1,196 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+// Pool and worker index of the calling thread, if it is a pool worker
+thread_local const ThreadPool* currentPool = nullptr;
+thread_local int currentIndex = -1;
+
+}  // namespace
+
+ThreadPool::ThreadPool(size_t threadCount)
+    : stopping(false), queuedTasks(0), nextWorker(0) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    taskAvailable.notify_all();
+
+    for (auto& thread : threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task, bool leaf) {
+    // Count first so the counter never drops below the number of queued tasks
+    ++queuedTasks;
+
+    int index = currentWorkerIndex();
+    if (index >= 0) {
+        // Keep work local to the submitting worker; others steal if idle
+        Worker& worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_front({std::move(task), leaf});
+    } else {
+        Worker& worker = *workers[nextWorker++ % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back({std::move(task), leaf});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    taskAvailable.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+    int index = currentWorkerIndex();
+    Task task;
+    if (!takeTask(index >= 0 ? index : 0, true, task)) {
+        return false;
+    }
+    task.function();
+    return true;
+}
+
+size_t ThreadPool::getThreadCount() const {
+    return threads.size();
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentIndex = static_cast<int>(index);
+
+    Task task;
+    while (true) {
+        if (takeTask(index, false, task)) {
+            task.function();
+            task.function = nullptr;
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping && queuedTasks == 0) {
+            break;
+        }
+        taskAvailable.wait(lock, [this] { return stopping || queuedTasks > 0; });
+    }
+}
+
+bool ThreadPool::takeTask(size_t home, bool leafOnly, Task& task) {
+    if (queuedTasks == 0) {
+        return false;
+    }
+
+    // Own deque first (newest task, still warm in cache), then steal the
+    // oldest task from the other workers in turn
+    for (size_t offset = 0; offset < workers.size(); ++offset) {
+        bool own = offset == 0;
+        Worker& worker = *workers[(home + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.tasks.empty()) {
+            continue;
+        }
+
+        if (!leafOnly) {
+            if (own) {
+                task = std::move(worker.tasks.front());
+                worker.tasks.pop_front();
+            } else {
+                task = std::move(worker.tasks.back());
+                worker.tasks.pop_back();
+            }
+            --queuedTasks;
+            return true;
+        }
+
+        auto it = std::find_if(worker.tasks.begin(), worker.tasks.end(),
+                               [](const Task& candidate) { return candidate.leaf; });
+        if (it != worker.tasks.end()) {
+            task = std::move(*it);
+            worker.tasks.erase(it);
+            --queuedTasks;
+            return true;
+        }
+    }
+    return false;
+}
+
+int ThreadPool::currentWorkerIndex() const {
+    return currentPool == this ? currentIndex : -1;
+}
+
+TaskGroup::TaskGroup(ThreadPool& pool)
+    : pool(pool), outstanding(0) {
+}
+
+TaskGroup::~TaskGroup() {
+    waitForTasks();
+}
+
+void TaskGroup::run(std::function<void()> task) {
+    ++outstanding;
+    pool.submit([this, task = std::move(task)] {
+        std::exception_ptr error;
+        try {
+            task();
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        // Decrement under the lock so wait() cannot return, and the group
+        // be destroyed, while this task still touches it
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error && !failure) {
+            failure = error;
+        }
+        if (--outstanding == 0) {
+            finished.notify_all();
+        }
+    });
+}
+
+void TaskGroup::wait() {
+    waitForTasks();
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(error, failure);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void TaskGroup::waitForTasks() {
+    while (outstanding > 0) {
+        // Help with queued work instead of blocking a pool thread
+        if (pool.runPendingTask()) {
+            continue;
+        }
+
+        // Our remaining tasks are running elsewhere
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait_for(lock, std::chrono::milliseconds(1), [this] { return outstanding == 0; });
+    }
+
+    // Synchronize with the last task leaving its critical section
+    std::lock_guard<std::mutex> lock(mutex);
+}
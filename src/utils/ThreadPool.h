@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Work-stealing thread pool shared by all videos of a batch
+ *
+ * Every worker owns a task deque. Tasks submitted from a worker go to the
+ * front of its own deque and are run from there, so a frame's work stays
+ * on the core that decoded it; idle workers steal from the back of other
+ * workers' deques. Tasks submitted from outside the pool are spread over
+ * the deques round-robin.
+ *
+ * Tasks are either leaf tasks, which never wait on other tasks, or
+ * blocking tasks, which may. A thread waiting in TaskGroup::wait() helps
+ * by running leaf tasks only, so blocking tasks never nest.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Start the worker threads
+     *
+     * @param threadCount Number of workers (0 = one per hardware thread)
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+
+    /**
+     * @brief Run the remaining tasks and join the workers
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queue a task
+     *
+     * @param task Function to run
+     * @param leaf True if the task never waits on other tasks
+     */
+    void submit(std::function<void()> task, bool leaf = true);
+
+    /**
+     * @brief Run one queued leaf task on the calling thread, if any
+     *
+     * @return true if a task was run
+     */
+    bool runPendingTask();
+
+    /**
+     * @brief Get the number of worker threads
+     *
+     * @return Worker count
+     */
+    size_t getThreadCount() const;
+
+private:
+    struct Task {
+        std::function<void()> function;
+        bool leaf = true;
+    };
+
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> stopping;
+    std::atomic<size_t> queuedTasks;
+    std::atomic<size_t> nextWorker;
+
+    // Idle workers sleep here until a task is queued
+    std::mutex sleepMutex;
+    std::condition_variable taskAvailable;
+
+    void workerLoop(size_t index);
+
+    // Pop from the front of our own deque or steal from the back of another
+    bool takeTask(size_t home, bool leafOnly, Task& task);
+
+    // Index of the calling worker in this pool, or -1 for outside threads
+    int currentWorkerIndex() const;
+};
+
+/**
+ * @brief Set of tasks that can be waited on together
+ *
+ * wait() runs queued leaf tasks while the group is busy instead of
+ * sleeping, so waiting for work never takes a thread away from the pool.
+ * An exception thrown by a task is kept and rethrown by wait(), so it
+ * reaches the code that started the work instead of a pool thread.
+ */
+class TaskGroup {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param pool Pool that runs the tasks
+     */
+    explicit TaskGroup(ThreadPool& pool);
+
+    /**
+     * @brief Waits for outstanding tasks
+     */
+    ~TaskGroup();
+
+    /**
+     * @brief Queue a leaf task as part of this group
+     *
+     * @param task Function to run; must not wait on other tasks
+     */
+    void run(std::function<void()> task);
+
+    /**
+     * @brief Wait until every task of the group has finished
+     *
+     * Rethrows the first exception a task threw since the last wait().
+     */
+    void wait();
+
+private:
+    ThreadPool& pool;
+    std::atomic<size_t> outstanding;
+    std::mutex mutex;
+    std::condition_variable finished;
+    std::exception_ptr failure;     ///< First exception of a task, guarded by mutex
+
+    // Wait without rethrowing; the destructor must not throw
+    void waitForTasks();
+};
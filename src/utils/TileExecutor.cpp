@@ -0,0 +1,33 @@
+#include "TileExecutor.h"
+#include <algorithm>
+
+TileExecutor::TileExecutor(ThreadPool& pool, int tileRows)
+    : pool(pool), tileRows(std::max(1, tileRows)) {
+}
+
+int TileExecutor::getTileRows() const {
+    return tileRows;
+}
+
+size_t TileExecutor::getTileCount(int rows) const {
+    return std::max<size_t>(1, (std::max(0, rows) + tileRows - 1) / tileRows);
+}
+
+void TileExecutor::forEachTile(int rows, const std::function<void(size_t tile, int first, int last)>& body) {
+    size_t tiles = getTileCount(rows);
+    if (tiles == 1) {
+        body(0, 0, std::max(0, rows));
+        return;
+    }
+
+    TaskGroup group(pool);
+    for (size_t tile = 1; tile < tiles; ++tile) {
+        int first = static_cast<int>(tile) * tileRows;
+        int last = std::min(rows, first + tileRows);
+        group.run([&body, tile, first, last] {
+            body(tile, first, last);
+        });
+    }
+    body(0, 0, std::min(rows, tileRows));
+    group.wait();
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "ThreadPool.h"
+#include <functional>
+
+/**
+ * @brief Splits a frame into horizontal tiles and runs them on a thread pool
+ *
+ * Used to finish one frame sooner instead of filtering several frames at
+ * once. The calling thread runs the first tile itself and helps with the
+ * others while it waits, so it may be a pool worker or an outside thread.
+ */
+class TileExecutor {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param pool Pool that runs the tiles
+     * @param tileRows Rows per tile (values below 1 are clamped to 1)
+     */
+    TileExecutor(ThreadPool& pool, int tileRows);
+
+    /**
+     * @brief Get the number of rows per tile
+     *
+     * @return Rows per tile; the last tile of a frame may be shorter
+     */
+    int getTileRows() const;
+
+    /**
+     * @brief Get the number of tiles a frame is split into
+     *
+     * @param rows Frame height
+     * @return Number of tiles, at least 1
+     */
+    size_t getTileCount(int rows) const;
+
+    /**
+     * @brief Run a function on every tile and wait for all of them
+     *
+     * The function receives the tile index and its row range [first, last).
+     * Tiles may run concurrently, so the function must only write data
+     * owned by its tile.
+     *
+     * @param rows Frame height
+     * @param body Function to run per tile
+     */
+    void forEachTile(int rows, const std::function<void(size_t tile, int first, int last)>& body);
+
+private:
+    ThreadPool& pool;
+    int tileRows;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free handoff of the latest value from one producer to one consumer
+ *
+ * Three buffers rotate between the roles "being written", "latest
+ * published" and "being read". Publishing swaps the written buffer with
+ * the published one and consuming swaps the read buffer with it, each in
+ * a single atomic exchange, so neither side ever waits for the other or
+ * copies the value. Values published faster than they are consumed are
+ * overwritten: the consumer always gets the most recent one.
+ *
+ * Exactly one thread may use the producer side (back(), publish()) and
+ * exactly one thread the consumer side (consume(), front()) at a time.
+ *
+ * @tparam T Buffer type; buffers are reused, so a cv::Mat keeps its allocation
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), backIndex(0), frontIndex(2) {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief Get the buffer the producer writes to
+     *
+     * @return Back buffer, owned by the producer until publish()
+     */
+    T& back() {
+        return buffers[backIndex];
+    }
+
+    /**
+     * @brief Make the back buffer the latest value
+     *
+     * The producer gets the previously published buffer back, or the one the
+     * consumer released, to write the next value into.
+     *
+     * @return true if the previously published value was never consumed
+     *         and is now lost
+     */
+    bool publish() {
+        uint8_t previous = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel);
+        backIndex = previous & INDEX_MASK;
+        return (previous & FRESH) != 0;
+    }
+
+    /**
+     * @brief Take the latest published value, if there is a new one
+     *
+     * @return true if front() now holds a value not seen before
+     */
+    bool consume() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief Check for a published value the consumer has not taken yet
+     *
+     * @return true if the next consume() will succeed
+     */
+    bool hasNew() const {
+        return (middle.load(std::memory_order_acquire) & FRESH) != 0;
+    }
+
+    /**
+     * @brief Get the buffer the consumer reads
+     *
+     * @return Front buffer, unchanged until the next consume()
+     */
+    T& front() {
+        return buffers[frontIndex];
+    }
+
+private:
+    static constexpr uint8_t INDEX_MASK = 0x3;
+    static constexpr uint8_t FRESH = 0x4;   ///< Set while the middle buffer has not been consumed
+
+    T buffers[3];
+    std::atomic<uint8_t> middle;            ///< Index of the published buffer, plus FRESH
+    uint8_t backIndex;
+    uint8_t frontIndex;
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Shared inputs for the VideoFilterApp_bench suite, and the timing
+ * helper of the standalone benchmarks
+ */
+namespace bench {
+
+/**
+ * @brief A benchmark resolution
+ */
+struct Resolution {
+    const char* name;
+    int width;
+    int height;
+};
+
+constexpr Resolution RESOLUTIONS[] = {
+    {"720p", 1280, 720},
+    {"1080p", 1920, 1080},
+    {"4K", 3840, 2160},
+};
+
+/**
+ * @brief Build a deterministic BGR test frame
+ *
+ * A shaded background with filled shapes and mild noise, so that edge
+ * detection and blur see realistic amounts of structure. The shapes move
+ * with the frame index.
+ *
+ * @param size Frame size
+ * @param index Frame index
+ * @return Synthetic frame
+ */
+cv::Mat syntheticFrame(const cv::Size& size, int index = 0);
+
+/**
+ * @brief Get the path of a generated test clip, writing it on first use
+ *
+ * The clip is Motion JPEG in an AVI container in the temporary directory,
+ * so it can be decoded by every OpenCV build with a video backend.
+ *
+ * @param size Frame size
+ * @param frames Number of frames
+ * @return Path of the clip, or an empty string if it could not be written
+ */
+std::string testClip(const cv::Size& size, int frames);
+
+/**
+ * @brief Time a callable and return the median of several runs
+ *
+ * One untimed run goes first, so allocating outputs and scratch and
+ * selecting kernels are not measured.
+ *
+ * @param iterations Number of timed runs
+ * @param run Work to time
+ * @return Median wall time in milliseconds
+ */
+template <typename Run>
+double medianMilliseconds(int iterations, Run run) {
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    run();
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        samples.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return samples[samples.size() / 2];
+}
+
+}  // namespace bench
@@ -0,0 +1,92 @@
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <map>
+#include <utility>
+#include "bench_common.h"
+
+/**
+ * @brief Entry point of the VideoFilterApp_bench suite
+ *
+ * Accepts the usual Google Benchmark flags; write results for a baseline
+ * comparison with
+ *
+ *   VideoFilterApp_bench --benchmark_out=current.json --benchmark_out_format=json
+ *   python3 compare_benchmarks.py baseline.json current.json --threshold 0.10
+ *
+ * Filter benchmarks run OpenCV single-threaded, because the pipeline
+ * already runs one filter per worker; pipeline benchmarks use OpenCV's
+ * default threading, as the application does.
+ */
+
+void registerFilterBenchmarks();
+void registerPipelineBenchmarks();
+
+namespace bench {
+
+cv::Mat syntheticFrame(const cv::Size& size, int index) {
+    cv::Mat frame(size, CV_8UC3);
+    for (int y = 0; y < size.height; ++y) {
+        cv::Vec3b* row = frame.ptr<cv::Vec3b>(y);
+        for (int x = 0; x < size.width; ++x) {
+            uchar shade = static_cast<uchar>(64 + 96 * x / size.width + 64 * y / size.height);
+            row[x] = cv::Vec3b(shade, static_cast<uchar>(shade / 2 + 40), static_cast<uchar>(200 - shade / 2));
+        }
+    }
+
+    cv::RNG rng(42);
+    int shapes = size.area() / 20000;
+    int shift = index * size.width / 200;
+    for (int i = 0; i < shapes; ++i) {
+        cv::Point centre((rng.uniform(0, size.width) + shift) % size.width, rng.uniform(0, size.height));
+        cv::Scalar colour(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        int extent = rng.uniform(size.height / 80, size.height / 10);
+        if (i % 2 == 0) {
+            cv::circle(frame, centre, extent, colour, cv::FILLED);
+        } else {
+            cv::rectangle(frame, cv::Rect(centre.x, centre.y, extent * 2, extent), colour, cv::FILLED);
+        }
+    }
+
+    cv::Mat noise(size, CV_8UC3);
+    cv::RNG noiseRng(static_cast<uint64_t>(index) + 1);
+    noiseRng.fill(noise, cv::RNG::UNIFORM, cv::Scalar::all(0), cv::Scalar::all(8));
+    frame += noise;
+    return frame;
+}
+
+std::string testClip(const cv::Size& size, int frames) {
+    static std::map<std::pair<int, int>, std::string> clips;
+    auto key = std::make_pair(size.width, size.height);
+    auto existing = clips.find(key);
+    if (existing != clips.end()) {
+        return existing->second;
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("videofilter_bench_" + std::to_string(size.width) + "x" +
+                         std::to_string(size.height) + ".avi")).string();
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 30.0, size);
+    if (!writer.isOpened()) {
+        return clips[key] = "";
+    }
+    for (int i = 0; i < frames; ++i) {
+        writer.write(syntheticFrame(size, i));
+    }
+    return clips[key] = path;
+}
+
+}  // namespace bench
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+
+    registerFilterBenchmarks();
+    registerPipelineBenchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
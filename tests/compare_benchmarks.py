@@ -0,0 +1,88 @@
+#!/usr/bin/env python3
+"""Compare two Google Benchmark JSON result files and fail on regressions.
+
+Usage: compare_benchmarks.py <baseline.json> <current.json> [--threshold 0.10] [--metric real_time]
+
+Benchmarks are matched by name. With --benchmark_repetitions the median
+aggregate is compared, otherwise the single run. A benchmark regresses
+when its time grows by more than the threshold (a fraction of the
+baseline). Benchmarks present in only one file are listed but do not
+fail the comparison. Exits with 1 if anything regressed.
+"""
+
+import argparse
+import json
+import sys
+
+TO_NANOSECONDS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def load_times(path, metric):
+    with open(path) as file:
+        results = json.load(file)
+
+    runs = {}
+    medians = {}
+    for entry in results.get("benchmarks", []):
+        if entry.get("error_occurred"):
+            continue
+        time = entry[metric] * TO_NANOSECONDS[entry.get("time_unit", "ns")]
+        if entry.get("run_type") == "aggregate":
+            if entry.get("aggregate_name") == "median":
+                medians[entry["run_name"]] = time
+        else:
+            # Keep the fastest repetition if there is no median aggregate
+            name = entry.get("run_name", entry["name"])
+            runs[name] = min(time, runs.get(name, time))
+
+    runs.update(medians)
+    return runs
+
+
+def format_time(nanoseconds):
+    for unit, scale in (("s", 1e9), ("ms", 1e6), ("us", 1e3)):
+        if nanoseconds >= scale:
+            return "%.3f %s" % (nanoseconds / scale, unit)
+    return "%.0f ns" % nanoseconds
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=0.10,
+                        help="allowed slowdown as a fraction of the baseline (default: 0.10)")
+    parser.add_argument("--metric", choices=("real_time", "cpu_time"), default="real_time")
+    args = parser.parse_args()
+
+    baseline = load_times(args.baseline, args.metric)
+    current = load_times(args.current, args.metric)
+
+    regressions = []
+    width = max([len(name) for name in current] + [9])
+    print("%-*s %12s %12s %8s" % (width, "Benchmark", "baseline", "current", "change"))
+    for name in sorted(current):
+        if name not in baseline:
+            print("%-*s %12s %12s %8s" % (width, name, "-", format_time(current[name]), "new"))
+            continue
+        change = current[name] / baseline[name] - 1.0
+        marker = ""
+        if change > args.threshold:
+            regressions.append(name)
+            marker = "  REGRESSION"
+        print("%-*s %12s %12s %+7.1f%%%s" % (width, name, format_time(baseline[name]),
+                                             format_time(current[name]), 100.0 * change, marker))
+
+    for name in sorted(set(baseline) - set(current)):
+        print("%-*s %12s %12s %8s" % (width, name, format_time(baseline[name]), "-", "missing"))
+
+    if regressions:
+        print("\n%d benchmark(s) slower than the baseline by more than %.0f%%"
+              % (len(regressions), 100.0 * args.threshold))
+        return 1
+    print("\nNo regressions above %.0f%%" % (100.0 * args.threshold))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,99 @@
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_common.h"
+#include "filters/FilterFactory.h"
+#include "filters/FilterChainPlan.h"
+
+/**
+ * @brief Filter microbenchmarks of the VideoFilterApp_bench suite
+ *
+ * Filter/<spec>/<resolution> times Filter::apply on one synthetic frame;
+ * Chain/<spec>/<resolution> times a whole chain through FilterChainPlan,
+ * the way a pipeline worker runs it. Both report frames and bytes per
+ * second.
+ */
+
+namespace {
+
+// Every filter FilterFactory can create; add new filters here
+const char* const FILTER_SPECS[] = {
+    "blur",
+    "edge",
+    "enhance",
+};
+
+// Chains that exercise fusion: point runs, bands with a halo, and a
+// global filter after a stencil
+const char* const CHAIN_SPECS[] = {
+    "blur:kernelSize=7,enhance",
+    "enhance,blur:kernelSize=7,edge",
+};
+
+void setFrameCounters(benchmark::State& state, const cv::Mat& input) {
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(input.total() * input.elemSize()));
+}
+
+void benchmarkFilter(benchmark::State& state, const std::string& spec, cv::Size size) {
+    std::shared_ptr<Filter> filter = FilterFactory::create(spec);
+    if (!filter) {
+        state.SkipWithError("unknown filter spec");
+        return;
+    }
+
+    cv::setNumThreads(1);
+    cv::Mat input = bench::syntheticFrame(size);
+    cv::Mat output;
+    filter->apply(input, output);  // allocate the output and scratch first
+    for (auto _ : state) {
+        filter->apply(input, output);
+        benchmark::DoNotOptimize(output.data);
+        benchmark::ClobberMemory();
+    }
+    setFrameCounters(state, input);
+}
+
+void benchmarkChain(benchmark::State& state, const std::string& spec, cv::Size size) {
+    std::vector<std::shared_ptr<Filter>> chain;
+    if (!FilterFactory::createChain(spec, chain)) {
+        state.SkipWithError("invalid chain spec");
+        return;
+    }
+
+    cv::setNumThreads(1);
+    cv::Mat input = bench::syntheticFrame(size);
+    cv::Mat output(size, input.type());
+    FilterChainPlan plan;
+    plan.reserve(size, input.type());
+    plan.build(chain);
+    plan.execute(input, output);
+    for (auto _ : state) {
+        plan.execute(input, output);
+        benchmark::DoNotOptimize(output.data);
+        benchmark::ClobberMemory();
+    }
+    setFrameCounters(state, input);
+}
+
+}  // namespace
+
+void registerFilterBenchmarks() {
+    for (const bench::Resolution& resolution : bench::RESOLUTIONS) {
+        cv::Size size(resolution.width, resolution.height);
+        for (const char* spec : FILTER_SPECS) {
+            benchmark::RegisterBenchmark(
+                (std::string("Filter/") + spec + "/" + resolution.name).c_str(),
+                [spec, size](benchmark::State& state) { benchmarkFilter(state, spec, size); })
+                ->Unit(benchmark::kMillisecond);
+        }
+        for (const char* spec : CHAIN_SPECS) {
+            benchmark::RegisterBenchmark(
+                (std::string("Chain/") + spec + "/" + resolution.name).c_str(),
+                [spec, size](benchmark::State& state) { benchmarkChain(state, spec, size); })
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+}
@@ -0,0 +1,139 @@
+#include <iostream>
+#include <string>
+#include <memory>
+#include <random>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include "sources/CaptureFrameSource.h"
+#include "sources/IndexedFrameSource.h"
+#include "sources/KeyframeIndex.h"
+
+/**
+ * @brief Unit test for the pixels of keyframe-indexed seeks
+ *
+ * Seeks an IndexedFrameSource, without and with its decoded frame cache,
+ * to random frames, back one frame at a time, and forward within a GOP,
+ * and checks that every frame it returns is identical to the one a fresh
+ * CaptureFrameSource seek to the same index returns. A keyframe index
+ * that does not match the display order (e.g. with B-frames) would make
+ * them differ.
+ *
+ * Without a video an MPEG-4 clip with 12-frame GOPs is generated; pass an
+ * H.264 file with B-frames to check that case. Exits with 77 (skipped)
+ * when no clip can be written or opened.
+ *
+ * Usage: indexed_seek_test [video]
+ */
+
+namespace {
+
+const int SKIPPED = 77;
+const int CLIP_FRAMES = 120;
+const size_t CACHE_BYTES = 64 * 1024 * 1024;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::string generateClip() {
+    std::string path = (std::filesystem::temp_directory_path() / "videofilter_indexed_seek_test.mp4").string();
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), 30.0, cv::Size(320, 240));
+    if (!writer.isOpened()) {
+        return std::string();
+    }
+    // Every frame looks different, so an off-by-one seek cannot match
+    cv::Mat frame(240, 320, CV_8UC3);
+    for (int i = 0; i < CLIP_FRAMES; ++i) {
+        frame.setTo(cv::Scalar((i * 2) % 256, 96, 160));
+        cv::circle(frame, cv::Point((i * 7) % 320, 120), 30, cv::Scalar(255, 255, 255), -1);
+        cv::putText(frame, std::to_string(i), cv::Point(10, 60), cv::FONT_HERSHEY_SIMPLEX, 1.5,
+                    cv::Scalar(0, 0, 0), 3);
+        writer.write(frame);
+    }
+    return path;
+}
+
+void checkTargets(const std::string& name, const std::string& path, const std::shared_ptr<KeyframeIndex>& index,
+                  size_t cacheBytes, const std::vector<int>& targets) {
+    auto inner = std::make_unique<CaptureFrameSource>();
+    check(inner->open(path), "the indexed source opens " + path);
+    IndexedFrameSource indexed(std::move(inner), index, cacheBytes);
+    CaptureFrameSource reference;
+    check(reference.open(path), "the reference source opens " + path);
+
+    cv::Mat frame;
+    cv::Mat expected;
+    for (int target : targets) {
+        std::string what = name + (cacheBytes ? " with cache" : "") + ", frame " + std::to_string(target);
+        bool read = indexed.seek(target) && indexed.read(frame);
+        bool referenceRead = reference.seek(target) && reference.read(expected);
+        check(read == referenceRead, what + ": both sources read it or neither does");
+        if (read && referenceRead) {
+            check(frame.size() == expected.size() && frame.type() == expected.type() &&
+                      cv::norm(frame, expected, cv::NORM_INF) == 0,
+                  what + ": same pixels as a plain seek");
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    bool generated = argc <= 1;
+    std::string path = generated ? generateClip() : argv[1];
+    CaptureFrameSource probe;
+    if (path.empty() || !probe.open(path) || probe.getFrameCount() < 2) {
+        std::cout << "Skipped: could not open or generate a video to seek in" << std::endl;
+        return SKIPPED;
+    }
+    int frameCount = probe.getFrameCount();
+
+    auto index = std::make_shared<KeyframeIndex>();
+    index->build(path, false);
+    auto start = std::chrono::steady_clock::now();
+    while (!index->isComplete() && std::chrono::steady_clock::now() - start < std::chrono::seconds(60)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    if (!index->isComplete()) {
+        std::cout << "Note: no keyframe index (needs OpenCV 4.7+ with FFmpeg); checking plain seeks" << std::endl;
+    }
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> anywhere(0, frameCount - 1);
+    std::vector<int> jumps(60);
+    for (int& target : jumps) {
+        target = anywhere(random);
+    }
+    std::vector<int> stepsBack;
+    for (int target = std::min(frameCount, 40) - 1; target >= 0; --target) {
+        stepsBack.push_back(target);
+    }
+    std::vector<int> forward;
+    for (int target = frameCount / 2; target < std::min(frameCount, frameCount / 2 + 30); target += 3) {
+        forward.push_back(target);
+    }
+
+    for (size_t cacheBytes : {size_t(0), CACHE_BYTES}) {
+        checkTargets("random seeks", path, index, cacheBytes, jumps);
+        checkTargets("stepping back", path, index, cacheBytes, stepsBack);
+        checkTargets("forward in a GOP", path, index, cacheBytes, forward);
+    }
+
+    if (generated) {
+        std::filesystem::remove(path);
+    }
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All indexed seek checks passed (" << frameCount << " frames)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <opencv2/opencv.hpp>
+#include "filters/ColorEnhanceFilter.h"
+#include "filters/EdgeDetectionFilter.h"
+#include "filters/SeparableBlur.h"
+
+/**
+ * @brief Unit test that runs every SIMD kernel against the scalar path
+ *
+ * For ColorEnhanceFilter, SeparableBlur and the fused Canny of
+ * EdgeDetectionFilter, filters random frames with each instruction set
+ * this CPU supports and requires the output to match the scalar kernels
+ * bit for bit. Widths are odd and straddle every vector width, so the
+ * tails are covered, and the parameters include the ends of their ranges
+ * (contrast 8, brightness -255 and 255, saturation 0 and 8) and a
+ * saturation for each fixed-point step of the blend.
+ *
+ * Usage: kernel_equivalence_test
+ */
+
+namespace {
+
+const int WIDTHS[] = {1, 7, 15, 17, 31, 33, 63, 65, 97, 129, 641};
+const int HEIGHT = 5;
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+cv::Mat randomFrame(int width, int height, int channels) {
+    static cv::RNG rng(12345);
+    cv::Mat frame(height, width, CV_8UC(channels));
+    rng.fill(frame, cv::RNG::UNIFORM, 0, 256);
+    return frame;
+}
+
+bool identical(const cv::Mat& a, const cv::Mat& b) {
+    return a.size() == b.size() && a.type() == b.type() && cv::norm(a, b, cv::NORM_INF) == 0;
+}
+
+std::string describe(const char* isa, int width, int channels) {
+    return std::string(isa) + ", " + std::to_string(width) + " px, " + std::to_string(channels) + " ch";
+}
+
+void testColorEnhance() {
+    const std::vector<std::map<std::string, double>> settings = {
+        {},
+        {{"contrast", 8.0}},
+        {{"brightness", 255.0}},
+        {{"brightness", -255.0}},
+        {{"saturation", 0.0}},
+        {{"saturation", 8.0}},
+        {{"saturation", 0.5}},
+        {{"saturation", 3.0}},
+        {{"saturation", 6.0}},
+        {{"gamma", 0.5}},
+        {{"contrast", 8.0}, {"brightness", -255.0}, {"saturation", 8.0}},
+        {{"contrast", 0.0}, {"brightness", 255.0}, {"saturation", 0.0}, {"gamma", 2.2}},
+        {{"contrast", 1.0}, {"brightness", 0.0}, {"saturation", 1.0}, {"gamma", 1.0}},
+    };
+    const ColorEnhanceFilter::Isa isas[] = {ColorEnhanceFilter::Isa::Sse41, ColorEnhanceFilter::Isa::Avx2,
+                                            ColorEnhanceFilter::Isa::Avx512Vbmi, ColorEnhanceFilter::Isa::Neon};
+
+    for (size_t setting = 0; setting < settings.size(); ++setting) {
+        ColorEnhanceFilter filter;
+        filter.configure(settings[setting]);
+        for (int channels : {1, 3, 4}) {
+            for (int width : WIDTHS) {
+                // A view into a wider frame also takes the row-by-row path
+                cv::Mat padded = randomFrame(width + 3, HEIGHT, channels);
+                for (const cv::Mat& input : {randomFrame(width, HEIGHT, channels),
+                                             padded(cv::Rect(1, 0, width, HEIGHT))}) {
+                    cv::Mat expected;
+                    filter.apply(input, expected, ColorEnhanceFilter::Isa::Scalar);
+                    for (ColorEnhanceFilter::Isa isa : isas) {
+                        if (!ColorEnhanceFilter::isAvailable(isa)) {
+                            continue;
+                        }
+                        cv::Mat output;
+                        filter.apply(input, output, isa);
+                        check(identical(output, expected),
+                              "ColorEnhance setting " + std::to_string(setting) + ", " +
+                                  describe(ColorEnhanceFilter::isaName(isa), width, channels));
+                    }
+                }
+            }
+        }
+    }
+}
+
+void testSeparableBlur() {
+    const SeparableBlur::Isa isas[] = {SeparableBlur::Isa::Sse41, SeparableBlur::Isa::Avx2,
+                                       SeparableBlur::Isa::Neon};
+
+    for (int kernelSize : {3, 5, 9, 15, 31, 63}) {
+        SeparableBlur blur;
+        blur.configure(kernelSize, 0, 0);
+        for (int channels : {1, 3, 4}) {
+            for (int width : WIDTHS) {
+                // The frame must be larger than the radius both ways
+                cv::Mat input = randomFrame(width, kernelSize + 2, channels);
+                cv::Mat expected;
+                if (!blur.apply(input, expected, SeparableBlur::Isa::Scalar)) {
+                    continue;
+                }
+                for (SeparableBlur::Isa isa : isas) {
+                    if (!SeparableBlur::isAvailable(isa)) {
+                        continue;
+                    }
+                    cv::Mat output;
+                    blur.apply(input, output, isa);
+                    check(identical(output, expected),
+                          "SeparableBlur ksize " + std::to_string(kernelSize) + ", " +
+                              describe(SeparableBlur::isaName(isa), width, channels));
+                }
+            }
+        }
+    }
+}
+
+void testFusedCanny() {
+    const EdgeDetectionFilter::Isa isas[] = {EdgeDetectionFilter::Isa::Sse41, EdgeDetectionFilter::Isa::Avx2,
+                                             EdgeDetectionFilter::Isa::Neon};
+    const std::pair<double, double> thresholds[] = {{100, 200}, {0, 0}, {20, 60}, {2000, 3000}};
+
+    for (const auto& threshold : thresholds) {
+        EdgeDetectionFilter filter(threshold.first, threshold.second, 3);
+        for (int channels : {1, 3}) {
+            for (int width : WIDTHS) {
+                // Smoothed noise has edges of every direction and strength
+                cv::Mat input = randomFrame(width, 2 * HEIGHT + 1, channels);
+                cv::blur(input, input, cv::Size(3, 3));
+                cv::Mat expected;
+                filter.apply(input, expected, EdgeDetectionFilter::Isa::Scalar);
+                for (EdgeDetectionFilter::Isa isa : isas) {
+                    if (!EdgeDetectionFilter::isAvailable(isa)) {
+                        continue;
+                    }
+                    cv::Mat output;
+                    filter.apply(input, output, isa);
+                    check(identical(output, expected),
+                          "Canny " + std::to_string(static_cast<int>(threshold.first)) + "/" +
+                              std::to_string(static_cast<int>(threshold.second)) + ", " +
+                              describe(EdgeDetectionFilter::isaName(isa), width, channels));
+                }
+            }
+        }
+    }
+
+    // Thresholds beyond the int range find no edges on any instruction set
+    EdgeDetectionFilter strict(1e12, 1e12, 3);
+    cv::Mat input = randomFrame(65, 2 * HEIGHT + 1, 1);
+    for (EdgeDetectionFilter::Isa isa : {EdgeDetectionFilter::Isa::Scalar, EdgeDetectionFilter::Isa::Sse41,
+                                         EdgeDetectionFilter::Isa::Avx2, EdgeDetectionFilter::Isa::Neon}) {
+        if (!EdgeDetectionFilter::isAvailable(isa)) {
+            continue;
+        }
+        cv::Mat output;
+        strict.apply(input, output, isa);
+        check(cv::countNonZero(output) == 0, std::string("Canny 1e12/1e12, ") + EdgeDetectionFilter::isaName(isa));
+    }
+}
+
+}  // namespace
+
+int main() {
+    testColorEnhance();
+    testSeparableBlur();
+    testFusedCanny();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All kernel equivalence checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,187 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+#include <cstring>
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+#include "metrics/MetricsExporter.h"
+
+/**
+ * @brief Unit test that scrapes the metrics exporter's targets
+ *
+ * Exports an idle VideoProcessor to a JSON lines file, a Prometheus file
+ * and a Unix socket in both formats, and checks that a scrape yields a
+ * complete JSON line and the frames_in_total sample with its type and job
+ * label.
+ *
+ * Usage: metrics_exporter_test
+ */
+
+namespace {
+
+const char* const JOB = "exporter test";
+const char* const FRAMES_SAMPLE = "videofilter_frames_in_total{job=\"exporter test\"} 0";
+const char* const FRAMES_TYPE = "# TYPE videofilter_frames_in_total counter";
+
+int failures = 0;
+
+void check(bool condition, const std::string& what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+std::string temporaryPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / name).string();
+}
+
+std::vector<std::string> readLines(const std::string& path) {
+    std::vector<std::string> lines;
+    std::ifstream file(path);
+    std::string line;
+    while (std::getline(file, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+bool hasLine(const std::vector<std::string>& lines, const std::string& expected) {
+    for (const std::string& line : lines) {
+        if (line == expected) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::string> splitLines(const std::string& text) {
+    std::vector<std::string> lines;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+// Export for a few intervals, then stop, which writes one last snapshot
+void exportToFile(const VideoProcessor& processor, const std::string& path, MetricsExporter::Format format) {
+    std::filesystem::remove(path);
+    MetricsExporter::Options options;
+    options.target = path;
+    options.format = format;
+    options.intervalMs = 20;
+    options.label = JOB;
+    MetricsExporter exporter(processor, options);
+    check(exporter.start(), "exporter opens " + path);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    exporter.stop();
+}
+
+void testJsonLinesFile(const VideoProcessor& processor) {
+    std::string path = temporaryPath("videofilter_metrics_test.jsonl");
+    exportToFile(processor, path, MetricsExporter::Format::JsonLines);
+
+    std::vector<std::string> lines = readLines(path);
+    check(lines.size() >= 2, "one JSON line per interval is appended");
+    if (!lines.empty()) {
+        const std::string& last = lines.back();
+        check(last.front() == '{' && last.back() == '}', "each line is one JSON object");
+        check(last.find("\"job\":\"exporter test\"") != std::string::npos, "the line carries the job label");
+        check(last.find("\"frames_in\":0") != std::string::npos, "the line holds the frame counters");
+    }
+    std::filesystem::remove(path);
+}
+
+void testPrometheusFile(const VideoProcessor& processor) {
+    std::string path = temporaryPath("videofilter_metrics_test.prom");
+    exportToFile(processor, path, MetricsExporter::Format::Prometheus);
+
+    std::vector<std::string> lines = readLines(path);
+    check(hasLine(lines, FRAMES_TYPE), "the Prometheus file declares the counter");
+    check(hasLine(lines, FRAMES_SAMPLE), "the Prometheus file holds the sample");
+    check(!std::filesystem::exists(path + ".tmp"), "the file is replaced, not left half-written");
+    std::filesystem::remove(path);
+}
+
+#ifndef _WIN32
+
+// Read everything the exporter sends on one connection
+bool scrapeSocket(const std::string& path, std::string& text) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    int client = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (client < 0) {
+        return false;
+    }
+    if (connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        close(client);
+        return false;
+    }
+    char buffer[4096];
+    ssize_t received = 0;
+    while ((received = recv(client, buffer, sizeof(buffer), 0)) > 0) {
+        text.append(buffer, static_cast<size_t>(received));
+    }
+    close(client);
+    return received == 0;
+}
+
+void testSocket(const VideoProcessor& processor, MetricsExporter::Format format) {
+    std::string path = temporaryPath("videofilter_metrics_test.sock");
+    MetricsExporter::Options options;
+    options.target = "unix:" + path;
+    options.format = format;
+    options.label = JOB;
+    MetricsExporter exporter(processor, options);
+    check(exporter.start(), "exporter listens on " + path);
+
+    // Every connection gets a fresh snapshot
+    for (int scrape = 0; scrape < 2; ++scrape) {
+        std::string text;
+        check(scrapeSocket(path, text), "the socket answers and closes the connection");
+        std::vector<std::string> lines = splitLines(text);
+        if (format == MetricsExporter::Format::JsonLines) {
+            check(lines.size() == 1, "a JSON scrape is one line");
+            check(!lines.empty() && lines[0].front() == '{' && lines[0].back() == '}',
+                  "the scrape is one JSON object");
+            check(text.find("\"job\":\"exporter test\"") != std::string::npos, "the scrape carries the job label");
+        } else {
+            check(hasLine(lines, FRAMES_TYPE), "the scrape declares the counter");
+            check(hasLine(lines, FRAMES_SAMPLE), "the scrape holds the sample");
+        }
+    }
+    exporter.stop();
+    check(!std::filesystem::exists(path), "stopping removes the socket file");
+}
+
+#endif
+
+}  // namespace
+
+int main() {
+    VideoProcessor processor;
+    testJsonLinesFile(processor);
+    testPrometheusFile(processor);
+#ifndef _WIN32
+    testSocket(processor, MetricsExporter::Format::JsonLines);
+    testSocket(processor, MetricsExporter::Format::Prometheus);
+#endif
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All metrics exporter checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "bench_common.h"
+#include "VideoProcessor.h"
+#include "filters/FilterFactory.h"
+
+/**
+ * @brief End-to-end VideoProcessor benchmarks of the VideoFilterApp_bench suite
+ *
+ * Each iteration runs the threaded pipeline over a generated Motion JPEG
+ * clip, from startProcessing() until every frame has left the pipeline,
+ * and reports frames per second of wall time:
+ *
+ * - Pipeline/<chain>/<resolution>: decode and filter with one worker per
+ *   core, nothing written ("none" measures decoding alone);
+ * - Pipeline/live/...: two workers with 64-row tiles, as the UI runs;
+ * - Pipeline/transcode/...: like the first, plus Motion JPEG encoding;
+ * - Pipeline/synthetic/...: like the first, fed by a SyntheticFrameSource
+ *   instead of the clip, so the numbers exclude decoding and do not vary
+ *   with the codec.
+ */
+
+namespace {
+
+constexpr int CLIP_FRAMES = 60;
+
+const char* const PIPELINE_CHAINS[] = {
+    "none",
+    "blur:kernelSize=7,enhance",
+    "edge",
+};
+
+const char* const LIVE_CHAIN = "blur:kernelSize=7,enhance";
+
+struct PipelineConfig {
+    std::string chain;
+    size_t workers = 0;     ///< 0 = VideoProcessor default
+    int tileRows = 0;
+    bool encode = false;
+    bool synthetic = false;     ///< Generate frames instead of decoding the clip
+};
+
+// VideoProcessor reports progress on stdout, which would interleave with
+// the benchmark output
+class QuietStdout {
+public:
+    QuietStdout() : previous(std::cout.rdbuf(nullptr)) {}
+    ~QuietStdout() { std::cout.rdbuf(previous); }
+
+private:
+    std::streambuf* previous;
+};
+
+void benchmarkPipeline(benchmark::State& state, const PipelineConfig& config, cv::Size size) {
+    std::string clip = config.synthetic
+        ? "synthetic:width=" + std::to_string(size.width) + ":height=" + std::to_string(size.height) +
+              ":frames=" + std::to_string(CLIP_FRAMES) + ":noise=4"
+        : bench::testClip(size, CLIP_FRAMES);
+    if (clip.empty()) {
+        state.SkipWithError("could not write the test clip");
+        return;
+    }
+    cv::setNumThreads(-1);
+    std::string output = (std::filesystem::temp_directory_path() / "videofilter_bench_out.avi").string();
+
+    int64_t frames = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        QuietStdout quiet;
+        VideoProcessor processor;
+        processor.setDisplayEnabled(false);
+        if (config.workers > 0) {
+            processor.setWorkerCount(config.workers);
+        }
+        processor.setTileRows(config.tileRows);
+
+        std::vector<std::shared_ptr<Filter>> chain;
+        bool ready = processor.openVideo(clip) &&
+                     (config.chain == "none" || FilterFactory::createChain(config.chain, chain));
+        for (const auto& filter : chain) {
+            processor.addFilter(filter);
+        }
+        if (ready && config.encode) {
+            ready = processor.setOutputFile(output, cv::VideoWriter::fourcc('M', 'J', 'P', 'G'), 0);
+        }
+        if (!ready) {
+            state.SkipWithError("could not set up the pipeline");
+            break;
+        }
+        state.ResumeTiming();
+
+        processor.startProcessing();
+        processor.waitForCompletion();
+        processor.stopProcessing();
+        frames += static_cast<int64_t>(processor.getProcessedFrameCount());
+    }
+
+    state.SetItemsProcessed(frames);
+    state.counters["frames"] = static_cast<double>(CLIP_FRAMES);
+    std::error_code ignored;
+    std::filesystem::remove(output, ignored);
+}
+
+void registerPipeline(const std::string& name, const PipelineConfig& config, cv::Size size) {
+    benchmark::RegisterBenchmark(
+        name.c_str(),
+        [config, size](benchmark::State& state) { benchmarkPipeline(state, config, size); })
+        ->Unit(benchmark::kMillisecond)
+        ->UseRealTime();
+}
+
+}  // namespace
+
+void registerPipelineBenchmarks() {
+    // 4K clips take long to generate and decode; filters are covered at
+    // 4K by the microbenchmarks
+    for (const bench::Resolution& resolution : bench::RESOLUTIONS) {
+        if (resolution.height > 1080) {
+            continue;
+        }
+        cv::Size size(resolution.width, resolution.height);
+        std::string suffix = std::string("/") + resolution.name;
+
+        for (const char* chain : PIPELINE_CHAINS) {
+            PipelineConfig config;
+            config.chain = chain;
+            registerPipeline(std::string("Pipeline/") + chain + suffix, config, size);
+        }
+
+        PipelineConfig live;
+        live.chain = LIVE_CHAIN;
+        live.workers = 2;
+        live.tileRows = 64;
+        registerPipeline(std::string("Pipeline/live/") + LIVE_CHAIN + suffix, live, size);
+
+        PipelineConfig transcode;
+        transcode.chain = LIVE_CHAIN;
+        transcode.encode = true;
+        registerPipeline(std::string("Pipeline/transcode/") + LIVE_CHAIN + suffix, transcode, size);
+
+        for (const char* chain : PIPELINE_CHAINS) {
+            PipelineConfig synthetic;
+            synthetic.chain = chain;
+            synthetic.synthetic = true;
+            registerPipeline(std::string("Pipeline/synthetic/") + chain + suffix, synthetic, size);
+        }
+    }
+}
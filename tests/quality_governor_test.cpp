@@ -0,0 +1,109 @@
+#include <iostream>
+#include <cstdint>
+#include "utils/QualityGovernor.h"
+
+/**
+ * @brief Unit test for the quality governor's step-down and step-up rules
+ *
+ * Feeds synthetic filter timings against a 10 ms budget and checks after
+ * how many frames the governor changes level: five over-budget frames step
+ * down, thirty frames well under the projected budget step back up.
+ *
+ * Usage: quality_governor_test
+ */
+
+namespace {
+
+const double BUDGET_MS = 10.0;
+const uint64_t SLOW_NS = 20000000;  // Twice the budget
+const uint64_t FAST_NS = 2000000;   // Fits at the next level up too
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::cerr << "FAILED: " << what << std::endl;
+        ++failures;
+    }
+}
+
+// Record `frames` samples and return how many it took to leave the level,
+// or 0 if it did not change
+int framesUntilStep(QualityGovernor& governor, int frames, uint64_t filterNs) {
+    size_t level = governor.getStats().level;
+    for (int frame = 1; frame <= frames; ++frame) {
+        governor.record(governor.getScale(), filterNs);
+        if (governor.getStats().level != level) {
+            return frame;
+        }
+    }
+    return 0;
+}
+
+void testStepDown() {
+    QualityGovernor governor;
+    governor.reset(BUDGET_MS);
+    check(governor.getScale() == 1.0, "reset() starts at full resolution");
+    check(framesUntilStep(governor, 10, SLOW_NS) == 5, "five slow frames step down");
+    check(governor.getScale() == 0.75, "first step goes to 0.75");
+    check(framesUntilStep(governor, 10, SLOW_NS) == 5, "five more step down again");
+    check(governor.getScale() == 0.5, "second step goes to 0.5");
+    check(framesUntilStep(governor, 50, SLOW_NS) == 0, "the bottom of the ladder holds");
+    check(governor.getStats().levelChanges == 2, "both steps are counted");
+}
+
+void testStepUp() {
+    QualityGovernor governor;
+    governor.reset(BUDGET_MS);
+    framesUntilStep(governor, 10, SLOW_NS);
+    check(framesUntilStep(governor, 50, FAST_NS) == 30, "thirty fast frames step up");
+    check(governor.getScale() == 1.0, "stepping up returns to full resolution");
+}
+
+void testHysteresis() {
+    QualityGovernor governor;
+    governor.reset(BUDGET_MS);
+
+    // After fast frames the average needs three slow ones to cross the
+    // threshold, then the usual five to step down
+    check(framesUntilStep(governor, 20, FAST_NS) == 0, "fast frames keep full resolution");
+    check(framesUntilStep(governor, 20, SLOW_NS) == 7, "the moving average delays the step-down");
+
+    // Projected to full resolution, 5 ms at 0.75 is about 8.9 ms: inside the
+    // budget but above the step-up threshold
+    governor.reset(BUDGET_MS);
+    framesUntilStep(governor, 10, SLOW_NS);
+    check(framesUntilStep(governor, 100, 5000000) == 0, "a level close to the budget does not step up");
+}
+
+void testIgnoredSamples() {
+    QualityGovernor governor;
+    governor.reset(BUDGET_MS);
+    framesUntilStep(governor, 10, SLOW_NS);
+
+    // Frames still filtered at the old scale say nothing about this level
+    for (int frame = 0; frame < 100; ++frame) {
+        governor.record(1.0, FAST_NS);
+    }
+    check(governor.getScale() == 0.75, "samples at another scale are ignored");
+
+    QualityGovernor unbudgeted;
+    unbudgeted.reset(0.0);
+    check(framesUntilStep(unbudgeted, 100, SLOW_NS) == 0, "no budget keeps full resolution");
+}
+
+}  // namespace
+
+int main() {
+    testStepDown();
+    testStepUp();
+    testHysteresis();
+    testIgnoredSamples();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "All quality governor checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <functional>
+#include <filesystem>
+#include <cstdlib>
+#include <opencv2/opencv.hpp>
+#include "sources/CaptureFrameSource.h"
+#include "sources/IndexedFrameSource.h"
+#include "sources/KeyframeIndex.h"
+
+/**
+ * @brief Seek latency of the keyframe-indexed source vs. plain VideoCapture seeks
+ *
+ * Seeks to random frames, and steps back one frame at a time the way the
+ * GUI's "," key does, through a CaptureFrameSource and through an
+ * IndexedFrameSource without and with its decoded frame cache. Reports
+ * the 50th and 95th percentile of the time to seek and read one frame,
+ * and counts frames that differ from the plain seek's, which would point
+ * at keyframe positions that do not match the display order.
+ *
+ * Without a video an MPEG-4 clip with 12-frame GOPs is generated; pass a
+ * long-GOP file (e.g. H.264 with B-frames) for representative numbers.
+ *
+ * Usage: seek_bench [video] [seeks]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t CACHE_BYTES = 256 * 1024 * 1024;
+
+struct Result {
+    double p50;
+    double p95;
+    int mismatches;
+};
+
+std::string generateClip() {
+    std::string path = (std::filesystem::temp_directory_path() / "videofilter_seek_bench.mp4").string();
+    cv::VideoWriter writer(path, cv::VideoWriter::fourcc('m', 'p', '4', 'v'), 30.0, cv::Size(1280, 720));
+    if (!writer.isOpened()) {
+        return std::string();
+    }
+    cv::Mat frame(720, 1280, CV_8UC3);
+    for (int i = 0; i < 600; ++i) {
+        frame.setTo(cv::Scalar(i % 256, 96, 160));
+        cv::circle(frame, cv::Point((i * 7) % 1280, 360), 80, cv::Scalar(255, 255, 255), -1);
+        cv::putText(frame, std::to_string(i), cv::Point(40, 120), cv::FONT_HERSHEY_SIMPLEX, 3.0,
+                    cv::Scalar(0, 0, 0), 6);
+        writer.write(frame);
+    }
+    return path;
+}
+
+// Reference frames come from a fresh plain seek, so both sides count
+// frames the same way as cv::VideoCapture does
+Result measure(FrameSource& source, CaptureFrameSource& reference, const std::vector<int>& targets) {
+    std::vector<double> samples;
+    samples.reserve(targets.size());
+    cv::Mat frame;
+    cv::Mat expected;
+    int mismatches = 0;
+    for (int target : targets) {
+        auto start = Clock::now();
+        bool read = source.seek(target) && source.read(frame);
+        samples.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+
+        if (!read || !reference.seek(target) || !reference.read(expected) || frame.size() != expected.size() ||
+            cv::norm(frame, expected, cv::NORM_INF) != 0) {
+            ++mismatches;
+        }
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double fraction) {
+        return samples[static_cast<size_t>(fraction * (samples.size() - 1) + 0.5)];
+    };
+    return {at(0.50), at(0.95), mismatches};
+}
+
+void printRow(const std::string& label, const Result& result, double baseline) {
+    std::cout << std::left << std::setw(22) << label << std::right << std::fixed << std::setprecision(2)
+              << std::setw(10) << result.p50 << std::setw(10) << result.p95
+              << std::setw(9) << baseline / result.p50 << "x"
+              << std::setw(12) << result.mismatches << std::endl;
+}
+
+void runPattern(const std::string& name, const std::string& path, const std::shared_ptr<KeyframeIndex>& index,
+                const std::vector<int>& targets) {
+    std::cout << std::endl << name << " (" << targets.size() << " seeks, ms per seek + read)" << std::endl;
+    std::cout << std::left << std::setw(22) << "source" << std::right << std::setw(10) << "p50"
+              << std::setw(10) << "p95" << std::setw(10) << "speedup" << std::setw(12) << "mismatches"
+              << std::endl;
+
+    CaptureFrameSource reference;
+    reference.open(path);
+
+    auto plain = std::make_unique<CaptureFrameSource>();
+    plain->open(path);
+    Result baseline = measure(*plain, reference, targets);
+    printRow("VideoCapture seek", baseline, baseline.p50);
+
+    for (size_t cacheBytes : {size_t(0), CACHE_BYTES}) {
+        auto inner = std::make_unique<CaptureFrameSource>();
+        inner->open(path);
+        IndexedFrameSource indexed(std::move(inner), index, cacheBytes);
+        Result result = measure(indexed, reference, targets);
+        printRow(cacheBytes ? "indexed, 256 MB cache" : "indexed, no cache", result, baseline.p50);
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : generateClip();
+    int seeks = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+    CaptureFrameSource probe;
+    if (path.empty() || !probe.open(path) || probe.getFrameCount() < 2) {
+        std::cerr << "Error: Could not open or generate a video to seek in" << std::endl;
+        return 1;
+    }
+    int frameCount = probe.getFrameCount();
+
+    // Seek against the finished index; the sidecar would skip the scan
+    auto index = std::make_shared<KeyframeIndex>();
+    auto scanStart = Clock::now();
+    index->build(path, false);
+    while (!index->isComplete() && Clock::now() - scanStart < std::chrono::seconds(60)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    double scanMs = std::chrono::duration<double, std::milli>(Clock::now() - scanStart).count();
+    std::cout << "Seek latency, " << path << " (" << frameCount << " frames)" << std::endl;
+    if (index->isComplete()) {
+        std::cout << "Index: " << index->size() << " keyframes, scanned in " << std::fixed
+                  << std::setprecision(1) << scanMs << " ms" << std::endl;
+    } else {
+        std::cout << "Index: not available (needs OpenCV 4.7+ with FFmpeg); "
+                  << "the indexed source falls back to plain seeks" << std::endl;
+    }
+
+    std::mt19937 random(42);
+    std::uniform_int_distribution<int> anywhere(0, frameCount - 1);
+    std::vector<int> jumps(seeks);
+    for (int& target : jumps) {
+        target = anywhere(random);
+    }
+    runPattern("random seeks", path, index, jumps);
+
+    std::vector<int> stepsBack;
+    for (int target = frameCount - 1; target >= 0 && static_cast<int>(stepsBack.size()) < seeks; --target) {
+        stepsBack.push_back(target);
+    }
+    runPattern("stepping back", path, index, stepsBack);
+    return 0;
+}
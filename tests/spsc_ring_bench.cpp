@@ -0,0 +1,164 @@
+#include <iostream>
+#include <iomanip>
+#include <queue>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "utils/SpscRing.h"
+
+/**
+ * @brief Microbenchmark for the capture -> processing frame handoff
+ *
+ * Compares SpscRing against the bounded std::queue + mutex + condition
+ * variable handoff that VideoProcessor used before. Throughput streams
+ * items from one thread to another through a bounded queue; latency
+ * bounces a single item between two threads through a pair of queues and
+ * reports half the round trip.
+ *
+ * Usage: spsc_ring_bench [items] [round trips]
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+const size_t QUEUE_CAPACITY = 16;
+
+// The previous handoff: one lock per push and pop, one shared condition variable
+class MutexQueue {
+public:
+    explicit MutexQueue(size_t capacity) : capacity(capacity) {}
+
+    void push(uint64_t value) {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return items.size() < capacity; });
+        items.push(value);
+        lock.unlock();
+        condition.notify_all();
+    }
+
+    uint64_t pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        condition.wait(lock, [this] { return !items.empty(); });
+        uint64_t value = items.front();
+        items.pop();
+        lock.unlock();
+        condition.notify_all();
+        return value;
+    }
+
+private:
+    size_t capacity;
+    std::queue<uint64_t> items;
+    std::mutex mutex;
+    std::condition_variable condition;
+};
+
+class RingQueue {
+public:
+    explicit RingQueue(size_t capacity) : ring(capacity) {}
+
+    void push(uint64_t value) {
+        ring.push(std::move(value), [] { return false; });
+    }
+
+    uint64_t pop() {
+        uint64_t value = 0;
+        ring.pop(value, [] { return false; });
+        return value;
+    }
+
+private:
+    SpscRing<uint64_t> ring;
+};
+
+template <typename Queue>
+double measureThroughput(uint64_t items) {
+    Queue queue(QUEUE_CAPACITY);
+    auto start = Clock::now();
+
+    std::thread producer([&queue, items] {
+        for (uint64_t i = 0; i < items; ++i) {
+            queue.push(i);
+        }
+    });
+
+    uint64_t checksum = 0;
+    for (uint64_t i = 0; i < items; ++i) {
+        checksum += queue.pop();
+    }
+    producer.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    if (checksum != items * (items - 1) / 2) {
+        std::cerr << "Error: items were lost or reordered" << std::endl;
+        std::exit(1);
+    }
+    return items / seconds;
+}
+
+template <typename Queue>
+std::vector<double> measureLatency(uint64_t roundTrips) {
+    Queue request(QUEUE_CAPACITY);
+    Queue reply(QUEUE_CAPACITY);
+
+    std::thread echo([&request, &reply, roundTrips] {
+        for (uint64_t i = 0; i < roundTrips; ++i) {
+            reply.push(request.pop());
+        }
+    });
+
+    std::vector<double> samples;
+    samples.reserve(roundTrips);
+    for (uint64_t i = 0; i < roundTrips; ++i) {
+        auto start = Clock::now();
+        request.push(i);
+        reply.pop();
+        samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / 2);
+    }
+    echo.join();
+
+    std::sort(samples.begin(), samples.end());
+    return samples;
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+template <typename Queue>
+void runBenchmark(const std::string& name, uint64_t items, uint64_t roundTrips) {
+    double throughput = measureThroughput<Queue>(items);
+    std::vector<double> latency = measureLatency<Queue>(roundTrips);
+
+    std::cout << std::left << std::setw(22) << name << std::right << std::fixed
+              << std::setw(14) << std::setprecision(2) << throughput / 1e6
+              << std::setw(12) << std::setprecision(0) << percentile(latency, 0.50)
+              << std::setw(12) << percentile(latency, 0.99)
+              << std::setw(12) << latency.back() << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    uint64_t items = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 5000000;
+    uint64_t roundTrips = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200000;
+
+    std::cout << "Handoff benchmark (capacity " << QUEUE_CAPACITY << ", "
+              << items << " items, " << roundTrips << " round trips)" << std::endl;
+    std::cout << std::left << std::setw(22) << "queue" << std::right
+              << std::setw(14) << "Mitems/s"
+              << std::setw(12) << "p50 ns"
+              << std::setw(12) << "p99 ns"
+              << std::setw(12) << "max ns" << std::endl;
+
+    runBenchmark<MutexQueue>("mutex + condvar", items, roundTrips);
+    runBenchmark<RingQueue>("SpscRing", items, roundTrips);
+    return 0;
+}